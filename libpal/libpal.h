@@ -33,6 +33,8 @@
 #include "libpal/pal_align.h"
 #include "libpal/pal_debug.h"
 #include "libpal/pal_string.h"
+#include "libpal/pal_number_format.h"
+#include "libpal/pal_number_parse.h"
 #include "libpal/pal_random.h"
 #include "libpal/pal_thread.h"
 #include "libpal/pal_file.h"
@@ -41,15 +43,28 @@
 #include "libpal/pal_page_allocator.h"
 #include "libpal/pal_heap_allocator.h"
 #include "libpal/pal_array.h"
+#include "libpal/pal_chunked_array.h"
+#include "libpal/pal_eytzinger_array.h"
 #include "libpal/pal_min_heap.h"
+#include "libpal/pal_indexed_heap.h"
 #include "libpal/pal_image.h"
 #include "libpal/pal_hash_functions.h"
 #include "libpal/pal_hash_map.h"
+#include "libpal/pal_bloom_filter.h"
+#include "libpal/pal_cuckoo_filter.h"
 #include "libpal/pal_hash_map_cache.h"
 #include "libpal/pal_hash_set.h"
+#include "libpal/pal_hashed_string.h"
+#include "libpal/pal_string_view.h"
+#include "libpal/pal_string_builder.h"
+#include "libpal/pal_shared_string.h"
+#include "libpal/pal_multi_pattern_matcher.h"
 #include "libpal/pal_hash_functions.h"
 #include "libpal/pal_list.h"
 #include "libpal/pal_ilist.h"
+#include "libpal/pal_ihash_map.h"
+#include "libpal/pal_deque.h"
+#include "libpal/pal_soa.h"
 #include "libpal/pal_tokenizer.h"
 #include "libpal/pal_compacting_allocator.h"
 #include "libpal/pal_allocator.h"
@@ -57,11 +72,14 @@
 #include "libpal/pal_font_rasterizer_freetype.h"
 #include "libpal/pal_utf8.h"
 #include "libpal/pal_profiler.h"
+#include "libpal/pal_hdr_histogram.h"
 #include "libpal/pal_delegate.h"
 #include "libpal/pal_event.h"
 #include "libpal/pal_time_line.h"
 #include "libpal/pal_json.h"
 #include "libpal/pal_object_id_table.h"
+#include "libpal/pal_dense_object_id_table.h"
+#include "libpal/pal_concurrent_object_id_table.h"
 #include "libpal/pal_socket.h"
 #include "libpal/pal_tcp_client.h"
 #include "libpal/pal_tcp_listener.h"
@@ -70,10 +88,15 @@
 #include "libpal/pal_command_buffer.h"
 #include "libpal/pal_adi.h"
 #include "libpal/pal_mem_blob.h"
+#include "libpal/pal_spsc_ring_blob.h"
+#include "libpal/pal_mpmc_queue.h"
+#include "libpal/pal_triple_buffer.h"
 #include "libpal/pal_frame_clock.h"
 #include "libpal/pal_atom.h"
 #include "libpal/pal_process.h"
 #include "libpal/pal_pipe_stream.h"
+#include "libpal/pal_external_sort.h"
+#include "libpal/pal_parallel_sort.h"
 
 int palStartup(palConsolePrintFunction print_func);
 int palShutdown();
\ No newline at end of file
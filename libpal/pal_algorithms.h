@@ -23,6 +23,10 @@
 
 #pragma once
 
+#include <string.h>
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+
 template<class T>
 void palSwap(T& a, T& b) {
   T temp(a);
@@ -142,6 +146,46 @@ int palBinarySearchGT(const T* data, const int num_data, const T& needle) {
   
 }
 
+/* Returns the index of the first element in sorted data that is not less
+   than needle, num_data if there is none.
+   The loop has no data dependent branches, the compiler turns the select
+   into a conditional move, and both possible next probes are prefetched. */
+template<class T>
+int palLowerBound(const T* data, int num_data, const T& needle) {
+  if (num_data == 0) {
+    return 0;
+  }
+  const T* base = data;
+  int n = num_data;
+  while (n > 1) {
+    int half = n >> 1;
+    PAL_PREFETCH(base + (half >> 1));
+    PAL_PREFETCH(base + half + (half >> 1));
+    base = (base[half] < needle) ? base + half : base;
+    n -= half;
+  }
+  return (int)(base - data) + (*base < needle ? 1 : 0);
+}
+
+/* Returns the index of the first element in sorted data that is greater
+   than needle, num_data if there is none. Branchless like palLowerBound. */
+template<class T>
+int palUpperBound(const T* data, int num_data, const T& needle) {
+  if (num_data == 0) {
+    return 0;
+  }
+  const T* base = data;
+  int n = num_data;
+  while (n > 1) {
+    int half = n >> 1;
+    PAL_PREFETCH(base + (half >> 1));
+    PAL_PREFETCH(base + half + (half >> 1));
+    base = (needle < base[half]) ? base : base + half;
+    n -= half;
+  }
+  return (int)(base - data) + (needle < *base ? 0 : 1);
+}
+
 template<typename T>
 class palCompareFuncLessThan {
 public:
@@ -158,34 +202,6 @@ public:
   }
 };
 
-template <class T, typename CompareFuncLessThan>
-void palQuickSortInternal(T* buffer, CompareFuncLessThan LessThan, int lo, int hi) {
-  //  lo is the lower index, hi is the upper index
-  //  of the region of array a that is to be sorted
-  int i = lo, j = hi;
-  T x= buffer[(lo+hi)/2];
-
-  //  partition
-  do {    
-    while (LessThan(buffer[i],x)) 
-      i++; 
-    while (LessThan(x,buffer[j])) 
-      j--;
-    if (i<=j) {
-      T temp = buffer[i];
-      buffer[i] = buffer[j];
-      buffer[j] = temp;
-      i++; j--;
-    }
-  } while (i<=j);
-
-  //  recursion
-  if (lo<j) 
-    palQuickSortInternal(buffer, LessThan, lo, j);
-  if (i<hi) 
-    palQuickSortInternal(buffer, LessThan, i, hi);
-}
-
 template <class T, typename CompareFuncLessThan>
 void palHeapSortInternal(T *buffer, CompareFuncLessThan LessThan, int k, int n) {
   /* PRE: a[k+1..N] is a heap */
@@ -211,12 +227,6 @@ void palHeapSortInternal(T *buffer, CompareFuncLessThan LessThan, int k, int n)
   buffer[k - 1] = temp;
 }
 
-template<class T, typename CompareFuncLessThan>
-void palQuickSort(T* buffer, int buffer_size, CompareFuncLessThan LessThan) {
-  if (buffer_size > 1) {
-    palQuickSortInternal(buffer, LessThan,0,buffer_size-1);
-  }
-}
 
 template<class T, typename CompareFuncLessThan>
 void palHeapSort(T* buffer, int buffer_size, CompareFuncLessThan LessThan) {
@@ -239,6 +249,257 @@ void palHeapSort(T* buffer, int buffer_size, CompareFuncLessThan LessThan) {
   } 
 }
 
+#define kPalSortInsertionThreshold 16
+
+/* Stable, used for small ranges by the other sorts */
+template<class T, typename CompareFuncLessThan>
+void palInsertionSort(T* buffer, int buffer_size, CompareFuncLessThan LessThan) {
+  for (int i = 1; i < buffer_size; i++) {
+    if (!LessThan(buffer[i], buffer[i-1])) {
+      continue;
+    }
+    T temp = buffer[i];
+    int j = i;
+    do {
+      buffer[j] = buffer[j-1];
+      j--;
+    } while (j > 0 && LessThan(temp, buffer[j-1]));
+    buffer[j] = temp;
+  }
+}
+
+/* Orders buffer[a], buffer[b], buffer[c] and returns b, the median */
+template<class T, typename CompareFuncLessThan>
+int palSortMedianOfThree(T* buffer, int a, int b, int c, CompareFuncLessThan LessThan) {
+  if (LessThan(buffer[b], buffer[a])) {
+    palSwap(buffer[a], buffer[b]);
+  }
+  if (LessThan(buffer[c], buffer[b])) {
+    palSwap(buffer[b], buffer[c]);
+    if (LessThan(buffer[b], buffer[a])) {
+      palSwap(buffer[a], buffer[b]);
+    }
+  }
+  return b;
+}
+
+template<class T, typename CompareFuncLessThan>
+void palIntroSortInternal(T* buffer, int lo, int hi, int depth_limit, CompareFuncLessThan LessThan) {
+  // hi is exclusive. Recurse into the smaller partition and loop on the
+  // larger one so the stack depth is O(log n)
+  while (hi - lo > kPalSortInsertionThreshold) {
+    if (depth_limit == 0) {
+      // partitioning is going badly, heapsort is O(n log n) no matter what
+      palHeapSort(buffer + lo, hi - lo, LessThan);
+      return;
+    }
+    depth_limit--;
+
+    int mid = lo + (hi - lo) / 2;
+    palSortMedianOfThree(buffer, lo, mid, hi - 1, LessThan);
+    // buffer[lo] <= pivot <= buffer[hi-1] act as sentinels
+    T pivot = buffer[mid];
+    int i = lo;
+    int j = hi - 1;
+    for (;;) {
+      do {
+        i++;
+      } while (LessThan(buffer[i], pivot));
+      do {
+        j--;
+      } while (LessThan(pivot, buffer[j]));
+      if (i >= j) {
+        break;
+      }
+      palSwap(buffer[i], buffer[j]);
+    }
+    // [lo, j] <= pivot <= [j+1, hi)
+    if (j + 1 - lo < hi - (j + 1)) {
+      palIntroSortInternal(buffer, lo, j + 1, depth_limit, LessThan);
+      lo = j + 1;
+    } else {
+      palIntroSortInternal(buffer, j + 1, hi, depth_limit, LessThan);
+      hi = j + 1;
+    }
+  }
+  palInsertionSort(buffer + lo, hi - lo, LessThan);
+}
+
+/* Quicksort with median of three pivots and insertion sort for small
+   ranges. Falls back to heapsort when the recursion gets deeper than
+   2*log2(n), so the worst case is O(n log n). Not stable. */
+template<class T, typename CompareFuncLessThan>
+void palIntroSort(T* buffer, int buffer_size, CompareFuncLessThan LessThan) {
+  int depth_limit = 0;
+  for (int n = buffer_size; n > 1; n >>= 1) {
+    depth_limit += 2;
+  }
+  palIntroSortInternal(buffer, 0, buffer_size, depth_limit, LessThan);
+}
+
+template<class T, typename CompareFuncLessThan>
+void palQuickSort(T* buffer, int buffer_size, CompareFuncLessThan LessThan) {
+  palIntroSort(buffer, buffer_size, LessThan);
+}
+
+/* Merges sorted [lo, mid) and [mid, hi) of source into destination */
+template<class T, typename CompareFuncLessThan>
+void palMergeSortMerge(const T* source, T* destination, int lo, int mid, int hi, CompareFuncLessThan LessThan) {
+  int i = lo;
+  int j = mid;
+  int k = lo;
+  while (i < mid && j < hi) {
+    // take from the right run only if strictly less, that keeps it stable
+    if (LessThan(source[j], source[i])) {
+      destination[k++] = source[j++];
+    } else {
+      destination[k++] = source[i++];
+    }
+  }
+  while (i < mid) {
+    destination[k++] = source[i++];
+  }
+  while (j < hi) {
+    destination[k++] = source[j++];
+  }
+}
+
+/* Stable merge sort, scratch must hold buffer_size elements.
+   Insertion sorts small runs, then merges runs bottom up, back and forth
+   between buffer and scratch. */
+template<class T, typename CompareFuncLessThan>
+void palMergeSort(T* buffer, T* scratch, int buffer_size, CompareFuncLessThan LessThan) {
+  for (int lo = 0; lo < buffer_size; lo += kPalSortInsertionThreshold) {
+    int run = palMin(kPalSortInsertionThreshold, buffer_size - lo);
+    palInsertionSort(buffer + lo, run, LessThan);
+  }
+
+  T* source = buffer;
+  T* destination = scratch;
+  for (int width = kPalSortInsertionThreshold; width < buffer_size; width *= 2) {
+    for (int lo = 0; lo < buffer_size; lo += 2 * width) {
+      int mid = palMin(lo + width, buffer_size);
+      int hi = palMin(lo + 2 * width, buffer_size);
+      palMergeSortMerge(source, destination, lo, mid, hi, LessThan);
+    }
+    palSwap(source, destination);
+  }
+  if (source != buffer) {
+    for (int i = 0; i < buffer_size; i++) {
+      buffer[i] = source[i];
+    }
+  }
+}
+
+/* Radix sort keys. Maps a value to an unsigned key with the same order */
+PAL_INLINE uint32_t palRadixKey(uint32_t v) {
+  return v;
+}
+
+PAL_INLINE uint32_t palRadixKey(int32_t v) {
+  return (uint32_t)v ^ 0x80000000;
+}
+
+PAL_INLINE uint32_t palRadixKey(float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  // negative floats: flip everything, positive floats: flip the sign bit
+  uint32_t mask = (uint32_t)(-(int32_t)(bits >> 31)) | 0x80000000;
+  return bits ^ mask;
+}
+
+PAL_INLINE uint64_t palRadixKey(uint64_t v) {
+  return v;
+}
+
+PAL_INLINE uint64_t palRadixKey(int64_t v) {
+  return (uint64_t)v ^ 0x8000000000000000ULL;
+}
+
+PAL_INLINE uint64_t palRadixKey(double v) {
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  uint64_t mask = (uint64_t)(-(int64_t)(bits >> 63)) | 0x8000000000000000ULL;
+  return bits ^ mask;
+}
+
+/* Key type of each value type palRadixKey supports */
+template<typename T>
+struct palRadixKeyFuncValueType {
+};
+
+template<> struct palRadixKeyFuncValueType<uint32_t> { typedef uint32_t type; };
+template<> struct palRadixKeyFuncValueType<int32_t> { typedef uint32_t type; };
+template<> struct palRadixKeyFuncValueType<float> { typedef uint32_t type; };
+template<> struct palRadixKeyFuncValueType<uint64_t> { typedef uint64_t type; };
+template<> struct palRadixKeyFuncValueType<int64_t> { typedef uint64_t type; };
+template<> struct palRadixKeyFuncValueType<double> { typedef uint64_t type; };
+
+/* Key extractor for plain values */
+template<typename T>
+class palRadixKeyFuncValue {
+public:
+  PAL_INLINE typename palRadixKeyFuncValueType<T>::type operator()(const T& v) const {
+    return palRadixKey(v);
+  }
+};
+
+/* LSD radix sort on an unsigned key, one byte per pass.
+   KeyType is uint32_t or uint64_t, KeyFunc maps an element to its key
+   (see palRadixKey). scratch must hold buffer_size elements. Stable.
+   Passes where every key has the same byte are skipped. */
+template<typename KeyType, class T, typename KeyFunc>
+void palRadixSortByKey(T* buffer, T* scratch, int buffer_size, KeyFunc Key) {
+  const int kPasses = sizeof(KeyType);
+  if (buffer_size < 2) {
+    return;
+  }
+  int histogram[sizeof(KeyType)][256];
+  for (int pass = 0; pass < kPasses; pass++) {
+    for (int digit = 0; digit < 256; digit++) {
+      histogram[pass][digit] = 0;
+    }
+  }
+  // all histograms in one read of the keys
+  for (int i = 0; i < buffer_size; i++) {
+    KeyType key = Key(buffer[i]);
+    for (int pass = 0; pass < kPasses; pass++) {
+      histogram[pass][(key >> (pass * 8)) & 0xff]++;
+    }
+  }
+
+  T* source = buffer;
+  T* destination = scratch;
+  for (int pass = 0; pass < kPasses; pass++) {
+    int* counts = histogram[pass];
+    if (counts[(Key(source[0]) >> (pass * 8)) & 0xff] == buffer_size) {
+      continue;
+    }
+    int offset = 0;
+    for (int digit = 0; digit < 256; digit++) {
+      int count = counts[digit];
+      counts[digit] = offset;
+      offset += count;
+    }
+    for (int i = 0; i < buffer_size; i++) {
+      int digit = (int)((Key(source[i]) >> (pass * 8)) & 0xff);
+      destination[counts[digit]++] = source[i];
+    }
+    palSwap(source, destination);
+  }
+  if (source != buffer) {
+    for (int i = 0; i < buffer_size; i++) {
+      buffer[i] = source[i];
+    }
+  }
+}
+
+/* Radix sorts uint32_t, int32_t, float, uint64_t, int64_t or double values */
+template<class T>
+void palRadixSort(T* buffer, T* scratch, int buffer_size) {
+  palRadixSortByKey<typename palRadixKeyFuncValueType<T>::type>(buffer, scratch, buffer_size, palRadixKeyFuncValue<T>());
+}
+
 template<class T>
 void palArrayReverse(T* buffer, int buffer_size) {
   int start = 0;
@@ -280,7 +541,7 @@ int palArrayCountOf(T* buffer, int buffer_size, const T& needle) {
   int count = 0;
   while (count < buffer_size) {
     if (buffer[count] == needle) {
-      needle_count++:
+      needle_count++;
     }
     count++;
   }
@@ -292,5 +553,6 @@ void palArrayCopy(T* dest_buffer,const T* src_buffer, int count) {
   int i = 0;
   while (i < count) {
     dest_buffer[i] = src_buffer[i];
+    i++;
   }
 }
@@ -299,6 +299,7 @@ public:
 			for (i = 0; i < size_; i++) {
 				new (&new_elements[i]) T(buffer_[i]);
 			}
+			CallDestructor(0, size_);
 			DeallocateBuffer();
 			capacity_ = new_capacity;
 			buffer_ = new_elements;
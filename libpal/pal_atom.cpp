@@ -40,7 +40,7 @@ struct palAtomMemoryManager {
   uint32_t total_wasted_memory;
   uint32_t total_large_strings;
   void Init();
-  char* CopyString(const char* str);
+  char* CopyString(const palStringView& str);
 };
 
 void palAtomMemoryManager::Init() {
@@ -51,14 +51,17 @@ void palAtomMemoryManager::Init() {
   total_large_strings = 0;
 }
 
-char* palAtomMemoryManager::CopyString(const char* str) {
-  uint32_t length = palStringLength(str) + 1;
+char* palAtomMemoryManager::CopyString(const palStringView& str) {
+  uint32_t length = str.GetLength() + 1;
 
   if (length >= PAL_ATOM_PAGE_SIZE) {
     // very large string, won't fit in page
     total_large_strings++;
     total_allocated_memory += length;
-    return palStringDuplicate(str);
+    char* copy = (char*)g_StringProxyAllocator->Allocate(length);
+    palMemoryCopyBytes(copy, str.GetPtr(), length - 1);
+    copy[length - 1] = '\0';
+    return copy;
   }
   const uint32_t page_size = ((palPageAllocator*)g_PageAllocator)->GetPageSize();
   if (page == NULL) {
@@ -74,21 +77,23 @@ char* palAtomMemoryManager::CopyString(const char* str) {
     offset = 0;
   }
   char* copy = page+offset;
-  palMemoryCopyBytes(page+offset, str, length);
+  palMemoryCopyBytes(page+offset, str.GetPtr(), length - 1);
+  copy[length - 1] = '\0';
   offset += length;
   return copy;
 }
 
 static palAtomMemoryManager buffer;
 static palArray<const char*> _atom_strings;
-static palHashMap<const char*, palAtom> _string_to_atom_map;
+// keyed by the characters, the views point at _atom_strings
+static palHashMap<palStringView, palAtom> _string_to_atom_map;
 static palAtom atom_counter = 0;
 
 static palAtom palAtomAddString(const char* str) {
   palAtom atom = atom_counter++;
   int r = _atom_strings.push_back(str);
   palAssert(atom == r);
-  _string_to_atom_map.Insert(str, atom);
+  _string_to_atom_map.Insert(palStringView(str), atom);
   return atom;
 }
 
@@ -120,6 +125,10 @@ void palAtomGetStats(uint32_t* total_memory, uint32_t* wasted_memory, uint32_t*
 }
 
 palAtom palAtomTryString(const char* str) {
+  return palAtomTryString(palStringView(str));
+}
+
+palAtom palAtomTryString(const palStringView& str) {
   palScopedMutex m(&_atom_table_mutex);
   palAtom* result = _string_to_atom_map.Find(str);
   if (!result) {
@@ -139,6 +148,10 @@ palAtom palAtomFromStaticString(const char* str) {
 }
 
 palAtom palAtomFromString(const char* str) {
+  return palAtomFromString(palStringView(str));
+}
+
+palAtom palAtomFromString(const palStringView& str) {
   palScopedMutex m(&_atom_table_mutex);
   palAtom* result = _string_to_atom_map.Find(str);
   if (!result) {
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "libpal/pal_types.h"
+#include "libpal/pal_string_view.h"
 
 typedef uint32_t palAtom;
 
@@ -33,5 +34,8 @@ void palAtomGetStats(uint32_t* total_memory, uint32_t* wasted_memory, uint32_t*
 palAtom palAtomTryString(const char* str);
 palAtom palAtomFromStaticString(const char* str);
 palAtom palAtomFromString(const char* str);
+/* Lookup by slice, the characters are only copied when a new atom is made */
+palAtom palAtomTryString(const palStringView& str);
+palAtom palAtomFromString(const palStringView& str);
 
 const char* palAtomToString(palAtom atom);
@@ -0,0 +1,156 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#include <math.h>
+#include "libpal/pal_debug.h"
+#include "libpal/pal_memory.h"
+#include "libpal/pal_bloom_filter.h"
+
+const uint32_t kPalBloomFilterSalts[8] = {
+  0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d,
+  0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31
+};
+
+#define kPalBloomFilterMagic 0x464c4250 // PBLF
+#define kPalBloomFilterVersion 1
+
+struct palBloomFilterHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t block_count;
+  uint32_t reserved;
+};
+
+/* Keys are spread over blocks with a Poisson distribution of mean
+   keys_per_block. A block holding k keys has each bit of a word set with
+   probability 1-(1-1/32)^k and a lookup must find eight of them set. */
+static double palBloomFilterFalsePositiveRate(double keys_per_block) {
+  const double word_bit_clear = 1.0 - 1.0/32.0;
+  if (keys_per_block <= 0.0) {
+    return 0.0;
+  }
+  // only the terms near the mean matter, they are computed in log space so they don't underflow
+  double spread = 10.0 * sqrt(keys_per_block) + 20.0;
+  int first = keys_per_block > spread ? (int)(keys_per_block - spread) : 0;
+  int last = (int)(keys_per_block + spread);
+  double log_mean = log(keys_per_block);
+  double rate = 0.0;
+  for (int k = first; k <= last; k++) {
+    double poisson = exp(k * log_mean - keys_per_block - lgamma(k + 1.0));
+    rate += poisson * pow(1.0 - pow(word_bit_clear, k), palBloomFilter::kBlockWords);
+  }
+  return rate;
+}
+
+palBloomFilter::palBloomFilter() : allocator_(NULL), blocks_(NULL), block_count_(0) {
+}
+
+palBloomFilter::~palBloomFilter() {
+  Destroy();
+}
+
+void palBloomFilter::AllocateBlocks(uint32_t block_count) {
+  Destroy();
+  // blocks never straddle a cache line
+  blocks_ = static_cast<uint32_t*>(allocator_->Allocate((uint64_t)block_count * kBlockBytes, 64));
+  block_count_ = block_count;
+  Clear();
+}
+
+int palBloomFilter::Create(uint64_t expected_count, double false_positive_rate) {
+  palAssert(false_positive_rate > 0.0 && false_positive_rate < 1.0);
+  // the smallest power of two block count that is good enough
+  uint64_t high = 1;
+  while (high < 0x80000000 && palBloomFilterFalsePositiveRate((double)expected_count / high) > false_positive_rate) {
+    high *= 2;
+  }
+  // and binary search down from there
+  uint64_t low = high / 2;
+  while (low + 1 < high) {
+    uint64_t middle = (low + high) / 2;
+    if (palBloomFilterFalsePositiveRate((double)expected_count / middle) > false_positive_rate) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  return CreateWithBlocks((uint32_t)high);
+}
+
+int palBloomFilter::CreateWithBlocks(uint32_t block_count) {
+  palAssert(block_count > 0);
+  AllocateBlocks(block_count);
+  return 0;
+}
+
+void palBloomFilter::Destroy() {
+  if (blocks_ != NULL) {
+    allocator_->Deallocate(blocks_);
+    blocks_ = NULL;
+  }
+  block_count_ = 0;
+}
+
+void palBloomFilter::Clear() {
+  palMemoryZeroBytes(blocks_, GetSizeInBytes());
+}
+
+double palBloomFilter::GetFalsePositiveRate(uint64_t count) const {
+  if (block_count_ == 0) {
+    return 0.0;
+  }
+  return palBloomFilterFalsePositiveRate((double)count / block_count_);
+}
+
+uint64_t palBloomFilter::GetSerializedSize() const {
+  return sizeof(palBloomFilterHeader) + GetSizeInBytes();
+}
+
+int palBloomFilter::Serialize(palMemBlob* blob) const {
+  if (blob->GetBufferSize() < GetSerializedSize()) {
+    return PAL_MEM_BLOB_NO_ROOM;
+  }
+  palBloomFilterHeader header;
+  header.magic = kPalBloomFilterMagic;
+  header.version = kPalBloomFilterVersion;
+  header.block_count = block_count_;
+  header.reserved = 0;
+  palMemoryCopyBytes(blob->GetPtr(), &header, sizeof(header));
+  palMemoryCopyBytes(blob->GetPtr(sizeof(header)), blocks_, GetSizeInBytes());
+  return 0;
+}
+
+int palBloomFilter::Deserialize(const palMemBlob& blob) {
+  palBloomFilterHeader header;
+  if (blob.GetBufferSize() < sizeof(header)) {
+    return PAL_BLOOM_FILTER_ERROR_INVALID_BLOB;
+  }
+  palMemoryCopyBytes(&header, blob.GetPtr(), sizeof(header));
+  if (header.magic != kPalBloomFilterMagic || header.version != kPalBloomFilterVersion || header.block_count == 0 ||
+      blob.GetBufferSize() < sizeof(header) + (uint64_t)header.block_count * kBlockBytes) {
+    return PAL_BLOOM_FILTER_ERROR_INVALID_BLOB;
+  }
+  AllocateBlocks(header.block_count);
+  palMemoryCopyBytes(blocks_, blob.GetPtr(sizeof(header)), GetSizeInBytes());
+  return 0;
+}
@@ -0,0 +1,174 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_errorcode.h"
+#include "libpal/pal_allocator_interface.h"
+#include "libpal/pal_mem_blob.h"
+#include "libpal/pal_hash_functions.h"
+
+#if defined(PAL_CPU_X86)
+#include <smmintrin.h>
+#endif
+
+#define PAL_BLOOM_FILTER_ERROR_INVALID_BLOB palMakeErrorCode(PAL_ERROR_CODE_FILTER_GROUP, 1)
+
+// multiplier for each word of a block
+extern const uint32_t kPalBloomFilterSalts[8];
+
+/* Split block Bloom filter.
+
+   The filter is an array of 256 bit blocks, every block lives inside one
+   cache line. A key selects one block with the high half of its hash and
+   sets one bit in each of the block's eight 32 bit words, the bit is picked
+   by multiplying the low half of the hash with a per word salt. A lookup
+   is one cache miss and, on x86, two 128 bit compares.
+
+   Keys are never stored so a filter can answer "definitely not present"
+   or "maybe present". Use it in front of a palHashMap, file or cache
+   lookup that mostly misses.
+
+   Keys can't be removed, see palCuckooFilter for that.
+*/
+class palBloomFilter {
+public:
+  static const int kBlockWords = 8;
+  static const int kBlockBytes = kBlockWords * sizeof(uint32_t);
+protected:
+  palAllocatorInterface* allocator_;
+  uint32_t* blocks_;
+  uint32_t block_count_;
+
+  const uint32_t* GetBlock(uint64_t hash) const {
+    uint64_t index = ((hash >> 32) * block_count_) >> 32;
+    return blocks_ + index * kBlockWords;
+  }
+
+  uint32_t* GetBlock(uint64_t hash) {
+    uint64_t index = ((hash >> 32) * block_count_) >> 32;
+    return blocks_ + index * kBlockWords;
+  }
+
+#if defined(PAL_CPU_X86)
+  /* 1 << bit for four words. SSE has no variable per lane shift, so the
+     float 2^bit is built from its exponent and converted back */
+  static __m128i BlockMask(__m128i key, __m128i salt) {
+    __m128i bit = _mm_srli_epi32(_mm_mullo_epi32(key, salt), 27);
+    __m128 power = _mm_castsi128_ps(_mm_add_epi32(_mm_slli_epi32(bit, 23), _mm_set1_epi32(0x3f800000)));
+    return _mm_cvttps_epi32(power);
+  }
+#endif
+
+  static uint32_t WordMask(uint32_t key, int word) {
+    return 1u << ((key * kPalBloomFilterSalts[word]) >> 27);
+  }
+
+  void AllocateBlocks(uint32_t block_count);
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palBloomFilter);
+public:
+  palBloomFilter();
+  ~palBloomFilter();
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    allocator_ = allocator;
+  }
+
+  /* Sizes the filter so that once expected_count keys are inserted the
+     chance a lookup of any other key answers true is false_positive_rate */
+  int Create(uint64_t expected_count, double false_positive_rate);
+  /* Sizes the filter to block_count blocks */
+  int CreateWithBlocks(uint32_t block_count);
+  void Destroy();
+
+  /* Removes all keys */
+  void Clear();
+
+  void InsertHash(uint64_t hash) {
+    uint32_t* block = GetBlock(hash);
+#if defined(PAL_CPU_X86)
+    __m128i key = _mm_set1_epi32((int)(uint32_t)hash);
+    __m128i* words = reinterpret_cast<__m128i*>(block);
+    __m128i mask0 = BlockMask(key, _mm_loadu_si128(reinterpret_cast<const __m128i*>(kPalBloomFilterSalts + 0)));
+    __m128i mask1 = BlockMask(key, _mm_loadu_si128(reinterpret_cast<const __m128i*>(kPalBloomFilterSalts + 4)));
+    _mm_store_si128(words, _mm_or_si128(_mm_load_si128(words), mask0));
+    _mm_store_si128(words + 1, _mm_or_si128(_mm_load_si128(words + 1), mask1));
+#else
+    for (int i = 0; i < kBlockWords; i++) {
+      block[i] |= WordMask((uint32_t)hash, i);
+    }
+#endif
+  }
+
+  bool ContainsHash(uint64_t hash) const {
+    const uint32_t* block = GetBlock(hash);
+#if defined(PAL_CPU_X86)
+    __m128i key = _mm_set1_epi32((int)(uint32_t)hash);
+    const __m128i* words = reinterpret_cast<const __m128i*>(block);
+    __m128i mask0 = BlockMask(key, _mm_loadu_si128(reinterpret_cast<const __m128i*>(kPalBloomFilterSalts + 0)));
+    __m128i mask1 = BlockMask(key, _mm_loadu_si128(reinterpret_cast<const __m128i*>(kPalBloomFilterSalts + 4)));
+    // testc is set when every bit of the mask is set in the block
+    return (_mm_testc_si128(_mm_load_si128(words), mask0) & _mm_testc_si128(_mm_load_si128(words + 1), mask1)) != 0;
+#else
+    for (int i = 0; i < kBlockWords; i++) {
+      uint32_t mask = WordMask((uint32_t)hash, i);
+      if ((block[i] & mask) != mask) {
+        return false;
+      }
+    }
+    return true;
+#endif
+  }
+
+  template<class Key>
+  void Insert(const Key& key) {
+    palHashFunction<Key> hash_function;
+    InsertHash(hash_function(key));
+  }
+
+  template<class Key>
+  bool Contains(const Key& key) const {
+    palHashFunction<Key> hash_function;
+    return ContainsHash(hash_function(key));
+  }
+
+  uint32_t GetBlockCount() const {
+    return block_count_;
+  }
+
+  uint64_t GetSizeInBytes() const {
+    return (uint64_t)block_count_ * kBlockBytes;
+  }
+
+  /* False positive rate after inserting count keys */
+  double GetFalsePositiveRate(uint64_t count) const;
+
+  /* Serialization to a palMemBlob, the blob must be at least GetSerializedSize bytes */
+  uint64_t GetSerializedSize() const;
+  int Serialize(palMemBlob* blob) const;
+  /* Replaces this filter with the one serialized in blob */
+  int Deserialize(const palMemBlob& blob);
+};
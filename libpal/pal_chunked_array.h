@@ -0,0 +1,215 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_debug.h"
+#include "libpal/pal_allocator_interface.h"
+#include "libpal/pal_memory.h"
+#include "libpal/pal_align.h"
+#include "libpal/pal_array.h"
+
+template <int N>
+struct palChunkedArrayLog2 {
+  static const int value = 1 + palChunkedArrayLog2<N / 2>::value;
+};
+
+template <>
+struct palChunkedArrayLog2<1> {
+  static const int value = 0;
+};
+
+/*
+  An array that stores its elements in fixed size chunks of ChunkSize
+  elements. ChunkSize must be a power of two.
+
+  Growing allocates a new chunk and adds it to the chunk directory, existing
+  elements are never copied or moved, so pointers to elements stay valid
+  until the element is popped or the array is cleared.
+
+  Indexing is O(1): the high bits of the index select the chunk, the low
+  bits the element inside it.
+
+  Every chunk but the last is full. To touch every element with a tight loop
+  iterate chunk by chunk:
+
+  for (int c = 0; c < array.GetChunkCount(); c++) {
+    T* elements = array.GetChunk(c);
+    int count = array.GetChunkSize(c);
+    ...
+  }
+*/
+template <typename T, int ChunkSize = 256, uint32_t Alignment = PAL_ALIGNOF(T)>
+class palChunkedArray {
+public:
+  /* Types and constants */
+  typedef palChunkedArray<T, ChunkSize, Alignment> this_type;
+  typedef T element_type;
+  static const uint32_t element_alignment = Alignment;
+  static const int chunk_size = ChunkSize;
+  static const int chunk_shift = palChunkedArrayLog2<ChunkSize>::value;
+protected:
+  palAllocatorInterface* allocator_;
+  palArray<T*> chunks_;
+  int size_;
+
+  void CallDestructor(int start, int stop) {
+    for (int i = start; i < stop; i++) {
+      (*this)[i].~T();
+    }
+  }
+
+  T* AllocateChunk() {
+    return static_cast<T*>(allocator_->Allocate(ChunkSize * sizeof(T), this_type::element_alignment));
+  }
+
+  /* Makes sure the element at size_ has storage */
+  T* NextSlot() {
+    if (size_ == GetCapacity()) {
+      chunks_.push_back(AllocateChunk());
+    }
+    return &(*this)[size_];
+  }
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palChunkedArray);
+public:
+  palChunkedArray() : allocator_(NULL), size_(0) {
+    palAssert((ChunkSize & (ChunkSize - 1)) == 0);
+  }
+
+  ~palChunkedArray() {
+    Reset();
+  }
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    allocator_ = allocator;
+    chunks_.SetAllocator(allocator);
+  }
+
+  palAllocatorInterface* GetAllocator() const {
+    return allocator_;
+  }
+
+  T& operator[](int i) {
+    return chunks_[i >> chunk_shift][i & (ChunkSize - 1)];
+  }
+
+  const T& operator[](int i) const {
+    return chunks_[i >> chunk_shift][i & (ChunkSize - 1)];
+  }
+
+  int GetCapacity() const {
+    return chunks_.GetSize() * ChunkSize;
+  }
+
+  int GetSize() const {
+    return size_;
+  }
+
+  bool IsEmpty() const {
+    return size_ == 0;
+  }
+
+  /* Chunk iteration */
+  int GetChunkCount() const {
+    return (size_ + ChunkSize - 1) / ChunkSize;
+  }
+
+  T* GetChunk(int chunk) {
+    return chunks_[chunk];
+  }
+
+  const T* GetChunk(int chunk) const {
+    return chunks_[chunk];
+  }
+
+  /* Number of elements in use in chunk */
+  int GetChunkSize(int chunk) const {
+    int remaining = size_ - chunk * ChunkSize;
+    return remaining < ChunkSize ? remaining : ChunkSize;
+  }
+
+  void Reserve(int new_capacity) {
+    while (GetCapacity() < new_capacity) {
+      chunks_.push_back(AllocateChunk());
+    }
+  }
+
+  void Resize(int new_size, const T& element = T()) {
+    if (new_size < size_) {
+      CallDestructor(new_size, size_);
+      size_ = new_size;
+    } else if (new_size > size_) {
+      Reserve(new_size);
+      for (int i = size_; i < new_size; i++) {
+        new (&(*this)[i]) T(element);
+      }
+      size_ = new_size;
+    }
+  }
+
+  /* Destroys all elements, keeps the chunks */
+  void Clear() {
+    CallDestructor(0, size_);
+    size_ = 0;
+  }
+
+  /* Destroys all elements and frees the chunks */
+  void Reset() {
+    Clear();
+    for (int i = 0; i < chunks_.GetSize(); i++) {
+      allocator_->Deallocate(chunks_[i]);
+    }
+    chunks_.Reset();
+  }
+
+  T& AddTail() {
+    T* slot = NextSlot();
+    new (slot) T();
+    size_++;
+    return *slot;
+  }
+
+  int push_back(const T& element) {
+    T* slot = NextSlot();
+    new (slot) T(element);
+    return size_++;
+  }
+
+  void pop_back() {
+    size_--;
+    (*this)[size_].~T();
+  }
+
+  int Find(const T& element, int start = 0) const {
+    for (int i = start; i < size_; i++) {
+      if (element == (*this)[i])
+        return i;
+    }
+    return size_;
+  }
+
+  bool Contains(const T& element) const {
+    return Find(element) != size_;
+  }
+};
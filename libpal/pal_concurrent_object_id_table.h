@@ -0,0 +1,297 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#ifndef LIBPAL_PAL_CONCURRENT_OBJECT_ID_TABLE_H_
+#define LIBPAL_PAL_CONCURRENT_OBJECT_ID_TABLE_H_
+
+#include "libpal/pal_debug.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_atomic.h"
+
+/*
+  Maps 32-bit integer IDs to objects, like palObjectIdTable, but may be used
+  from many threads at once without a lock.
+
+  Template takes object type (T) and the number of objects in the table
+  as a power of two (kPowTwoObjectsInTable).
+
+  The lower kPowTwoObjectsInTable bits of an ID index a slot and the higher bits
+  are the slot's generation. Each slot holds one atomic state word with the
+  generation and a live bit; removing an object bumps the generation with a
+  compare and swap, so exactly one RemoveObject wins and every outstanding ID
+  for the slot stops mapping.
+
+  MapObject is wait-free: it loads the state, the object and the state again
+  and only returns the object if the state did not change in between. It never
+  returns an object that was added under a different ID, but it does not keep
+  the object alive; callers still need to defer destroying removed objects
+  until no thread can be using them.
+
+  Slot reuse is deferred: never used slots are handed out first, removed
+  slots are collected on a retired list and only moved to the free list once
+  the free list is empty. A slot whose generation would wrap is never reused,
+  so a stale ID can never match a recycled slot.
+
+  Complexity:
+
+  Add new object
+    O(1) (lock-free)
+  Delete object by ID
+    O(1) (lock-free)
+  Fetch object pointer from ID
+    O(1) (wait-free)
+  Find object ID
+    O(N)
+  Iterate over all objects
+    O(N)
+
+  N = 2^kPowTwoObjectsInTable
+
+  FindObjectID and ID iteration see each slot at some point during the call
+  but not the table at a single point in time.
+*/
+template<typename T, int kPowTwoObjectsInTable = 8>
+class palConcurrentObjectIdTable {
+protected:
+  static const uint32_t kMaxObjects = 1 << kPowTwoObjectsInTable;
+  static const uint32_t kIndexMask = kMaxObjects - 1;
+  static const uint32_t kGenerationMask = 0xffffffff >> kPowTwoObjectsInTable;
+  /* generations 0 and 1 are never handed out, so GetCapacity() is never a valid ID */
+  static const uint32_t kFirstGeneration = 2;
+  static const uint32_t kEmptyList = 0xffffffff;
+
+  struct Slot {
+    /* (generation << 1) | live */
+    palAtomicInt64 state;
+    palAtomicAddress object;
+    /* next slot on the free or retired list */
+    palAtomicInt32 next;
+  };
+
+  /* list heads are (tag << 32) | index, the tag changes on every pop so
+     a head that was popped and pushed back can not be mistaken for the old one */
+  palAtomicInt64 free_head_;
+  palAtomicInt64 retired_head_;
+  palAtomicInt32 fresh_slot_;
+  palAtomicInt32 object_count_;
+  palAtomicInt32 highwater_mark_;
+
+  Slot slots_[1 << kPowTwoObjectsInTable];
+
+  static int64_t MakeHead(uint32_t tag, uint32_t index) {
+    return (int64_t)(((uint64_t)tag << 32) | index);
+  }
+
+  static uint32_t HeadIndex(int64_t head) {
+    return (uint32_t)((uint64_t)head & 0xffffffff);
+  }
+
+  static uint32_t HeadTag(int64_t head) {
+    return (uint32_t)((uint64_t)head >> 32);
+  }
+
+  static int64_t MakeState(uint32_t generation, bool live) {
+    return ((int64_t)generation << 1) | (live ? 1 : 0);
+  }
+
+  /* Pushes the chain first..last on to a list */
+  void PushList(palAtomicInt64* head, uint32_t first, uint32_t last) {
+    int64_t old_head = head->Load();
+    do {
+      slots_[last].next.Store((int32_t)HeadIndex(old_head));
+    } while (!head->CompareExchange(old_head, MakeHead(HeadTag(old_head), first)));
+  }
+
+  uint32_t PopList(palAtomicInt64* head) {
+    int64_t old_head = head->Load();
+    for (;;) {
+      uint32_t index = HeadIndex(old_head);
+      if (index == kEmptyList) {
+        return kEmptyList;
+      }
+      // next may be stale if another thread popped index first, the tag makes the exchange fail
+      uint32_t next = (uint32_t)slots_[index].next.Load();
+      if (head->CompareExchange(old_head, MakeHead(HeadTag(old_head) + 1, next))) {
+        return index;
+      }
+    }
+  }
+
+  /* Moves every retired slot to the free list */
+  bool RecycleRetiredSlots() {
+    int64_t old_head = retired_head_.Load();
+    while (HeadIndex(old_head) != kEmptyList) {
+      if (retired_head_.CompareExchange(old_head, MakeHead(HeadTag(old_head) + 1, kEmptyList))) {
+        // the chain is private now
+        uint32_t first = HeadIndex(old_head);
+        uint32_t last = first;
+        for (uint32_t next = (uint32_t)slots_[last].next.Load(); next != kEmptyList; next = (uint32_t)slots_[last].next.Load()) {
+          last = next;
+        }
+        PushList(&free_head_, first, last);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  uint32_t TakeFreshSlot() {
+    int32_t fresh = fresh_slot_.Load();
+    while (fresh < (int32_t)kMaxObjects) {
+      if (fresh_slot_.CompareExchange(fresh, fresh + 1)) {
+        return (uint32_t)fresh;
+      }
+    }
+    return kEmptyList;
+  }
+
+  uint32_t AcquireSlot() {
+    uint32_t index = TakeFreshSlot();
+    while (index == kEmptyList) {
+      index = PopList(&free_head_);
+      if (index != kEmptyList || RecycleRetiredSlots() == false) {
+        break;
+      }
+    }
+    if (index == kEmptyList) {
+      // another thread may have recycled the retired slots before we looked
+      index = PopList(&free_head_);
+    }
+    return index;
+  }
+public:
+  palConcurrentObjectIdTable() : free_head_(MakeHead(0, kEmptyList)), retired_head_(MakeHead(0, kEmptyList)), fresh_slot_(0), object_count_(0), highwater_mark_(0) {
+    for (uint32_t i = 0; i < kMaxObjects; i++) {
+      slots_[i].state.Store(MakeState(kFirstGeneration, false));
+      slots_[i].object.Store(NULL);
+      slots_[i].next.Store((int32_t)kEmptyList);
+    }
+  }
+
+  uint32_t GetCapacity() const {
+    return kMaxObjects;
+  }
+
+  uint32_t GetSize() const {
+    return (uint32_t)object_count_.Load();
+  }
+
+  uint32_t GetHighWaterMark() const {
+    return (uint32_t)highwater_mark_.Load();
+  }
+
+  /* Returns GetCapacity() if the table is full */
+  uint32_t AddObject(T* o) {
+    palAssert(o != NULL);
+    uint32_t index = AcquireSlot();
+    if (index == kEmptyList) {
+      return kMaxObjects;
+    }
+
+    // the slot is ours until it is marked live
+    Slot& slot = slots_[index];
+    uint32_t generation = (uint32_t)(slot.state.Load() >> 1);
+    slot.object.Store(const_cast<void*>(static_cast<const void*>(o)));
+    slot.state.Store(MakeState(generation, true));
+
+    int32_t count = object_count_.FetchAdd(1) + 1;
+    int32_t highwater = highwater_mark_.Load();
+    while (count > highwater && !highwater_mark_.CompareExchange(highwater, count)) {
+    }
+
+    return (generation << kPowTwoObjectsInTable) | index;
+  }
+
+  T* RemoveObject(uint32_t id) {
+    uint32_t index = id & kIndexMask;
+    uint32_t generation = (id >> kPowTwoObjectsInTable) & kGenerationMask;
+    Slot& slot = slots_[index];
+    int64_t expected = MakeState(generation, true);
+    T* r = static_cast<T*>(slot.object.Load());
+    uint32_t next_generation = (generation + 1) & kGenerationMask;
+    bool retire = next_generation < kFirstGeneration;
+    if (!slot.state.CompareExchange(expected, MakeState(retire ? generation : next_generation, false))) {
+      // not actually in the table, or another thread removed it first
+      return NULL;
+    }
+    object_count_.FetchSub(1);
+    if (retire) {
+      // generation is used up, never hand this slot out again
+      return r;
+    }
+    PushList(&retired_head_, index, index);
+    return r;
+  }
+
+  T* MapObject(uint32_t id) const {
+    uint32_t index = id & kIndexMask;
+    uint32_t generation = (id >> kPowTwoObjectsInTable) & kGenerationMask;
+    const Slot& slot = slots_[index];
+    int64_t state = MakeState(generation, true);
+    if (slot.state.Load() != state) {
+      return NULL;
+    }
+    T* r = static_cast<T*>(slot.object.Load());
+    if (slot.state.Load() != state) {
+      // removed while we were reading
+      return NULL;
+    }
+    return r;
+  }
+
+  uint32_t FindObjectID(T* o) const {
+    palAssert(o != NULL);
+    uint32_t fresh = (uint32_t)fresh_slot_.Load();
+    for (uint32_t i = 0; i < fresh; i++) {
+      int64_t state = slots_[i].state.Load();
+      if ((state & 1) && slots_[i].object.Load() == o && slots_[i].state.Load() == state) {
+        return ((uint32_t)(state >> 1) << kPowTwoObjectsInTable) | i;
+      }
+    }
+    return kMaxObjects;
+  }
+
+  /* Iteration */
+  uint32_t GetFirstObjectID() const {
+    return FindLiveSlot(0);
+  }
+
+  uint32_t GetNextObjectID(uint32_t id) const {
+    return FindLiveSlot((id & kIndexMask) + 1);
+  }
+private:
+  uint32_t FindLiveSlot(uint32_t start) const {
+    uint32_t fresh = (uint32_t)fresh_slot_.Load();
+    for (uint32_t i = start; i < fresh; i++) {
+      int64_t state = slots_[i].state.Load();
+      if (state & 1) {
+        return ((uint32_t)(state >> 1) << kPowTwoObjectsInTable) | i;
+      }
+    }
+    return kMaxObjects;
+  }
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palConcurrentObjectIdTable);
+};
+
+#endif  // LIBPAL_PAL_CONCURRENT_OBJECT_ID_TABLE_H_
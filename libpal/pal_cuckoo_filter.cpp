@@ -0,0 +1,234 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#include <math.h>
+#include "libpal/pal_debug.h"
+#include "libpal/pal_memory.h"
+#include "libpal/pal_cuckoo_filter.h"
+
+#define kPalCuckooFilterMagic 0x46434350 // PCCF
+#define kPalCuckooFilterVersion 1
+// buckets are sized so that the filter is at most this full
+#define kPalCuckooFilterMaximumLoad 0.95
+
+struct palCuckooFilterHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t bucket_count;
+  uint32_t fingerprint_bits;
+  uint64_t count;
+  uint32_t victim_fingerprint;
+  uint32_t victim_bucket;
+};
+
+palCuckooFilter::palCuckooFilter() : allocator_(NULL), buckets_(NULL), bucket_count_(0), bucket_mask_(0),
+                                     fingerprint_bits_(0), fingerprint_mask_(0), count_(0),
+                                     victim_fingerprint_(0), victim_bucket_(0), kick_random_(0x2545f491) {
+}
+
+palCuckooFilter::~palCuckooFilter() {
+  Destroy();
+}
+
+void palCuckooFilter::AllocateBuckets(uint32_t bucket_count, int fingerprint_bits) {
+  Destroy();
+  buckets_ = static_cast<uint64_t*>(allocator_->Allocate((uint64_t)bucket_count * sizeof(uint64_t), 64));
+  bucket_count_ = bucket_count;
+  bucket_mask_ = bucket_count - 1;
+  fingerprint_bits_ = fingerprint_bits;
+  fingerprint_mask_ = (1u << fingerprint_bits) - 1;
+  Clear();
+}
+
+int palCuckooFilter::Create(uint64_t expected_count, double false_positive_rate) {
+  palAssert(false_positive_rate > 0.0 && false_positive_rate < 1.0);
+  // a lookup compares against at most 2 * kSlotsPerBucket fingerprints
+  int fingerprint_bits = (int)ceil(log(2.0 * kSlotsPerBucket / false_positive_rate) / log(2.0));
+  if (fingerprint_bits < 4) {
+    fingerprint_bits = 4;
+  } else if (fingerprint_bits > kMaxFingerprintBits) {
+    fingerprint_bits = kMaxFingerprintBits;
+  }
+  uint64_t bucket_count = 1;
+  while (bucket_count < 0x80000000 && (double)expected_count > bucket_count * kSlotsPerBucket * kPalCuckooFilterMaximumLoad) {
+    bucket_count *= 2;
+  }
+  AllocateBuckets((uint32_t)bucket_count, fingerprint_bits);
+  return 0;
+}
+
+void palCuckooFilter::Destroy() {
+  if (buckets_ != NULL) {
+    allocator_->Deallocate(buckets_);
+    buckets_ = NULL;
+  }
+  bucket_count_ = 0;
+  bucket_mask_ = 0;
+  count_ = 0;
+  victim_fingerprint_ = 0;
+}
+
+void palCuckooFilter::Clear() {
+  palMemoryZeroBytes(buckets_, GetSizeInBytes());
+  count_ = 0;
+  victim_fingerprint_ = 0;
+  victim_bucket_ = 0;
+}
+
+uint32_t palCuckooFilter::NextKickRandom() {
+  // xorshift32
+  kick_random_ ^= kick_random_ << 13;
+  kick_random_ ^= kick_random_ >> 17;
+  kick_random_ ^= kick_random_ << 5;
+  return kick_random_;
+}
+
+bool palCuckooFilter::AddToBucket(uint32_t bucket, uint32_t fingerprint) {
+  uint64_t empty = ZeroSlots(buckets_[bucket]);
+  if (empty == 0) {
+    return false;
+  }
+  buckets_[bucket] |= (uint64_t)fingerprint << (FirstSlot(empty) * 16);
+  return true;
+}
+
+bool palCuckooFilter::RemoveFromBucket(uint32_t bucket, uint32_t fingerprint) {
+  uint64_t matches = ZeroSlots(buckets_[bucket] ^ Broadcast(fingerprint));
+  if (matches == 0) {
+    return false;
+  }
+  buckets_[bucket] &= ~(0xffffULL << (FirstSlot(matches) * 16));
+  return true;
+}
+
+/* Adds fingerprint to bucket or its alternate, evicting other fingerprints
+   if both are full. When no room is found the last evicted fingerprint
+   becomes the victim and false is returned. */
+bool palCuckooFilter::AddFingerprint(uint32_t bucket, uint32_t fingerprint) {
+  uint32_t alternate = AlternateBucket(bucket, fingerprint);
+  if (AddToBucket(bucket, fingerprint) || AddToBucket(alternate, fingerprint)) {
+    return true;
+  }
+  if (NextKickRandom() & 1) {
+    bucket = alternate;
+  }
+  for (int kick = 0; kick < kMaxKicks; kick++) {
+    // swap fingerprint with a random slot and move the evicted one to its other bucket
+    int shift = (NextKickRandom() % kSlotsPerBucket) * 16;
+    uint32_t evicted = (uint32_t)(buckets_[bucket] >> shift) & 0xffff;
+    buckets_[bucket] = (buckets_[bucket] & ~(0xffffULL << shift)) | ((uint64_t)fingerprint << shift);
+    fingerprint = evicted;
+    bucket = AlternateBucket(bucket, fingerprint);
+    if (AddToBucket(bucket, fingerprint)) {
+      return true;
+    }
+  }
+  victim_fingerprint_ = fingerprint;
+  victim_bucket_ = bucket;
+  return false;
+}
+
+bool palCuckooFilter::InsertHash(uint64_t hash) {
+  if (victim_fingerprint_ != 0) {
+    // full
+    return false;
+  }
+  // the key is counted even when its or another fingerprint became the victim
+  AddFingerprint(PrimaryBucket(hash), Fingerprint(hash));
+  count_++;
+  return true;
+}
+
+bool palCuckooFilter::RemoveHash(uint64_t hash) {
+  uint32_t fingerprint = Fingerprint(hash);
+  uint32_t bucket = PrimaryBucket(hash);
+  uint32_t alternate = AlternateBucket(bucket, fingerprint);
+  if (victim_fingerprint_ == fingerprint && (victim_bucket_ == bucket || victim_bucket_ == alternate)) {
+    victim_fingerprint_ = 0;
+    count_--;
+    return true;
+  }
+  if (RemoveFromBucket(bucket, fingerprint) == false && RemoveFromBucket(alternate, fingerprint) == false) {
+    return false;
+  }
+  count_--;
+  if (victim_fingerprint_ != 0) {
+    // there is room again, try to place the victim
+    uint32_t victim = victim_fingerprint_;
+    victim_fingerprint_ = 0;
+    AddFingerprint(victim_bucket_, victim);
+  }
+  return true;
+}
+
+double palCuckooFilter::GetFalsePositiveRate() const {
+  if (bucket_count_ == 0) {
+    return 0.0;
+  }
+  return 1.0 - pow(1.0 - 1.0 / fingerprint_mask_, 2.0 * kSlotsPerBucket);
+}
+
+uint64_t palCuckooFilter::GetSerializedSize() const {
+  return sizeof(palCuckooFilterHeader) + GetSizeInBytes();
+}
+
+int palCuckooFilter::Serialize(palMemBlob* blob) const {
+  if (blob->GetBufferSize() < GetSerializedSize()) {
+    return PAL_MEM_BLOB_NO_ROOM;
+  }
+  palCuckooFilterHeader header;
+  header.magic = kPalCuckooFilterMagic;
+  header.version = kPalCuckooFilterVersion;
+  header.bucket_count = bucket_count_;
+  header.fingerprint_bits = fingerprint_bits_;
+  header.count = count_;
+  header.victim_fingerprint = victim_fingerprint_;
+  header.victim_bucket = victim_bucket_;
+  palMemoryCopyBytes(blob->GetPtr(), &header, sizeof(header));
+  palMemoryCopyBytes(blob->GetPtr(sizeof(header)), buckets_, GetSizeInBytes());
+  return 0;
+}
+
+int palCuckooFilter::Deserialize(const palMemBlob& blob) {
+  palCuckooFilterHeader header;
+  if (blob.GetBufferSize() < sizeof(header)) {
+    return PAL_CUCKOO_FILTER_ERROR_INVALID_BLOB;
+  }
+  palMemoryCopyBytes(&header, blob.GetPtr(), sizeof(header));
+  bool power_of_two = header.bucket_count != 0 && (header.bucket_count & (header.bucket_count - 1)) == 0;
+  if (header.magic != kPalCuckooFilterMagic || header.version != kPalCuckooFilterVersion || power_of_two == false ||
+      header.fingerprint_bits < 4 || header.fingerprint_bits > kMaxFingerprintBits ||
+      blob.GetBufferSize() < sizeof(header) + (uint64_t)header.bucket_count * sizeof(uint64_t)) {
+    return PAL_CUCKOO_FILTER_ERROR_INVALID_BLOB;
+  }
+  // the victim is put back into its bucket by the next Remove
+  if (header.victim_bucket >= header.bucket_count || (header.victim_fingerprint >> header.fingerprint_bits) != 0) {
+    return PAL_CUCKOO_FILTER_ERROR_INVALID_BLOB;
+  }
+  AllocateBuckets(header.bucket_count, header.fingerprint_bits);
+  palMemoryCopyBytes(buckets_, blob.GetPtr(sizeof(header)), GetSizeInBytes());
+  count_ = header.count;
+  victim_fingerprint_ = header.victim_fingerprint;
+  victim_bucket_ = header.victim_bucket;
+  return 0;
+}
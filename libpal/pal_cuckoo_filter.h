@@ -0,0 +1,196 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_errorcode.h"
+#include "libpal/pal_allocator_interface.h"
+#include "libpal/pal_mem_blob.h"
+#include "libpal/pal_hash_functions.h"
+
+#define PAL_CUCKOO_FILTER_ERROR_INVALID_BLOB palMakeErrorCode(PAL_ERROR_CODE_FILTER_GROUP, 2)
+
+/* Cuckoo filter (Fan, Andersen, Kaminsky, Mitzenmacher 2014).
+
+   Like palBloomFilter it answers "definitely not present" or "maybe
+   present", but keys can also be removed. A key is stored as a small
+   fingerprint in one of two buckets of four slots. The second bucket is
+   the first one xor a hash of the fingerprint, so a fingerprint can be
+   moved between its buckets without knowing the key. Inserting into two
+   full buckets evicts fingerprints to their other bucket until one finds
+   a free slot.
+
+   A bucket is four 16 bit slots in one 64 bit word and is searched
+   without a loop. The false positive rate picks how many bits of each
+   slot are used for the fingerprint, between 4 and 16.
+
+   Only remove keys that were inserted, removing any other key may remove
+   a colliding fingerprint and cause a false negative. The same key can
+   only be inserted eight times before the filter fills up.
+*/
+class palCuckooFilter {
+public:
+  static const int kSlotsPerBucket = 4;
+  static const int kMaxFingerprintBits = 16;
+  static const int kMaxKicks = 500;
+protected:
+  palAllocatorInterface* allocator_;
+  uint64_t* buckets_;
+  uint32_t bucket_count_;
+  uint32_t bucket_mask_;
+  int fingerprint_bits_;
+  uint32_t fingerprint_mask_;
+  uint64_t count_;
+  // a fingerprint evicted when the filter filled up, 0 when empty
+  uint32_t victim_fingerprint_;
+  uint32_t victim_bucket_;
+  uint32_t kick_random_;
+
+  static uint64_t Broadcast(uint32_t fingerprint) {
+    return fingerprint * 0x0001000100010001ULL;
+  }
+
+  /* The high bit of each zero slot is set, slots after the first zero slot may be wrong */
+  static uint64_t ZeroSlots(uint64_t bucket) {
+    return (bucket - 0x0001000100010001ULL) & ~bucket & 0x8000800080008000ULL;
+  }
+
+  static int FirstSlot(uint64_t slots) {
+    int slot = 0;
+    while ((slots & 0x8000) == 0) {
+      slots >>= 16;
+      slot++;
+    }
+    return slot;
+  }
+
+  uint32_t Fingerprint(uint64_t hash) const {
+    uint32_t fingerprint = (uint32_t)(hash >> 32) & fingerprint_mask_;
+    // 0 marks an empty slot
+    return fingerprint != 0 ? fingerprint : 1;
+  }
+
+  uint32_t PrimaryBucket(uint64_t hash) const {
+    return (uint32_t)hash & bucket_mask_;
+  }
+
+  uint32_t AlternateBucket(uint32_t bucket, uint32_t fingerprint) const {
+    return (bucket ^ (fingerprint * 0x5bd1e995)) & bucket_mask_;
+  }
+
+  bool BucketContains(uint32_t bucket, uint32_t fingerprint) const {
+    return ZeroSlots(buckets_[bucket] ^ Broadcast(fingerprint)) != 0;
+  }
+
+  uint32_t NextKickRandom();
+  bool AddToBucket(uint32_t bucket, uint32_t fingerprint);
+  bool RemoveFromBucket(uint32_t bucket, uint32_t fingerprint);
+  bool AddFingerprint(uint32_t bucket, uint32_t fingerprint);
+  void AllocateBuckets(uint32_t bucket_count, int fingerprint_bits);
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palCuckooFilter);
+public:
+  palCuckooFilter();
+  ~palCuckooFilter();
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    allocator_ = allocator;
+  }
+
+  /* Sizes the filter to hold expected_count keys, with the fingerprint
+     long enough that a lookup of any other key answers true with
+     probability false_positive_rate at most. With 16 bit fingerprints
+     the lowest rate is about 0.00012 */
+  int Create(uint64_t expected_count, double false_positive_rate);
+  void Destroy();
+
+  /* Removes all keys */
+  void Clear();
+
+  /* Returns false when the filter is full */
+  bool InsertHash(uint64_t hash);
+
+  /* Returns false if no fingerprint of hash was found */
+  bool RemoveHash(uint64_t hash);
+
+  bool ContainsHash(uint64_t hash) const {
+    uint32_t fingerprint = Fingerprint(hash);
+    uint32_t bucket = PrimaryBucket(hash);
+    uint32_t alternate = AlternateBucket(bucket, fingerprint);
+    uint64_t matches = ZeroSlots(buckets_[bucket] ^ Broadcast(fingerprint)) | ZeroSlots(buckets_[alternate] ^ Broadcast(fingerprint));
+    if (matches != 0) {
+      return true;
+    }
+    return victim_fingerprint_ == fingerprint && (victim_bucket_ == bucket || victim_bucket_ == alternate);
+  }
+
+  template<class Key>
+  bool Insert(const Key& key) {
+    palHashFunction<Key> hash_function;
+    return InsertHash(hash_function(key));
+  }
+
+  template<class Key>
+  bool Remove(const Key& key) {
+    palHashFunction<Key> hash_function;
+    return RemoveHash(hash_function(key));
+  }
+
+  template<class Key>
+  bool Contains(const Key& key) const {
+    palHashFunction<Key> hash_function;
+    return ContainsHash(hash_function(key));
+  }
+
+  /* Number of keys inserted and not removed */
+  uint64_t GetCount() const {
+    return count_;
+  }
+
+  uint32_t GetBucketCount() const {
+    return bucket_count_;
+  }
+
+  int GetFingerprintBits() const {
+    return fingerprint_bits_;
+  }
+
+  uint64_t GetSizeInBytes() const {
+    return (uint64_t)bucket_count_ * sizeof(uint64_t);
+  }
+
+  float LoadFactor() const {
+    return bucket_count_ > 0 ? (float)count_ / (float)(bucket_count_ * kSlotsPerBucket) : 0.0f;
+  }
+
+  /* Upper bound on the false positive rate */
+  double GetFalsePositiveRate() const;
+
+  /* Serialization to a palMemBlob, the blob must be at least GetSerializedSize bytes */
+  uint64_t GetSerializedSize() const;
+  int Serialize(palMemBlob* blob) const;
+  /* Replaces this filter with the one serialized in blob */
+  int Deserialize(const palMemBlob& blob);
+};
@@ -0,0 +1,279 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#ifndef LIBPAL_PAL_DENSE_OBJECT_ID_TABLE_H_
+#define LIBPAL_PAL_DENSE_OBJECT_ID_TABLE_H_
+
+#include "libpal/pal_debug.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_array.h"
+#include "libpal/pal_hash_map.h"
+
+/*
+  Maps 32-bit integer IDs to objects, like palObjectIdTable, for tables that hold
+  many objects.
+
+  Template takes object type (T), the maximum number of objects as a power of two
+  (kPowTwoMaxObjects) and the number of slots in each page as a power of two
+  (kPowTwoObjectsPerPage).
+
+  The lower kPowTwoMaxObjects bits of an ID index a slot and the higher bits are
+  the slot's generation, which is bumped every time the slot is freed. A removed
+  ID therefore never maps to an object added later in the same slot.
+
+  Slots live in pages that are allocated as the table grows. Live objects are
+  kept packed at the front of a dense array (a sparse set), each slot knows where
+  its object sits in the dense array and each dense entry knows its ID. Removing
+  an object moves the last dense entry into the hole.
+
+  A hash map from object pointer to ID gives FindObjectID without a scan.
+
+  Complexity:
+
+  Add new object
+    O(1) (amortized)
+  Delete object by ID
+    O(1)
+  Fetch object pointer from ID
+    O(1)
+  Find object ID
+    O(1) (expected)
+  Iterate over all objects
+    O(number of live objects)
+
+  Iterate either by ID (GetFirstObjectID/GetNextObjectID, which must not be mixed
+  with removal) or by dense index (GetObjectAtIndex/GetObjectIDAtIndex for
+  0 <= index < GetSize()). Removing the object at dense index i moves the last
+  object to index i.
+*/
+template<typename T, int kPowTwoMaxObjects = 20, int kPowTwoObjectsPerPage = 10>
+class palDenseObjectIdTable {
+protected:
+  struct Slot {
+    uint32_t generation;
+    /* Index into the dense arrays when live. When free kSlotFreeBit is set and
+       the low bits index the next free slot */
+    uint32_t dense_index;
+  };
+
+  static const uint32_t kSlotFreeBit = 0x80000000;
+  static const uint32_t kMaxObjects = 1 << kPowTwoMaxObjects;
+  static const uint32_t kObjectsPerPage = 1 << kPowTwoObjectsPerPage;
+  static const uint32_t kIndexMask = kMaxObjects - 1;
+  static const uint32_t kPageMask = kObjectsPerPage - 1;
+  static const uint32_t kGenerationMask = 0xffffffff >> kPowTwoMaxObjects;
+  /* generations 0 and 1 are never handed out, so GetCapacity() is never a valid ID */
+  static const uint32_t kFirstGeneration = 2;
+
+  palAllocatorInterface* allocator_;
+  palArray<Slot*> pages_;
+  palArray<T*> dense_objects_;
+  palArray<uint32_t> dense_ids_;
+  palHashMap<const void*, uint32_t> object_to_id_;
+  uint32_t free_slot_;
+  uint32_t slot_count_;
+  uint32_t highwater_mark_;
+
+  Slot* GetSlot(uint32_t index) const {
+    return &pages_[index >> kPowTwoObjectsPerPage][index & kPageMask];
+  }
+
+  /* Returns the live slot id refers to or NULL */
+  Slot* LookupSlot(uint32_t id) const {
+    uint32_t index = id & kIndexMask;
+    if (index >= slot_count_) {
+      return NULL;
+    }
+    Slot* slot = GetSlot(index);
+    if ((slot->dense_index & kSlotFreeBit) || slot->generation != ((id >> kPowTwoMaxObjects) & kGenerationMask)) {
+      return NULL;
+    }
+    return slot;
+  }
+
+  bool AddPage() {
+    if (slot_count_ == kMaxObjects) {
+      return false;
+    }
+    Slot* page = static_cast<Slot*>(allocator_->Allocate(sizeof(Slot) * kObjectsPerPage, PAL_ALIGNOF(Slot)));
+    pages_.push_back(page);
+    // chain the new slots on to the free list, lowest index first
+    uint32_t first = slot_count_;
+    for (uint32_t i = 0; i < kObjectsPerPage; i++) {
+      page[i].generation = kFirstGeneration;
+      page[i].dense_index = kSlotFreeBit | (i + 1 < kObjectsPerPage ? first + i + 1 : free_slot_);
+    }
+    free_slot_ = first;
+    slot_count_ += kObjectsPerPage;
+    return true;
+  }
+
+  uint32_t MakeID(uint32_t generation, uint32_t index) const {
+    return (generation << kPowTwoMaxObjects) | index;
+  }
+public:
+  palDenseObjectIdTable() : allocator_(NULL), free_slot_(kMaxObjects), slot_count_(0), highwater_mark_(0) {
+    palAssert(kPowTwoObjectsPerPage <= kPowTwoMaxObjects);
+    palAssert(kPowTwoMaxObjects < 31);
+  }
+
+  ~palDenseObjectIdTable() {
+    Reset();
+  }
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    allocator_ = allocator;
+    pages_.SetAllocator(allocator);
+    dense_objects_.SetAllocator(allocator);
+    dense_ids_.SetAllocator(allocator);
+    object_to_id_.SetAllocator(allocator);
+  }
+
+  /* Also the value returned by AddObject when the table is full and by the ID
+     iteration functions when there are no more objects */
+  uint32_t GetCapacity() const {
+    return kMaxObjects;
+  }
+
+  uint32_t GetSize() const {
+    return (uint32_t)dense_objects_.GetSize();
+  }
+
+  uint32_t GetHighWaterMark() const {
+    return highwater_mark_;
+  }
+
+  /* Number of slots in allocated pages */
+  uint32_t GetAllocatedSlotCount() const {
+    return slot_count_;
+  }
+
+  uint32_t AddObject(T* o) {
+    palAssert(o != NULL);
+    if (free_slot_ == kMaxObjects && AddPage() == false) {
+      return kMaxObjects;
+    }
+
+    uint32_t index = free_slot_;
+    Slot* slot = GetSlot(index);
+    free_slot_ = slot->dense_index & ~kSlotFreeBit;
+
+    uint32_t id = MakeID(slot->generation, index);
+    slot->dense_index = (uint32_t)dense_objects_.push_back(o);
+    dense_ids_.push_back(id);
+    object_to_id_.Insert(o, id);
+
+    if (GetSize() > highwater_mark_) {
+      highwater_mark_ = GetSize();
+    }
+    return id;
+  }
+
+  T* RemoveObject(uint32_t id) {
+    Slot* slot = LookupSlot(id);
+    if (slot == NULL) {
+      // not actually in the table
+      return NULL;
+    }
+
+    uint32_t dense_index = slot->dense_index;
+    T* r = dense_objects_[dense_index];
+
+    // fill the hole with the last live object
+    uint32_t last = GetSize() - 1;
+    if (dense_index != last) {
+      uint32_t moved_id = dense_ids_[last];
+      dense_objects_[dense_index] = dense_objects_[last];
+      dense_ids_[dense_index] = moved_id;
+      GetSlot(moved_id & kIndexMask)->dense_index = dense_index;
+    }
+    dense_objects_.pop_back();
+    dense_ids_.pop_back();
+    object_to_id_.Remove(r);
+
+    uint32_t generation = (slot->generation + 1) & kGenerationMask;
+    slot->generation = generation < kFirstGeneration ? kFirstGeneration : generation;
+    slot->dense_index = kSlotFreeBit | free_slot_;
+    free_slot_ = id & kIndexMask;
+    return r;
+  }
+
+  T* MapObject(uint32_t id) const {
+    Slot* slot = LookupSlot(id);
+    if (slot == NULL) {
+      return NULL;
+    }
+    return dense_objects_[slot->dense_index];
+  }
+
+  uint32_t FindObjectID(T* o) const {
+    palAssert(o != NULL);
+    const uint32_t* id = object_to_id_.Find(o);
+    if (id == NULL) {
+      return kMaxObjects;
+    }
+    return *id;
+  }
+
+  /* Dense iteration */
+  T* GetObjectAtIndex(uint32_t index) const {
+    return dense_objects_[index];
+  }
+
+  uint32_t GetObjectIDAtIndex(uint32_t index) const {
+    return dense_ids_[index];
+  }
+
+  /* Iteration by ID */
+  uint32_t GetFirstObjectID() const {
+    if (GetSize() == 0) {
+      return kMaxObjects;
+    }
+    return dense_ids_[0];
+  }
+
+  uint32_t GetNextObjectID(uint32_t id) const {
+    Slot* slot = LookupSlot(id);
+    if (slot == NULL || slot->dense_index + 1 >= GetSize()) {
+      return kMaxObjects;
+    }
+    return dense_ids_[slot->dense_index + 1];
+  }
+
+  /* Removes all objects and frees the pages. Outstanding IDs may be handed out again. */
+  void Reset() {
+    for (int i = 0; i < pages_.GetSize(); i++) {
+      allocator_->Deallocate(pages_[i]);
+    }
+    pages_.Reset();
+    dense_objects_.Reset();
+    dense_ids_.Reset();
+    object_to_id_.Reset();
+    free_slot_ = kMaxObjects;
+    slot_count_ = 0;
+  }
+private:
+  PAL_DISALLOW_COPY_AND_ASSIGN(palDenseObjectIdTable);
+};
+
+#endif  // LIBPAL_PAL_DENSE_OBJECT_ID_TABLE_H_
@@ -0,0 +1,204 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_debug.h"
+#include "libpal/pal_allocator_interface.h"
+#include "libpal/pal_memory.h"
+#include "libpal/pal_align.h"
+
+/*
+  Double-ended queue stored in one ring buffer.
+
+  Push and pop at either end are amortized O(1) and never allocate unless
+  the ring is full. Elements are accessed by position from the front in O(1).
+  The capacity is always a power of two so wrapping is a mask.
+
+  When the ring is full it doubles, the elements are unwrapped into the new
+  buffer with at most two palMemoryCopyBytes calls. This means T is moved
+  bitwise and must not hold pointers into itself.
+*/
+template <typename T, uint32_t Alignment = PAL_ALIGNOF(T)>
+class palDeque {
+public:
+  /* Types and constants */
+  typedef palDeque<T, Alignment> this_type;
+  typedef T element_type;
+  static const uint32_t element_alignment = Alignment;
+protected:
+  palAllocatorInterface* allocator_;
+  T* buffer_;
+  int capacity_;
+  int head_;
+  int size_;
+
+  int Wrap(int i) const {
+    return i & (capacity_ - 1);
+  }
+
+  void Grow(int new_capacity) {
+    T* new_buffer = static_cast<T*>(allocator_->Allocate(new_capacity * sizeof(T), this_type::element_alignment));
+    if (size_ > 0) {
+      // unwrap: [head_, end of buffer) then [0, rest)
+      int first = capacity_ - head_;
+      if (first > size_) {
+        first = size_;
+      }
+      palMemoryCopyBytes(new_buffer, buffer_ + head_, first * sizeof(T));
+      if (first < size_) {
+        palMemoryCopyBytes(new_buffer + first, buffer_, (size_ - first) * sizeof(T));
+      }
+    }
+    if (buffer_ != NULL) {
+      allocator_->Deallocate(buffer_);
+    }
+    buffer_ = new_buffer;
+    capacity_ = new_capacity;
+    head_ = 0;
+  }
+
+  void MakeRoom() {
+    if (size_ == capacity_) {
+      Grow(capacity_ > 0 ? capacity_ * 2 : 8);
+    }
+  }
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palDeque);
+public:
+  palDeque() : allocator_(NULL), buffer_(NULL), capacity_(0), head_(0), size_(0) {
+  }
+
+  ~palDeque() {
+    Reset();
+  }
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    allocator_ = allocator;
+  }
+
+  palAllocatorInterface* GetAllocator() const {
+    return allocator_;
+  }
+
+  /* Element i from the front */
+  T& operator[](int i) {
+    return buffer_[Wrap(head_ + i)];
+  }
+
+  const T& operator[](int i) const {
+    return buffer_[Wrap(head_ + i)];
+  }
+
+  T& GetFront() {
+    return buffer_[head_];
+  }
+
+  const T& GetFront() const {
+    return buffer_[head_];
+  }
+
+  T& GetBack() {
+    return buffer_[Wrap(head_ + size_ - 1)];
+  }
+
+  const T& GetBack() const {
+    return buffer_[Wrap(head_ + size_ - 1)];
+  }
+
+  int GetSize() const {
+    return size_;
+  }
+
+  int GetCapacity() const {
+    return capacity_;
+  }
+
+  bool IsEmpty() const {
+    return size_ == 0;
+  }
+
+  /* Rounds new_capacity up to a power of two */
+  void Reserve(int new_capacity) {
+    if (new_capacity > capacity_) {
+      Grow(palRoundToPowerOfTwo(new_capacity));
+    }
+  }
+
+  void PushBack(const T& item) {
+    if (size_ == capacity_) {
+      // item may be one of our elements, copy it before Grow frees the buffer
+      T copy(item);
+      MakeRoom();
+      new (&buffer_[Wrap(head_ + size_)]) T(copy);
+    } else {
+      new (&buffer_[Wrap(head_ + size_)]) T(item);
+    }
+    size_++;
+  }
+
+  void PushFront(const T& item) {
+    if (size_ == capacity_) {
+      T copy(item);
+      MakeRoom();
+      head_ = Wrap(head_ - 1);
+      new (&buffer_[head_]) T(copy);
+    } else {
+      head_ = Wrap(head_ - 1);
+      new (&buffer_[head_]) T(item);
+    }
+    size_++;
+  }
+
+  void PopFront() {
+    palAssert(size_ > 0);
+    buffer_[head_].~T();
+    head_ = Wrap(head_ + 1);
+    size_--;
+  }
+
+  void PopBack() {
+    palAssert(size_ > 0);
+    GetBack().~T();
+    size_--;
+  }
+
+  /* Destroys all elements, keeps the buffer */
+  void Clear() {
+    for (int i = 0; i < size_; i++) {
+      (*this)[i].~T();
+    }
+    head_ = 0;
+    size_ = 0;
+  }
+
+  /* Destroys all elements and frees the buffer */
+  void Reset() {
+    Clear();
+    if (buffer_ != NULL) {
+      allocator_->Deallocate(buffer_);
+    }
+    buffer_ = NULL;
+    capacity_ = 0;
+  }
+};
@@ -12,3 +12,7 @@
 #define PAL_ERROR_CODE_BLOB_GROUP 0x5
 #define PAL_ERROR_CODE_TCPCLIENT_GROUP 0x6
 #define PAL_ERROR_CODE_SOCKET_GROUP 0x7
+#define PAL_ERROR_CODE_EXTERNAL_SORT_GROUP 0x8
+#define PAL_ERROR_CODE_FILTER_GROUP 0x9
+#define PAL_ERROR_CODE_HISTOGRAM_GROUP 0xa
+#define PAL_ERROR_CODE_NUMBER_GROUP 0xb
@@ -0,0 +1,164 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#include "libpal/pal_external_sort.h"
+
+palExternalSortRequest::palExternalSortRequest() : type(NUM_palExternalSortRequestTypes), file(NULL), stream(NULL), offset(0), buffer(NULL), bytes(0), bytes_done(0), result(0), pending(false) {
+  palSemaphoreDescription desc;
+  desc.name = NULL;
+  desc.initial_reservation = 0;
+  desc.maximum = 1;
+  done.Create(desc);
+}
+
+palExternalSortRequest::~palExternalSortRequest() {
+  palAssert(!pending);
+  done.Destroy();
+}
+
+palExternalSortIo::palExternalSortIo() : threaded_(false) {
+}
+
+palExternalSortIo::~palExternalSortIo() {
+  Destroy();
+}
+
+void palExternalSortIo::Execute(palExternalSortRequest* request) {
+  request->result = 0;
+  request->bytes_done = 0;
+  switch (request->type) {
+  case kPalExternalSortRequestFileRead:
+    // run files are only read within their known length, so a short read
+    // is an error and not the end of the run. OffsetRead returns 0 on failure.
+    request->bytes_done = request->file->OffsetRead(request->offset, request->buffer, request->bytes);
+    if (request->bytes_done != request->bytes) {
+      request->result = PAL_EXTERNAL_SORT_ERROR_READ;
+    }
+    break;
+  case kPalExternalSortRequestFileWrite:
+    request->bytes_done = request->file->OffsetWrite(request->offset, request->buffer, request->bytes);
+    if (request->bytes_done != request->bytes) {
+      request->result = PAL_EXTERNAL_SORT_ERROR_WRITE;
+    }
+    break;
+  case kPalExternalSortRequestStreamRead:
+    request->result = request->stream->Read(request->buffer, 0, request->bytes, &request->bytes_done);
+    break;
+  case kPalExternalSortRequestStreamWrite:
+    request->result = request->stream->Write(request->buffer, 0, request->bytes, &request->bytes_done);
+    break;
+  default:
+    palAssert(false);
+    break;
+  }
+}
+
+void palExternalSortIo::ThreadMain(uintptr_t param) {
+  palExternalSortIo* io = reinterpret_cast<palExternalSortIo*>(param);
+  for (;;) {
+    io->queue_semaphore_.Acquire();
+    palExternalSortRequest* request;
+    {
+      palScopedMutex lock(&io->queue_mutex_);
+      request = io->queue_.GetFront();
+      io->queue_.PopFront();
+    }
+    if (request == NULL) {
+      // Destroy asked us to stop
+      break;
+    }
+    Execute(request);
+    request->done.Release();
+  }
+  palThread::Exit(0);
+}
+
+int palExternalSortIo::Create(palAllocatorInterface* allocator, bool threaded) {
+  threaded_ = threaded;
+  if (!threaded_) {
+    return 0;
+  }
+  queue_.SetAllocator(allocator);
+  palMutexDescription mutex_desc;
+  int r = queue_mutex_.Create(mutex_desc);
+  if (r != 0) {
+    threaded_ = false;
+    return r;
+  }
+  palSemaphoreDescription semaphore_desc;
+  semaphore_desc.name = NULL;
+  semaphore_desc.initial_reservation = 0;
+  semaphore_desc.maximum = 0x7fffffff;
+  r = queue_semaphore_.Create(semaphore_desc);
+  if (r != 0) {
+    queue_mutex_.Destroy();
+    threaded_ = false;
+    return r;
+  }
+  palThreadDescription thread_desc;
+  thread_desc.name = "palExternalSortIo";
+  thread_desc.start_method = palThreadStart(ThreadMain);
+  r = thread_.Start(thread_desc, reinterpret_cast<uintptr_t>(this));
+  if (r != 0) {
+    queue_semaphore_.Destroy();
+    queue_mutex_.Destroy();
+    threaded_ = false;
+  }
+  return r;
+}
+
+void palExternalSortIo::Destroy() {
+  if (!threaded_) {
+    return;
+  }
+  Submit(NULL);
+  thread_.Join(NULL);
+  queue_.Reset();
+  queue_semaphore_.Destroy();
+  queue_mutex_.Destroy();
+  threaded_ = false;
+}
+
+void palExternalSortIo::Submit(palExternalSortRequest* request) {
+  if (!threaded_) {
+    Execute(request);
+    return;
+  }
+  if (request != NULL) {
+    palAssert(!request->pending);
+    request->pending = true;
+  }
+  {
+    palScopedMutex lock(&queue_mutex_);
+    queue_.PushBack(request);
+  }
+  queue_semaphore_.Release();
+}
+
+int palExternalSortIo::Wait(palExternalSortRequest* request) {
+  if (request->pending) {
+    request->done.Acquire();
+    request->pending = false;
+  }
+  return request->result;
+}
@@ -0,0 +1,519 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_errorcode.h"
+#include "libpal/pal_debug.h"
+#include "libpal/pal_allocator_interface.h"
+#include "libpal/pal_algorithms.h"
+#include "libpal/pal_array.h"
+#include "libpal/pal_deque.h"
+#include "libpal/pal_min_heap.h"
+#include "libpal/pal_file.h"
+#include "libpal/pal_stream_interface.h"
+#include "libpal/pal_thread.h"
+#include "libpal/pal_string.h"
+
+#define PAL_EXTERNAL_SORT_ERROR_BUDGET palMakeErrorCode(PAL_ERROR_CODE_EXTERNAL_SORT_GROUP, 1)
+#define PAL_EXTERNAL_SORT_ERROR_TEMP_FILE palMakeErrorCode(PAL_ERROR_CODE_EXTERNAL_SORT_GROUP, 2)
+#define PAL_EXTERNAL_SORT_ERROR_READ palMakeErrorCode(PAL_ERROR_CODE_EXTERNAL_SORT_GROUP, 3)
+#define PAL_EXTERNAL_SORT_ERROR_WRITE palMakeErrorCode(PAL_ERROR_CODE_EXTERNAL_SORT_GROUP, 4)
+#define PAL_EXTERNAL_SORT_ERROR_PARTIAL_RECORD palMakeErrorCode(PAL_ERROR_CODE_EXTERNAL_SORT_GROUP, 5)
+
+struct palExternalSortDescription {
+  /* Memory used for records and I/O buffers, allocated once per sort */
+  uint64_t memory_budget;
+  /* Size of each read and write buffer while merging */
+  uint32_t io_buffer_size;
+  /* Run files are named <temp_file_prefix>.<n> and deleted when done */
+  const char* temp_file_prefix;
+  /* Do file and stream I/O on a separate thread so it overlaps with
+     sorting and merging */
+  bool overlap_io;
+
+  palExternalSortDescription() : memory_budget(64*1024*1024), io_buffer_size(1024*1024), temp_file_prefix("palExternalSort"), overlap_io(true) {
+  }
+};
+
+enum palExternalSortRequestType {
+  kPalExternalSortRequestFileRead,
+  kPalExternalSortRequestFileWrite,
+  kPalExternalSortRequestStreamRead,
+  kPalExternalSortRequestStreamWrite,
+  NUM_palExternalSortRequestTypes
+};
+
+/* One read or write. File requests use offset, stream requests read or
+   write at the stream's position */
+struct palExternalSortRequest {
+  palExternalSortRequestType type;
+  palFile* file;
+  palStreamInterface* stream;
+  uint64_t offset;
+  void* buffer;
+  uint64_t bytes;
+  uint64_t bytes_done;
+  int result;
+  bool pending;
+  palSemaphore done;
+
+  palExternalSortRequest();
+  ~palExternalSortRequest();
+};
+
+/* Executes requests in submission order, either on the calling thread or
+   on its own I/O thread. Because requests complete in order a buffer can
+   be written and then read into again without waiting in between. */
+class palExternalSortIo {
+  palDeque<palExternalSortRequest*> queue_;
+  palMutex queue_mutex_;
+  palSemaphore queue_semaphore_;
+  palThread thread_;
+  bool threaded_;
+
+  static void Execute(palExternalSortRequest* request);
+  static void ThreadMain(uintptr_t param);
+  PAL_DISALLOW_COPY_AND_ASSIGN(palExternalSortIo);
+public:
+  palExternalSortIo();
+  ~palExternalSortIo();
+
+  int Create(palAllocatorInterface* allocator, bool threaded);
+  void Destroy();
+
+  void Submit(palExternalSortRequest* request);
+  /* Blocks until request is done and returns its result */
+  int Wait(palExternalSortRequest* request);
+};
+
+/*
+  Sorts fixed size records read from a palStreamInterface into another
+  palStreamInterface using no more than a fixed amount of memory.
+
+  T must be copyable with memcpy, it is read and written as raw bytes.
+  The sort is not stable.
+
+  1. Runs: the budget is split in two record buffers. While one buffer is
+     sorted with palIntroSort and written to its run file the other one is
+     filled from the input. If the whole input fits in one buffer it is
+     written straight to the output.
+  2. Merge: each run gets two read buffers and the output two write
+     buffers, one is being filled or drained while the other is in flight.
+     A palMinHeap holds the smallest unmerged record of each run. When there
+     are more runs than buffers fit in the budget, groups of runs are first
+     merged into longer runs.
+*/
+template<typename T, typename CompareFuncLessThan = palCompareFuncLessThan<T> >
+class palExternalSort {
+protected:
+  struct Run {
+    palFile file;
+    uint64_t records;
+  };
+
+  struct HeapEntry {
+    T record;
+    int reader;
+  };
+
+  class HeapEntryLessThan {
+  public:
+    bool operator()(const HeapEntry& a, const HeapEntry& b) {
+      CompareFuncLessThan LessThan;
+      if (LessThan(a.record, b.record)) {
+        return true;
+      }
+      if (LessThan(b.record, a.record)) {
+        return false;
+      }
+      return a.reader < b.reader;
+    }
+  };
+
+  /* Streams records out of a run file through two buffers */
+  struct RunReader {
+    Run* run;
+    T* buffers[2];
+    palExternalSortRequest requests[2];
+    uint64_t next_offset;
+    /* Bytes not yet submitted for reading */
+    uint64_t remaining_bytes;
+    /* Bytes of the run not yet handed out as records */
+    uint64_t unread_bytes;
+    int current;
+    int position;
+    int count;
+  };
+
+  /* Collects records into two buffers and writes them to a run or the output */
+  struct RunWriter {
+    Run* run;
+    palStreamInterface* stream;
+    T* buffers[2];
+    palExternalSortRequest requests[2];
+    uint64_t next_offset;
+    int current;
+    int count;
+    int capacity;
+  };
+
+  palExternalSortDescription desc_;
+  palAllocatorInterface* allocator_;
+  palExternalSortIo io_;
+  palArray<Run*> runs_;
+  int next_run_name_;
+  int result_;
+
+  void SetError(int result) {
+    if (result_ == 0) {
+      result_ = result;
+    }
+  }
+
+  Run* CreateRun() {
+    char filename[512];
+    palStringPrintf(filename, sizeof(filename), "%s.%d", desc_.temp_file_prefix, next_run_name_++);
+    Run* run = new (allocator_) Run();
+    run->records = 0;
+    if (run->file.Open(filename, kFileModeCreate, kFileAccessReadWrite) != 0) {
+      SetError(PAL_EXTERNAL_SORT_ERROR_TEMP_FILE);
+    }
+    return run;
+  }
+
+  void DestroyRun(Run* run) {
+    run->file.Close();
+    run->~Run();
+    allocator_->Deallocate(run);
+  }
+
+  void DeleteRunFiles() {
+    char filename[512];
+    for (int i = 0; i < next_run_name_; i++) {
+      palStringPrintf(filename, sizeof(filename), "%s.%d", desc_.temp_file_prefix, i);
+      palFile::Delete(filename);
+    }
+  }
+
+  void SubmitRead(palExternalSortRequest* request, palFile* file, palStreamInterface* stream, uint64_t offset, void* buffer, uint64_t bytes) {
+    request->type = file != NULL ? kPalExternalSortRequestFileRead : kPalExternalSortRequestStreamRead;
+    request->file = file;
+    request->stream = stream;
+    request->offset = offset;
+    request->buffer = buffer;
+    request->bytes = bytes;
+    io_.Submit(request);
+  }
+
+  void SubmitWrite(palExternalSortRequest* request, palFile* file, palStreamInterface* stream, uint64_t offset, void* buffer, uint64_t bytes) {
+    request->type = file != NULL ? kPalExternalSortRequestFileWrite : kPalExternalSortRequestStreamWrite;
+    request->file = file;
+    request->stream = stream;
+    request->offset = offset;
+    request->buffer = buffer;
+    request->bytes = bytes;
+    io_.Submit(request);
+  }
+
+  uint64_t InputReadSize(palStreamInterface* input, uint64_t bytes) {
+    if (input->CanSeek()) {
+      // not every stream reports a short read at the end
+      uint64_t remaining = input->GetLength() - input->GetPosition();
+      return remaining < bytes ? remaining : bytes;
+    }
+    return bytes;
+  }
+
+  /* Reads, sorts and writes runs. Returns true if the input fit into a
+     single buffer and was written to output directly. */
+  bool CreateRuns(palStreamInterface* input, palStreamInterface* output, T* memory, uint64_t run_records) {
+    T* buffers[2] = { memory, memory + run_records };
+    palExternalSortRequest reads[2];
+    palExternalSortRequest writes[2];
+    const uint64_t run_bytes = run_records * sizeof(T);
+    int current = 0;
+
+    // input reads go through the I/O queue too, only one is in flight at a time
+    SubmitRead(&reads[current], NULL, input, 0, buffers[current], InputReadSize(input, run_bytes));
+    bool first = true;
+    for (;;) {
+      if (io_.Wait(&reads[current]) != 0) {
+        SetError(PAL_EXTERNAL_SORT_ERROR_READ);
+        break;
+      }
+      uint64_t bytes = reads[current].bytes_done;
+      if (bytes % sizeof(T) != 0) {
+        SetError(PAL_EXTERNAL_SORT_ERROR_PARTIAL_RECORD);
+        break;
+      }
+      if (bytes == 0) {
+        break;
+      }
+      int other = current ^ 1;
+      // the previous write from the other buffer is ahead of this read in the queue
+      io_.Wait(&reads[other]);
+      SubmitRead(&reads[other], NULL, input, 0, buffers[other], InputReadSize(input, run_bytes));
+
+      uint64_t records = bytes / sizeof(T);
+      palIntroSort(buffers[current], (int)records, CompareFuncLessThan());
+
+      if (first && bytes < run_bytes) {
+        // the input might fit in one run, skip the run files if it does
+        io_.Wait(&reads[other]);
+        if (reads[other].result == 0 && reads[other].bytes_done == 0) {
+          SubmitWrite(&writes[current], NULL, output, 0, buffers[current], bytes);
+          if (io_.Wait(&writes[current]) != 0 || writes[current].bytes_done != bytes) {
+            SetError(PAL_EXTERNAL_SORT_ERROR_WRITE);
+          }
+          return true;
+        }
+      }
+      first = false;
+
+      Run* run = CreateRun();
+      run->records = records;
+      runs_.push_back(run);
+      if (result_ != 0) {
+        break;
+      }
+      io_.Wait(&writes[current]);
+      SubmitWrite(&writes[current], &run->file, NULL, 0, buffers[current], bytes);
+      current = other;
+    }
+    for (int i = 0; i < 2; i++) {
+      io_.Wait(&reads[i]);
+      if (io_.Wait(&writes[i]) != 0 || writes[i].bytes_done != writes[i].bytes) {
+        SetError(PAL_EXTERNAL_SORT_ERROR_WRITE);
+      }
+    }
+    return false;
+  }
+
+  void ReaderRefill(RunReader* reader, int buffer, uint64_t buffer_bytes) {
+    uint64_t bytes = reader->remaining_bytes < buffer_bytes ? reader->remaining_bytes : buffer_bytes;
+    if (bytes == 0) {
+      return;
+    }
+    SubmitRead(&reader->requests[buffer], &reader->run->file, NULL, reader->next_offset, reader->buffers[buffer], bytes);
+    reader->next_offset += bytes;
+    reader->remaining_bytes -= bytes;
+  }
+
+  /* Makes the next record current, returns false when the run is exhausted */
+  bool ReaderAdvance(RunReader* reader, uint64_t buffer_bytes) {
+    reader->position++;
+    if (reader->position < reader->count) {
+      return true;
+    }
+    int drained = reader->current;
+    reader->current ^= 1;
+    palExternalSortRequest* request = &reader->requests[reader->current];
+    if (!request->pending && request->bytes_done == 0) {
+      // a failed read looks like the end of the run, the length tells them apart
+      if (reader->unread_bytes != 0) {
+        SetError(PAL_EXTERNAL_SORT_ERROR_READ);
+      }
+      return false;
+    }
+    if (io_.Wait(request) != 0 || request->bytes_done % sizeof(T) != 0) {
+      SetError(PAL_EXTERNAL_SORT_ERROR_READ);
+      return false;
+    }
+    reader->position = 0;
+    reader->count = (int)(request->bytes_done / sizeof(T));
+    reader->unread_bytes -= request->bytes_done;
+    // mark consumed so an exhausted run is detected next time
+    request->bytes_done = 0;
+    ReaderRefill(reader, drained, buffer_bytes);
+    return reader->count > 0;
+  }
+
+  void WriterFlush(RunWriter* writer) {
+    if (writer->count == 0) {
+      return;
+    }
+    uint64_t bytes = (uint64_t)writer->count * sizeof(T);
+    if (writer->run != NULL) {
+      SubmitWrite(&writer->requests[writer->current], &writer->run->file, NULL, writer->next_offset, writer->buffers[writer->current], bytes);
+    } else {
+      SubmitWrite(&writer->requests[writer->current], NULL, writer->stream, 0, writer->buffers[writer->current], bytes);
+    }
+    writer->next_offset += bytes;
+    writer->current ^= 1;
+    writer->count = 0;
+    // the other buffer may still be on its way out
+    palExternalSortRequest* request = &writer->requests[writer->current];
+    if (io_.Wait(request) != 0 || request->bytes_done != request->bytes) {
+      SetError(PAL_EXTERNAL_SORT_ERROR_WRITE);
+    }
+  }
+
+  /* Merges runs [first, first + count) into target (a run or the output stream) */
+  void MergeRuns(int first, int count, Run* target_run, palStreamInterface* target_stream, T* memory, uint64_t buffer_records) {
+    const uint64_t buffer_bytes = buffer_records * sizeof(T);
+    RunReader* readers = static_cast<RunReader*>(allocator_->Allocate(sizeof(RunReader) * count));
+    palMinHeap<HeapEntry, HeapEntryLessThan> heap;
+    heap.SetAllocator(allocator_);
+
+    T* next_buffer = memory;
+    for (int i = 0; i < count; i++) {
+      RunReader* reader = new (&readers[i]) RunReader();
+      reader->run = runs_[first + i];
+      reader->buffers[0] = next_buffer;
+      reader->buffers[1] = next_buffer + buffer_records;
+      next_buffer += 2 * buffer_records;
+      reader->next_offset = 0;
+      reader->remaining_bytes = reader->run->records * sizeof(T);
+      reader->unread_bytes = reader->remaining_bytes;
+      // start as if buffer 1 was just drained, the first advance waits for
+      // buffer 0 and starts reading buffer 1
+      reader->current = 1;
+      reader->position = 0;
+      reader->count = 0;
+      ReaderRefill(reader, 0, buffer_bytes);
+    }
+
+    RunWriter writer;
+    writer.run = target_run;
+    writer.stream = target_stream;
+    writer.buffers[0] = next_buffer;
+    writer.buffers[1] = next_buffer + buffer_records;
+    writer.next_offset = 0;
+    writer.current = 0;
+    writer.count = 0;
+    writer.capacity = (int)buffer_records;
+
+    for (int i = 0; i < count; i++) {
+      RunReader* reader = &readers[i];
+      if (ReaderAdvance(reader, buffer_bytes)) {
+        HeapEntry entry;
+        entry.record = reader->buffers[reader->current][reader->position];
+        entry.reader = i;
+        heap.Insert(entry);
+      }
+    }
+
+    uint64_t records = 0;
+    while (!heap.IsEmpty() && result_ == 0) {
+      HeapEntry entry = heap.FindMin();
+      heap.DeleteMin();
+      writer.buffers[writer.current][writer.count++] = entry.record;
+      records++;
+      if (writer.count == writer.capacity) {
+        WriterFlush(&writer);
+      }
+      RunReader* reader = &readers[entry.reader];
+      if (ReaderAdvance(reader, buffer_bytes)) {
+        entry.record = reader->buffers[reader->current][reader->position];
+        heap.Insert(entry);
+      }
+    }
+    WriterFlush(&writer);
+    for (int i = 0; i < 2; i++) {
+      palExternalSortRequest* request = &writer.requests[i];
+      if (io_.Wait(request) != 0 || request->bytes_done != request->bytes) {
+        SetError(PAL_EXTERNAL_SORT_ERROR_WRITE);
+      }
+    }
+    if (target_run != NULL) {
+      target_run->records = records;
+    }
+
+    for (int i = 0; i < count; i++) {
+      io_.Wait(&readers[i].requests[0]);
+      io_.Wait(&readers[i].requests[1]);
+      readers[i].~RunReader();
+    }
+    allocator_->Deallocate(readers);
+  }
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palExternalSort);
+public:
+  palExternalSort() : allocator_(NULL), next_run_name_(0), result_(0) {
+  }
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    allocator_ = allocator;
+    runs_.SetAllocator(allocator);
+  }
+
+  /* Number of runs the last Sort wrote, 0 if it fit in memory */
+  int GetRunCount() const {
+    return next_run_name_;
+  }
+
+  int Sort(const palExternalSortDescription& desc, palStreamInterface* input, palStreamInterface* output) {
+    desc_ = desc;
+    result_ = 0;
+    next_run_name_ = 0;
+
+    const uint64_t buffer_records = desc_.io_buffer_size / sizeof(T);
+    const uint64_t run_records = desc_.memory_budget / 2 / sizeof(T);
+    // a merge needs at least two runs and the output, double buffered
+    if (buffer_records == 0 || run_records * 2 < 6 * buffer_records || run_records > 0x7fffffff) {
+      return PAL_EXTERNAL_SORT_ERROR_BUDGET;
+    }
+    const int max_fan_in = (int)(run_records * 2 / (2 * buffer_records)) - 1;
+
+    T* memory = static_cast<T*>(allocator_->Allocate((size_t)(run_records * 2 * sizeof(T)), PAL_ALIGNOF(T)));
+    int r = io_.Create(allocator_, desc_.overlap_io);
+    if (r != 0) {
+      allocator_->Deallocate(memory);
+      return r;
+    }
+
+    bool done = CreateRuns(input, output, memory, run_records);
+
+    // merge groups of runs until one merge can produce the output
+    int first = 0;
+    while (!done && result_ == 0 && runs_.GetSize() - first > max_fan_in) {
+      Run* run = CreateRun();
+      runs_.push_back(run);
+      if (result_ == 0) {
+        MergeRuns(first, max_fan_in, run, NULL, memory, buffer_records);
+      }
+      for (int i = first; i < first + max_fan_in; i++) {
+        DestroyRun(runs_[i]);
+        runs_[i] = NULL;
+      }
+      first += max_fan_in;
+    }
+    if (!done && result_ == 0) {
+      MergeRuns(first, runs_.GetSize() - first, NULL, output, memory, buffer_records);
+    }
+
+    io_.Destroy();
+    for (int i = first; i < runs_.GetSize(); i++) {
+      if (runs_[i] != NULL) {
+        DestroyRun(runs_[i]);
+      }
+    }
+    runs_.Reset();
+    DeleteRunFiles();
+    allocator_->Deallocate(memory);
+    return result_;
+  }
+};
@@ -0,0 +1,158 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_debug.h"
+#include "libpal/pal_array.h"
+
+#if defined(PAL_COMPILER_MICROSOFT)
+#include <intrin.h>
+#endif
+
+/*
+  A sorted set stored in Eytzinger (breadth first) order for searching.
+
+  Slot 1 is the root and the children of slot k are slots 2k and 2k+1, so
+  the first levels of the search share a few cache lines and each step
+  down only depends on a compare. The search prefetches the cache line
+  holding the node's descendants several levels down (four for 4 byte
+  elements), which hides most of the memory latency once the array no
+  longer fits in cache.
+
+  Searches return slots, 0 means not found. Slots run from 1 to GetSize(),
+  Build can report which sorted index ended up in each slot so callers can
+  lay out associated data in the same order.
+*/
+template <typename T>
+class palEytzingerArray {
+public:
+  typedef T element_type;
+  /* palArray aligns the tree to a cache line */
+  static const uint32_t element_alignment = 64;
+protected:
+  palArray<T, element_alignment> tree_;
+  int size_;
+
+  int BuildNode(const T* sorted, int i, int k, int* slot_to_sorted) {
+    if (k <= size_) {
+      i = BuildNode(sorted, i, 2 * k, slot_to_sorted);
+      tree_[k] = sorted[i];
+      if (slot_to_sorted != NULL) {
+        slot_to_sorted[k] = i;
+      }
+      i++;
+      i = BuildNode(sorted, i, 2 * k + 1, slot_to_sorted);
+    }
+    return i;
+  }
+
+  /* Elements per cache line. The descendants of slot k log2(stride) levels
+     down are the stride elements starting at slot k * stride */
+  static int PrefetchStride() {
+    return sizeof(T) >= 64 ? 1 : 64 / (int)sizeof(T);
+  }
+
+  /* The search walked right (appended a 1 bit) for every node that was
+     less than the needle after the last left turn. Undo those and the
+     left turn to get to the answer. */
+  static int ResolveSlot(int k) {
+#if defined(PAL_COMPILER_MICROSOFT)
+    unsigned long trailing_ones;
+    _BitScanForward(&trailing_ones, ~(unsigned long)k);
+    return k >> (trailing_ones + 1);
+#elif defined(PAL_COMPILER_GNU)
+    return k >> (__builtin_ctz(~(unsigned int)k) + 1);
+#else
+    while (k & 1) {
+      k >>= 1;
+    }
+    return k >> 1;
+#endif
+  }
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palEytzingerArray);
+public:
+  palEytzingerArray() : size_(0) {
+  }
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    tree_.SetAllocator(allocator);
+  }
+
+  /* sorted must be in ascending order. If slot_to_sorted is not NULL it
+     must hold count+1 ints and receives the sorted index of each slot. */
+  void Build(const T* sorted, int count, int* slot_to_sorted = NULL) {
+    size_ = count;
+    tree_.Resize(count + 1);
+    BuildNode(sorted, 0, 1, slot_to_sorted);
+  }
+
+  void Reset() {
+    tree_.Reset();
+    size_ = 0;
+  }
+
+  int GetSize() const {
+    return size_;
+  }
+
+  const T& GetAt(int slot) const {
+    palAssert(slot >= 1 && slot <= size_);
+    return tree_[slot];
+  }
+
+  /* Slot of the smallest element not less than needle, 0 if there is none */
+  int LowerBound(const T& needle) const {
+    const T* tree = tree_.GetConstPtr();
+    const int stride = PrefetchStride();
+    int k = 1;
+    while (k <= size_) {
+      PAL_PREFETCH(tree + k * stride);
+      k = 2 * k + (tree[k] < needle ? 1 : 0);
+    }
+    return ResolveSlot(k);
+  }
+
+  /* Slot of the smallest element greater than needle, 0 if there is none */
+  int UpperBound(const T& needle) const {
+    const T* tree = tree_.GetConstPtr();
+    const int stride = PrefetchStride();
+    int k = 1;
+    while (k <= size_) {
+      PAL_PREFETCH(tree + k * stride);
+      k = 2 * k + (needle < tree[k] ? 0 : 1);
+    }
+    return ResolveSlot(k);
+  }
+
+  /* Slot holding needle, 0 if it is not in the set */
+  int Find(const T& needle) const {
+    int slot = LowerBound(needle);
+    if (slot == 0 || needle < tree_[slot]) {
+      return 0;
+    }
+    return slot;
+  }
+};
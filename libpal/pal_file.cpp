@@ -152,22 +152,28 @@ uint64_t palFile::OffsetRead(uint64_t offset, void* buffer, uint64_t num_bytes)
   BOOL r;
   uint32_t bytes_read_;
   OVERLAPPED ol;
+  palMemoryZeroBytes(&ol, sizeof(ol));
   ol.Offset = offset & 0xFFFFFFFF;
   ol.OffsetHigh = offset >> 32;
   r = ReadFile(_pdata._handle, buffer, (DWORD)num_bytes, (LPDWORD)&bytes_read_, &ol);
-  uint64_t new_offset = ((uint64_t)ol.OffsetHigh << 32) | ol.Offset;
-  return new_offset-offset;
+  if (!r) {
+    return 0;
+  }
+  return bytes_read_;
 }
 
 uint64_t palFile::OffsetWrite(uint64_t offset, const void* buffer, uint64_t num_bytes) {
   BOOL r;
   uint32_t bytes_written_;
   OVERLAPPED ol;
+  palMemoryZeroBytes(&ol, sizeof(ol));
   ol.Offset = offset & 0xFFFFFFFF;
   ol.OffsetHigh = offset >> 32;
   r = WriteFile(_pdata._handle, buffer, (DWORD)num_bytes, (LPDWORD)&bytes_written_, &ol);
-  uint64_t new_offset = ((uint64_t)ol.OffsetHigh << 32) | ol.Offset;
-  return new_offset-offset;
+  if (!r) {
+    return 0;
+  }
+  return bytes_written_;
 }
 
 uint64_t palFile::GetPosition() {
@@ -224,6 +230,13 @@ int palFile::CopyFileContents(const char* filename, palMemBlob* blob) {
   return 0;
 }
 
+int palFile::Delete(const char* filename) {
+  if (DeleteFile(filename) == 0) {
+    return PAL_FILE_ERROR_DELETING;
+  }
+  return 0;
+}
+
 void palFile::FreeFileContents(palMemBlob* blob) {
   if (blob && blob->GetPtr(0)) {
     g_FileProxyAllocator->Deallocate(blob->GetPtr(0));
@@ -58,6 +58,7 @@ enum palFileMode {
 };
 
 #define PAL_FILE_ERROR_OPENNING palMakeErrorCode(0xcd, 1)
+#define PAL_FILE_ERROR_DELETING palMakeErrorCode(0xcd, 2)
 
 class palFile {
   PAL_DISALLOW_COPY_AND_ASSIGN(palFile);
@@ -100,4 +101,5 @@ public:
   static int CopyFileContentsAsString(const char* filename, palMemBlob* blob);
   static int CopyFileContents(const char* filename, palMemBlob* blob);
   static void FreeFileContents(palMemBlob* blob);
+  static int Delete(const char* filename);
 };
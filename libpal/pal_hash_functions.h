@@ -24,10 +24,16 @@
 #ifndef __PAL_HASH_FUNCTIONS_H
 #define __PAL_HASH_FUNCTIONS_H
 
+#include <string.h>
+
 #include "libpal/pal_platform.h"
 #include "libpal/pal_string.h"
 #include "libpal/pal_types.h"
 
+#if defined(PAL_COMPILER_MICROSOFT)
+#include <intrin.h>
+#endif
+
 template<class Key> struct palHashEqual {
 	bool operator()(const Key& x, const Key& y) const {
 		return x == y;
@@ -142,37 +148,302 @@ PAL_INLINE unsigned int palMurmurHash(const void* key, int len) {
   return palMurmurHashSeed(key, len, 0xc58f1a7b);
 }
 
+/* 64-bit hashing.
+ *
+ * palHash64 consumes the key one 8 byte word at a time, folding each word into
+ * the state with a full 64x64->128 bit multiply (the "mum" step popularized by wyhash).
+ * Because the state only ever advances by whole words the same hash can be computed:
+ *
+ * palHash64 - over a pointer and a length
+ * palHashString64 - over a NUL terminated string, hashing while scanning for the terminator
+ * palHashStream64 - incrementally, over data that arrives in pieces
+ *
+ * All three produce identical values for identical bytes.
+ */
+
+#define kPalHashDefaultSeed64 0x2d358dccaa6c78a5ULL
+
+#define kPalHashPrime64_0 0xa0761d6478bd642fULL
+#define kPalHashPrime64_1 0xe7037ed1a0b428dbULL
+#define kPalHashPrime64_2 0x8ebc6af09c88c6e3ULL
+#define kPalHashPrime64_3 0x589965cc75374cc3ULL
+
+// smallest page size on any supported platform, word reads that don't cross a page can't fault
+#define kPalHashSafeReadPageSize 4096
+
+/* Multiply a by b and fold the 128 bit product into 64 bits */
+PAL_INLINE uint64_t palHashMum64(uint64_t a, uint64_t b) {
+#if defined(PAL_COMPILER_GNU) && defined(PAL_ARCH_64BIT)
+  __uint128_t r = (__uint128_t)a * b;
+  return (uint64_t)r ^ (uint64_t)(r >> 64);
+#elif defined(PAL_COMPILER_MICROSOFT) && defined(PAL_ARCH_64BIT)
+  uint64_t hi;
+  uint64_t lo = _umul128(a, b, &hi);
+  return lo ^ hi;
+#else
+  uint64_t ha = a >> 32;
+  uint64_t hb = b >> 32;
+  uint64_t la = (uint32_t)a;
+  uint64_t lb = (uint32_t)b;
+  uint64_t rh = ha * hb;
+  uint64_t rm0 = ha * lb;
+  uint64_t rm1 = hb * la;
+  uint64_t rl = la * lb;
+  uint64_t t = rl + (rm0 << 32);
+  uint64_t carry = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  carry += lo < t;
+  uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+  return lo ^ hi;
+#endif
+}
+
+/* Integer mixers. Both are bijections, so distinct keys never collide before the modulo. */
+PAL_INLINE uint32_t palHashMix32(uint32_t x) {
+  x += 0x9e3779b9;
+  x ^= x >> 16;
+  x *= 0x7feb352d;
+  x ^= x >> 15;
+  x *= 0x846ca68b;
+  x ^= x >> 16;
+  return x;
+}
+
+PAL_INLINE uint64_t palHashMix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+PAL_INLINE uint64_t palHashRead64(const uint8_t* p) {
+  uint64_t w;
+  memcpy(&w, p, sizeof(w));
+  return w;
+}
+
+PAL_INLINE bool palHashIsLittleEndian() {
+  const uint32_t probe = 1;
+  return *(const uint8_t*)&probe == 1;
+}
+
+PAL_INLINE bool palHashCanReadWord64(const uint8_t* p) {
+  return ((uintptr_t)p & (kPalHashSafeReadPageSize - 1)) <= kPalHashSafeReadPageSize - 8;
+}
+
+/* Returns 0x80 in every byte of w that is zero and 0x00 in every other byte */
+PAL_INLINE uint64_t palHashZeroBytes64(uint64_t w) {
+  const uint64_t low7 = 0x7f7f7f7f7f7f7f7fULL;
+  return ~(((w & low7) + low7) | w | low7);
+}
+
+/* Number of bytes, in memory order, before the first byte flagged in zero_bytes (which must not be 0) */
+PAL_INLINE int palHashLeadingBytes64(uint64_t zero_bytes) {
+#if defined(PAL_COMPILER_GNU)
+  if (palHashIsLittleEndian()) {
+    return __builtin_ctzll(zero_bytes) >> 3;
+  }
+  return __builtin_clzll(zero_bytes) >> 3;
+#elif defined(PAL_COMPILER_MICROSOFT) && defined(PAL_ARCH_64BIT)
+  unsigned long index;
+  _BitScanForward64(&index, zero_bytes);
+  return (int)(index >> 3);
+#else
+  int count = 0;
+  if (palHashIsLittleEndian()) {
+    while ((zero_bytes & 0xff) == 0) {
+      zero_bytes >>= 8;
+      count++;
+    }
+  } else {
+    while ((zero_bytes >> 56) == 0) {
+      zero_bytes <<= 8;
+      count++;
+    }
+  }
+  return count;
+#endif
+}
+
+/* Keeps the first count (0..7) bytes, in memory order, of w and zeroes the rest */
+PAL_INLINE uint64_t palHashKeepBytes64(uint64_t w, int count) {
+  if (count == 0) {
+    return 0;
+  }
+  if (palHashIsLittleEndian()) {
+    return w & (~0ULL >> (64 - count * 8));
+  }
+  return w & (~0ULL << (64 - count * 8));
+}
+
+/* Loads the final count (0..7) bytes of a key into a zero padded word. Only
+ * the bytes inside the key are touched, the key may end anywhere in memory.
+ */
+PAL_INLINE uint64_t palHashReadTail64(const uint8_t* p, int count) {
+  uint64_t tail = 0;
+  if (count == 0) {
+    return 0;
+  }
+  memcpy(&tail, p, count);
+  return tail;
+}
+
+PAL_INLINE uint64_t palHashStart64(uint64_t seed) {
+  return seed ^ kPalHashPrime64_0;
+}
+
+PAL_INLINE uint64_t palHashStep64(uint64_t state, uint64_t word) {
+  return palHashMum64(word ^ kPalHashPrime64_1, state ^ kPalHashPrime64_2);
+}
+
+PAL_INLINE uint64_t palHashFinish64(uint64_t state, uint64_t tail, uint64_t length) {
+  state = palHashMum64(tail ^ kPalHashPrime64_3, state ^ kPalHashPrime64_2);
+  return palHashMum64(state ^ kPalHashPrime64_0, length ^ kPalHashPrime64_1);
+}
+
+PAL_INLINE uint64_t palHash64(const void* key, int len, uint64_t seed = kPalHashDefaultSeed64) {
+  const uint8_t* data = (const uint8_t*)key;
+  const int nwords = len >> 3;
+  uint64_t h = palHashStart64(seed);
+
+  for (int i = 0; i < nwords; i++) {
+    h = palHashStep64(h, palHashRead64(data));
+    data += 8;
+  }
+
+  return palHashFinish64(h, palHashReadTail64(data, len & 7), (uint64_t)len);
+}
+
+/* Hashes str while looking for its terminator, so the string is only walked once.
+ * Word reads may look past the terminator but never across a page boundary.
+ * If length_out is not NULL it receives the length of the string.
+ */
+PAL_INLINE uint64_t palHashString64(const char* str, int* length_out = NULL, uint64_t seed = kPalHashDefaultSeed64) {
+  const uint8_t* start = (const uint8_t*)str;
+  const uint8_t* p = start;
+  uint64_t h = palHashStart64(seed);
+  uint64_t tail = 0;
+  int tail_length = 0;
+
+  if (p != NULL) {
+    while (true) {
+      if (palHashCanReadWord64(p)) {
+        uint64_t w = palHashRead64(p);
+        uint64_t zero_bytes = palHashZeroBytes64(w);
+        if (zero_bytes == 0) {
+          h = palHashStep64(h, w);
+          p += 8;
+          continue;
+        }
+        tail_length = palHashLeadingBytes64(zero_bytes);
+        tail = palHashKeepBytes64(w, tail_length);
+        break;
+      }
+      // the word straddles a page, go byte by byte
+      tail_length = 0;
+      while (tail_length < 8 && p[tail_length] != 0) {
+        tail_length++;
+      }
+      if (tail_length < 8) {
+        memcpy(&tail, p, tail_length);
+        break;
+      }
+      h = palHashStep64(h, palHashRead64(p));
+      p += 8;
+    }
+  }
+
+  int length = (int)(p - start) + tail_length;
+  if (length_out) {
+    *length_out = length;
+  }
+  return palHashFinish64(h, tail, (uint64_t)length);
+}
+
+/* Incremental palHash64. Update may be called with any split of the input. */
+class palHashStream64 {
+  uint64_t state_;
+  uint64_t length_;
+  uint8_t buffer_[8];
+  int buffered_;
+public:
+  palHashStream64(uint64_t seed = kPalHashDefaultSeed64) {
+    Reset(seed);
+  }
+
+  void Reset(uint64_t seed = kPalHashDefaultSeed64) {
+    state_ = palHashStart64(seed);
+    length_ = 0;
+    buffered_ = 0;
+  }
+
+  void Update(const void* data, int len) {
+    const uint8_t* p = (const uint8_t*)data;
+    length_ += (uint64_t)len;
+
+    if (buffered_ > 0) {
+      // top up the partial word left over from the last call
+      while (buffered_ < 8 && len > 0) {
+        buffer_[buffered_++] = *p++;
+        len--;
+      }
+      if (buffered_ < 8) {
+        return;
+      }
+      state_ = palHashStep64(state_, palHashRead64(buffer_));
+      buffered_ = 0;
+    }
+
+    while (len >= 8) {
+      state_ = palHashStep64(state_, palHashRead64(p));
+      p += 8;
+      len -= 8;
+    }
+
+    while (len > 0) {
+      buffer_[buffered_++] = *p++;
+      len--;
+    }
+  }
+
+  uint64_t Digest() const {
+    uint64_t tail = 0;
+    memcpy(&tail, buffer_, buffered_);
+    return palHashFinish64(state_, tail, length_);
+  }
+};
+
 // base palHashFunction template
 template<typename T>  struct palHashFunction
 {
-	unsigned int operator()(const T& key) const;
+	uint64_t operator()(const T& key) const;
 };
 
-/* Standard types uint64_t, uint32_t, const void* and const char* implementations */
+/* Standard types uint64_t, uint32_t, int, const void*, const char* and palDynamicString implementations */
 template<>
 struct palHashFunction<uint64_t>
 {
-	unsigned int operator()(const uint64_t& key) const
+	uint64_t operator()(const uint64_t& key) const
 	{
-    return palMurmurHash(reinterpret_cast<const void*>(&key), sizeof(uint64_t));
+    return palHashMix64(key);
 	}
 };
 
 template<> 
 struct palHashFunction<uint32_t>
 {
-	unsigned int operator()(const uint32_t& key) const
+	uint64_t operator()(const uint32_t& key) const
 	{
-    return palMurmurHash(reinterpret_cast<const void*>(&key), sizeof(uint32_t));
+    return palHashMix32(key);
 	}
 };
 
 template<> 
 struct palHashFunction<int>
 {
-  unsigned int operator()(const int& key) const
+  uint64_t operator()(const int& key) const
   {
-    return palMurmurHash(reinterpret_cast<const void*>(&key), sizeof(int));
+    return palHashMix32((uint32_t)key);
   }
 };
 
@@ -187,24 +458,24 @@ struct palHashFunction<uintptr_t> {
 
 template<>
 struct palHashFunction<const void*> {
-  unsigned int operator()(const void* const& key) const {
-    return palMurmurHash(key, sizeof(void*));
+  uint64_t operator()(const void* const& key) const {
+    return palHashMix64((uint64_t)(uintptr_t)key);
   }
 };
 
 template<>
 struct palHashFunction<const char*>
 {
-	unsigned int operator()(const char* const& key) const
+	uint64_t operator()(const char* const& key) const
 	{
-    return palMurmurHash(key, palStringLength(key));
+    return palHashString64(key);
 	}
 };
 
 template<>
 struct palHashFunction<palDynamicString> {
-  unsigned int operator()(const palDynamicString& str) {
-    return palMurmurHash(str.C(), str.GetLength());
+  uint64_t operator()(const palDynamicString& str) const {
+    return palHash64(str.C(), str.GetLength());
   }
 };
 
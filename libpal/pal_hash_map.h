@@ -127,7 +127,7 @@ protected:
     // rehash
     for(int i = 0; i < size; i++) {
       const Key& key = key_array_[i];
-      int bucket = hash_function_(key) % new_bucket_size;
+      int bucket = static_cast<int>(hash_function_(key) % new_bucket_size);
 
       /* Each item hashed is put at the head of the list */
       /* chain_next_[i] points to the previous head of the list */
@@ -220,7 +220,7 @@ public:
     }
 
     /* Determine which bucket this key should be chained in */
-    int bucket = hash_function_(key) % hash_bucket_list_head_.GetSize();
+    int bucket = static_cast<int>(hash_function_(key) % hash_bucket_list_head_.GetSize());
     /* Insert this item as head of list */
 		chain_next_[insert_index] = hash_bucket_list_head_[bucket];
     hash_bucket_list_head_[bucket] = insert_index;
@@ -234,7 +234,7 @@ public:
 			return false;
 		}
 
-    int bucket = hash_function_(key) % hash_bucket_list_head_.GetSize();
+    int bucket = static_cast<int>(hash_function_(key) % hash_bucket_list_head_.GetSize());
     palAssert(hash_bucket_list_head_[bucket] != kPalHashNULL);
 
     // find the previous node in the bucket's list
@@ -272,7 +272,7 @@ public:
 
 		// Remove the last pair from the hash table.
 		const Key& last_item_key = key_array_[last_item_index];
-		int last_item_bucket = hash_function_(last_item_key) % hash_bucket_list_head_.GetSize();
+		int last_item_bucket = static_cast<int>(hash_function_(last_item_key) % hash_bucket_list_head_.GetSize());
     palAssert(hash_bucket_list_head_[last_item_bucket] != kPalHashNULL);
 
 		index = hash_bucket_list_head_[last_item_bucket];
@@ -364,7 +364,7 @@ public:
 			return kPalHashNULL;
 
     /* Find bucket */
-		int bucket = hash_function_(key) % hash_bucket_list_head_.GetSize();
+		int bucket = static_cast<int>(hash_function_(key) % hash_bucket_list_head_.GetSize());
 
 		int index = hash_bucket_list_head_[bucket];
     // while not at end of list and object is not the one we are looking for
@@ -375,6 +375,40 @@ public:
 		return index;
 	}
 
+  /* Heterogeneous lookup: finds a key equal (==) to a LookupKey without
+   * constructing a Key, e.g. a palStringView in a map keyed by
+   * palDynamicString. palHashFunction<LookupKey> must hash a LookupKey to
+   * the same value HashFunction gives the equal Key. */
+  template <class LookupKey>
+  int FindIndexAs(const LookupKey& key) const {
+    if (IsEmpty())
+      return kPalHashNULL;
+    int bucket = static_cast<int>(palHashFunction<LookupKey>()(key) % hash_bucket_list_head_.GetSize());
+    int index = hash_bucket_list_head_[bucket];
+    while ((index != kPalHashNULL) && (key == key_array_[index]) == false) {
+      index = chain_next_[index];
+    }
+    return index;
+  }
+
+  template <class LookupKey>
+  const Value* FindAs(const LookupKey& key) const {
+    int index = FindIndexAs(key);
+    if (index == kPalHashNULL) {
+      return NULL;
+    }
+    return GetValueAtIndex(index);
+  }
+
+  template <class LookupKey>
+  Value* FindAs(const LookupKey& key) {
+    int index = FindIndexAs(key);
+    if (index == kPalHashNULL) {
+      return NULL;
+    }
+    return GetValueAtIndex(index);
+  }
+
 	void Clear() {
 		hash_bucket_list_head_.Clear();
 		chain_next_.Clear();
@@ -117,7 +117,7 @@ public:
     // rehash
     for(int i = 0; i < size; i++) {
       const Key& key = key_array_[i];
-      int bucket = hash_function_(key) % new_bucket_size;
+      int bucket = static_cast<int>(hash_function_(key) % new_bucket_size);
 
       /* Each item hashed is put at the head of the list */
       /* chain_next_[i] points to the previous head of the list */
@@ -194,7 +194,7 @@ public:
     }
 
     /* Determine which bucket this key should be chained in */
-    int bucket = hash_function_(key) % hash_bucket_list_head_.GetSize();
+    int bucket = static_cast<int>(hash_function_(key) % hash_bucket_list_head_.GetSize());
     /* Insert this item as head of list */
     chain_next_[insert_index] = hash_bucket_list_head_[bucket];
     hash_bucket_list_head_[bucket] = insert_index;
@@ -208,7 +208,7 @@ public:
       return false;
     }
 
-    int bucket = hash_function_(key) % hash_bucket_list_head_.GetSize();
+    int bucket = static_cast<int>(hash_function_(key) % hash_bucket_list_head_.GetSize());
     palAssert(hash_bucket_list_head_[bucket] != kPalHashNULL);
 
     // find the previous node in the bucket's list
@@ -245,7 +245,7 @@ public:
 
     // Remove the last pair from the hash table.
     const Key& last_item_key = key_array_[last_item_index];
-    int last_item_bucket = hash_function_(last_item_key) % hash_bucket_list_head_.GetSize();
+    int last_item_bucket = static_cast<int>(hash_function_(last_item_key) % hash_bucket_list_head_.GetSize());
     palAssert(hash_bucket_list_head_[last_item_bucket] != kPalHashNULL);
 
     index = hash_bucket_list_head_[last_item_bucket];
@@ -312,7 +312,7 @@ public:
       return kPalHashNULL;
 
     /* Find bucket */
-    int bucket = hash_function_(key) % hash_bucket_list_head_.GetSize();
+    int bucket = static_cast<int>(hash_function_(key) % hash_bucket_list_head_.GetSize());
 
     int index = hash_bucket_list_head_[bucket];
     // while not at end of list and object is not the one we are looking for
@@ -0,0 +1,212 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#ifndef LIBPAL_PAL_HASHED_STRING_H_
+#define LIBPAL_PAL_HASHED_STRING_H_
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_string.h"
+#include "libpal/pal_hash_functions.h"
+
+/* A string that carries its hash.
+ *
+ * palHashedString is a non-owning view: a pointer, a length and the hash of
+ * those bytes. The characters must outlive the palHashedString.
+ *
+ * palHashedDynamicString owns its characters in a palDynamicString and keeps
+ * the hash in sync whenever the string is set.
+ *
+ * Both hash to the same value as palHashFunction<const char*> would for the
+ * same characters, so a key can be hashed once and then looked up in any
+ * number of tables without rehashing. Equality checks the hashes and lengths
+ * before touching the characters.
+ */
+
+class palHashedString {
+  const char* str_;
+  int length_;
+  uint64_t hash_;
+public:
+  palHashedString() : str_(NULL), length_(0), hash_(palHash64(NULL, 0)) {
+  }
+
+  /* str must be NUL terminated, it is only walked once */
+  explicit palHashedString(const char* str) : str_(str) {
+    hash_ = palHashString64(str, &length_);
+  }
+
+  palHashedString(const char* str, int length) : str_(str), length_(length), hash_(palHash64(str, length)) {
+  }
+
+  /* For hashes that were computed ahead of time, must match palHash64(str, length) */
+  palHashedString(const char* str, int length, uint64_t hash) : str_(str), length_(length), hash_(hash) {
+  }
+
+  explicit palHashedString(const palDynamicString& str) : str_(str.C()), length_(str.GetLength()), hash_(palHash64(str.C(), str.GetLength())) {
+  }
+
+  const char* C() const {
+    return str_;
+  }
+
+  int GetLength() const {
+    return length_;
+  }
+
+  uint64_t GetHash() const {
+    return hash_;
+  }
+
+  bool Equals(const palHashedString& other) const {
+    if (hash_ != other.hash_ || length_ != other.length_) {
+      return false;
+    }
+    if (str_ == other.str_) {
+      return true;
+    }
+    return memcmp(str_, other.str_, length_) == 0;
+  }
+};
+
+PAL_INLINE bool operator==(const palHashedString& A, const palHashedString& B) {
+  return A.Equals(B);
+}
+
+PAL_INLINE bool operator!=(const palHashedString& A, const palHashedString& B) {
+  return A.Equals(B) == false;
+}
+
+class palHashedDynamicString {
+  palDynamicString str_;
+  uint64_t hash_;
+
+  void Rehash() {
+    hash_ = palHash64(str_.C(), str_.GetLength());
+  }
+public:
+  palHashedDynamicString() : str_(), hash_(palHash64(NULL, 0)) {
+  }
+
+  explicit palHashedDynamicString(const char* str) : str_() {
+    Set(str);
+  }
+
+  explicit palHashedDynamicString(const palHashedString& str) : str_(), hash_(str.GetHash()) {
+    str_.Set(str.C(), str.GetLength());
+  }
+
+  palHashedDynamicString(const palHashedDynamicString& other) : str_(other.str_), hash_(other.hash_) {
+  }
+
+  palHashedDynamicString& operator=(const palHashedDynamicString& other) {
+    if (this != &other) {
+      str_.Set(other.str_);
+      hash_ = other.hash_;
+    }
+    return *this;
+  }
+
+  void Set(const char* str) {
+    int length;
+    hash_ = palHashString64(str, &length);
+    str_.Set(str, length);
+  }
+
+  void Set(const char* str, int length) {
+    str_.Set(str, length);
+    Rehash();
+  }
+
+  void Set(const palHashedString& str) {
+    str_.Set(str.C(), str.GetLength());
+    hash_ = str.GetHash();
+  }
+
+  /* palDynamicString is mutable, callers that change it must call Set again */
+  const palDynamicString& GetDynamicString() const {
+    return str_;
+  }
+
+  const char* C() const {
+    return str_.C();
+  }
+
+  int GetLength() const {
+    return str_.GetLength();
+  }
+
+  uint64_t GetHash() const {
+    return hash_;
+  }
+
+  palHashedString GetHashedString() const {
+    return palHashedString(str_.C(), str_.GetLength(), hash_);
+  }
+
+  bool Equals(const palHashedDynamicString& other) const {
+    return GetHashedString().Equals(other.GetHashedString());
+  }
+
+  bool Equals(const palHashedString& other) const {
+    return GetHashedString().Equals(other);
+  }
+};
+
+PAL_INLINE bool operator==(const palHashedDynamicString& A, const palHashedDynamicString& B) {
+  return A.Equals(B);
+}
+
+PAL_INLINE bool operator!=(const palHashedDynamicString& A, const palHashedDynamicString& B) {
+  return A.Equals(B) == false;
+}
+
+template<>
+struct palHashFunction<palHashedString> {
+  uint64_t operator()(const palHashedString& key) const {
+    return key.GetHash();
+  }
+};
+
+template<>
+struct palHashFunction<palHashedDynamicString> {
+  uint64_t operator()(const palHashedDynamicString& key) const {
+    return key.GetHash();
+  }
+};
+
+template<>
+struct palHashEqual<palHashedString> {
+  bool operator()(const palHashedString& x, const palHashedString& y) const {
+    return x.Equals(y);
+  }
+};
+
+template<>
+struct palHashEqual<palHashedDynamicString> {
+  bool operator()(const palHashedDynamicString& x, const palHashedDynamicString& y) const {
+    return x.Equals(y);
+  }
+};
+
+#endif  // LIBPAL_PAL_HASHED_STRING_H_
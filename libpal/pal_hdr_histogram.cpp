@@ -0,0 +1,294 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#include <math.h>
+#include "libpal/pal_debug.h"
+#include "libpal/pal_memory.h"
+#include "libpal/pal_hdr_histogram.h"
+
+#define kPalHdrHistogramMagic 0x48524448 // HDRH
+#define kPalHdrHistogramVersion 1
+
+struct palHdrHistogramHeader {
+  uint32_t magic;
+  uint32_t version;
+  int64_t highest_trackable_value;
+  int32_t significant_figures;
+  // number of encoded counts, the counts after them are 0
+  int32_t encoded_length;
+};
+
+/* LEB128 of the zigzag encoding of value */
+static void palHdrHistogramWriteVarint(palGrowingMemoryBlob* blob, int64_t value) {
+  uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+  unsigned char bytes[10];
+  int length = 0;
+  do {
+    unsigned char byte = (unsigned char)(zigzag & 0x7f);
+    zigzag >>= 7;
+    bytes[length++] = byte | (zigzag != 0 ? 0x80 : 0);
+  } while (zigzag != 0);
+  blob->Append(bytes, length);
+}
+
+static bool palHdrHistogramReadVarint(const unsigned char** cursor, const unsigned char* end, int64_t* value) {
+  uint64_t zigzag = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (*cursor == end) {
+      return false;
+    }
+    unsigned char byte = *(*cursor)++;
+    zigzag |= (uint64_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+palHdrHistogram::palHdrHistogram() : allocator_(NULL), counts_(NULL), highest_trackable_value_(0),
+                                     significant_figures_(0), counts_length_(0), bucket_count_(0),
+                                     sub_bucket_count_(0), sub_bucket_half_count_magnitude_(0) {
+}
+
+palHdrHistogram::~palHdrHistogram() {
+  Destroy();
+}
+
+int palHdrHistogram::Create(const palHdrHistogramDescription& desc) {
+  palAssert(desc.significant_figures >= 1 && desc.significant_figures <= 5);
+  palAssert(desc.highest_trackable_value >= 2);
+  Destroy();
+  highest_trackable_value_ = desc.highest_trackable_value;
+  significant_figures_ = desc.significant_figures;
+
+  // values below 2 * 10^significant_figures are counted exactly
+  int64_t largest_single_unit_value = 2;
+  for (int i = 0; i < significant_figures_; i++) {
+    largest_single_unit_value *= 10;
+  }
+  int sub_bucket_count_magnitude = 0;
+  while ((1LL << sub_bucket_count_magnitude) < largest_single_unit_value) {
+    sub_bucket_count_magnitude++;
+  }
+  sub_bucket_half_count_magnitude_ = sub_bucket_count_magnitude - 1;
+  sub_bucket_count_ = 1 << sub_bucket_count_magnitude;
+
+  // each further bucket covers twice the range of the previous one
+  int64_t smallest_untrackable_value = sub_bucket_count_;
+  bucket_count_ = 1;
+  while (smallest_untrackable_value <= highest_trackable_value_) {
+    if (smallest_untrackable_value > 0x3fffffffffffffffLL) {
+      bucket_count_++;
+      break;
+    }
+    smallest_untrackable_value <<= 1;
+    bucket_count_++;
+  }
+  counts_length_ = (bucket_count_ + 1) * (sub_bucket_count_ >> 1);
+  counts_ = static_cast<volatile int64_t*>(allocator_->Allocate(GetMemorySize(), 64));
+  Reset();
+  return 0;
+}
+
+void palHdrHistogram::Destroy() {
+  if (counts_ != NULL) {
+    allocator_->Deallocate((void*)counts_);
+    counts_ = NULL;
+  }
+  counts_length_ = 0;
+}
+
+void palHdrHistogram::Reset() {
+  for (int i = 0; i < counts_length_; i++) {
+    counts_[i] = 0;
+  }
+}
+
+int64_t palHdrHistogram::ValueFromIndex(int index) const {
+  int bucket_index = (index >> sub_bucket_half_count_magnitude_) - 1;
+  int64_t sub_bucket_index = (index & ((sub_bucket_count_ >> 1) - 1)) + (sub_bucket_count_ >> 1);
+  if (bucket_index < 0) {
+    sub_bucket_index -= sub_bucket_count_ >> 1;
+    bucket_index = 0;
+  }
+  return sub_bucket_index << bucket_index;
+}
+
+int64_t palHdrHistogram::LowestEquivalentValue(int64_t value) const {
+  int bucket_index = BucketIndex(value);
+  return (value >> bucket_index) << bucket_index;
+}
+
+int64_t palHdrHistogram::HighestEquivalentValue(int64_t value) const {
+  return LowestEquivalentValue(value) + (1LL << BucketIndex(value)) - 1;
+}
+
+void palHdrHistogram::Add(const palHdrHistogram& other) {
+  bool same_layout = other.counts_length_ == counts_length_ && other.sub_bucket_count_ == sub_bucket_count_;
+  for (int i = 0; i < other.counts_length_; i++) {
+    int64_t count = other.counts_[i];
+    if (count == 0) {
+      continue;
+    }
+    if (same_layout) {
+      counts_[i] = counts_[i] + count;
+    } else {
+      RecordValues(other.ValueFromIndex(i), count);
+    }
+  }
+}
+
+int64_t palHdrHistogram::GetTotalCount() const {
+  int64_t total = 0;
+  for (int i = 0; i < counts_length_; i++) {
+    total += counts_[i];
+  }
+  return total;
+}
+
+int64_t palHdrHistogram::GetValueAtPercentile(double percentile) const {
+  int64_t total = GetTotalCount();
+  if (total == 0) {
+    return 0;
+  }
+  if (percentile > 100.0) {
+    percentile = 100.0;
+  }
+  int64_t count_at_percentile = (int64_t)ceil(percentile / 100.0 * total);
+  if (count_at_percentile < 1) {
+    count_at_percentile = 1;
+  }
+  int64_t running = 0;
+  for (int i = 0; i < counts_length_; i++) {
+    running += counts_[i];
+    if (running >= count_at_percentile) {
+      return HighestEquivalentValue(ValueFromIndex(i));
+    }
+  }
+  return GetMax();
+}
+
+int64_t palHdrHistogram::GetMin() const {
+  for (int i = 0; i < counts_length_; i++) {
+    if (counts_[i] != 0) {
+      return LowestEquivalentValue(ValueFromIndex(i));
+    }
+  }
+  return 0;
+}
+
+int64_t palHdrHistogram::GetMax() const {
+  for (int i = counts_length_ - 1; i >= 0; i--) {
+    if (counts_[i] != 0) {
+      return HighestEquivalentValue(ValueFromIndex(i));
+    }
+  }
+  return 0;
+}
+
+double palHdrHistogram::GetMean() const {
+  double sum = 0.0;
+  int64_t total = 0;
+  for (int i = 0; i < counts_length_; i++) {
+    int64_t count = counts_[i];
+    if (count != 0) {
+      int64_t value = ValueFromIndex(i);
+      // middle of the range of values counted here
+      double middle = (double)LowestEquivalentValue(value) + (double)(1LL << BucketIndex(value)) * 0.5;
+      sum += middle * count;
+      total += count;
+    }
+  }
+  return total > 0 ? sum / total : 0.0;
+}
+
+void palHdrHistogram::Serialize(palGrowingMemoryBlob* blob) const {
+  int encoded_length = counts_length_;
+  while (encoded_length > 0 && counts_[encoded_length - 1] == 0) {
+    encoded_length--;
+  }
+  palHdrHistogramHeader header;
+  header.magic = kPalHdrHistogramMagic;
+  header.version = kPalHdrHistogramVersion;
+  header.highest_trackable_value = highest_trackable_value_;
+  header.significant_figures = significant_figures_;
+  header.encoded_length = encoded_length;
+  blob->Append(&header, sizeof(header));
+  // positive numbers are counts, negative numbers are runs of zero counts
+  int i = 0;
+  while (i < encoded_length) {
+    int64_t count = counts_[i];
+    if (count != 0) {
+      palHdrHistogramWriteVarint(blob, count);
+      i++;
+      continue;
+    }
+    int zeros = 0;
+    while (i < encoded_length && counts_[i] == 0) {
+      zeros++;
+      i++;
+    }
+    palHdrHistogramWriteVarint(blob, -zeros);
+  }
+}
+
+int palHdrHistogram::Deserialize(const palMemBlob& blob) {
+  palHdrHistogramHeader header;
+  if (blob.GetBufferSize() < sizeof(header)) {
+    return PAL_HDR_HISTOGRAM_ERROR_INVALID_BLOB;
+  }
+  palMemoryCopyBytes(&header, blob.GetPtr(), sizeof(header));
+  if (header.magic != kPalHdrHistogramMagic || header.version != kPalHdrHistogramVersion ||
+      header.significant_figures < 1 || header.significant_figures > 5 || header.highest_trackable_value < 2) {
+    return PAL_HDR_HISTOGRAM_ERROR_INVALID_BLOB;
+  }
+  palHdrHistogramDescription desc;
+  desc.highest_trackable_value = header.highest_trackable_value;
+  desc.significant_figures = header.significant_figures;
+  Create(desc);
+  if (header.encoded_length < 0 || header.encoded_length > counts_length_) {
+    Reset();
+    return PAL_HDR_HISTOGRAM_ERROR_INVALID_BLOB;
+  }
+  const unsigned char* cursor = blob.GetPtr<const unsigned char>(sizeof(header));
+  const unsigned char* end = blob.GetPtr<const unsigned char>(blob.GetBufferSize());
+  int i = 0;
+  while (i < header.encoded_length) {
+    int64_t value;
+    // compare without negating value, a malformed blob can decode INT64_MIN
+    if (palHdrHistogramReadVarint(&cursor, end, &value) == false || value == 0 ||
+        value < -(int64_t)(header.encoded_length - i)) {
+      Reset();
+      return PAL_HDR_HISTOGRAM_ERROR_INVALID_BLOB;
+    }
+    if (value < 0) {
+      i += (int)-value;
+    } else {
+      counts_[i] = value;
+      i++;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,169 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_errorcode.h"
+#include "libpal/pal_allocator_interface.h"
+#include "libpal/pal_mem_blob.h"
+
+#if defined(PAL_COMPILER_MICROSOFT)
+#include <intrin.h>
+#endif
+
+#define PAL_HDR_HISTOGRAM_ERROR_INVALID_BLOB palMakeErrorCode(PAL_ERROR_CODE_HISTOGRAM_GROUP, 1)
+
+/* High dynamic range histogram (after Gil Tene's HdrHistogram).
+
+   Records integer values from 0 to highest_trackable_value keeping
+   significant_figures decimal digits of precision: with 3 significant
+   figures any recorded value is reported within 0.1% of itself. Values
+   are bucketed by their power of two and, inside that, linearly by their
+   top bits, so recording is a count leading zeros, two shifts and an
+   increment with no search or allocation.
+
+   Values are in whatever unit the caller picks (timer ticks, nanoseconds,
+   microseconds). Values above highest_trackable_value are recorded as
+   highest_trackable_value.
+
+   Threads: a histogram is recorded into by one thread. Another thread may
+   Add it into its own histogram at any time without a lock, it sees a
+   snapshot that may miss the most recent values. So every thread records
+   into its own histogram and a reporter merges them. On 32 bit targets
+   a merge running concurrently may read a partially written count.
+*/
+struct palHdrHistogramDescription {
+  int64_t highest_trackable_value;
+  int significant_figures;  // 1 to 5
+
+  palHdrHistogramDescription() : highest_trackable_value(3600LL * 1000 * 1000), significant_figures(3) {
+  }
+};
+
+class palHdrHistogram {
+protected:
+  palAllocatorInterface* allocator_;
+  volatile int64_t* counts_;
+  int64_t highest_trackable_value_;
+  int significant_figures_;
+  int counts_length_;
+  int bucket_count_;
+  int sub_bucket_count_;
+  int sub_bucket_half_count_magnitude_;
+
+  static int LeadingZeros(uint64_t value) {
+#if defined(PAL_COMPILER_GNU)
+    return __builtin_clzll(value);
+#elif defined(PAL_COMPILER_MICROSOFT) && defined(PAL_ARCH_64BIT)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - (int)index;
+#else
+    int count = 0;
+    while ((value & 0x8000000000000000ULL) == 0) {
+      value <<= 1;
+      count++;
+    }
+    return count;
+#endif
+  }
+
+  int BucketIndex(int64_t value) const {
+    // value | mask keeps values below sub_bucket_count_ in bucket 0
+    return 64 - LeadingZeros((uint64_t)value | (sub_bucket_count_ - 1)) - (sub_bucket_half_count_magnitude_ + 1);
+  }
+
+  int CountsIndex(int64_t value) const {
+    int bucket_index = BucketIndex(value);
+    int sub_bucket_index = (int)(value >> bucket_index);
+    return ((bucket_index + 1) << sub_bucket_half_count_magnitude_) + sub_bucket_index - (sub_bucket_count_ >> 1);
+  }
+
+  int64_t ValueFromIndex(int index) const;
+  int64_t LowestEquivalentValue(int64_t value) const;
+  int64_t HighestEquivalentValue(int64_t value) const;
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palHdrHistogram);
+public:
+  palHdrHistogram();
+  ~palHdrHistogram();
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    allocator_ = allocator;
+  }
+
+  int Create(const palHdrHistogramDescription& desc);
+  void Destroy();
+
+  /* Forgets all recorded values */
+  void Reset();
+
+  void RecordValue(int64_t value) {
+    RecordValues(value, 1);
+  }
+
+  /* Records value count times */
+  void RecordValues(int64_t value, int64_t count) {
+    if (value > highest_trackable_value_) {
+      value = highest_trackable_value_;
+    } else if (value < 0) {
+      value = 0;
+    }
+    volatile int64_t* slot = &counts_[CountsIndex(value)];
+    *slot = *slot + count;
+  }
+
+  /* Adds the values recorded in other, which can be recording concurrently */
+  void Add(const palHdrHistogram& other);
+
+  /* Number of values recorded, this and the queries below walk all counts */
+  int64_t GetTotalCount() const;
+
+  /* The value at or below which percentile percent of the recorded values fall */
+  int64_t GetValueAtPercentile(double percentile) const;
+  int64_t GetMin() const;
+  int64_t GetMax() const;
+  double GetMean() const;
+
+  int64_t GetHighestTrackableValue() const {
+    return highest_trackable_value_;
+  }
+
+  int GetSignificantFigures() const {
+    return significant_figures_;
+  }
+
+  /* Size of the count array in bytes */
+  uint64_t GetMemorySize() const {
+    return (uint64_t)counts_length_ * sizeof(int64_t);
+  }
+
+  /* Appends the histogram to blob. Runs of empty buckets are collapsed
+     and counts are variable length encoded, so the result is usually a
+     few hundred bytes. */
+  void Serialize(palGrowingMemoryBlob* blob) const;
+  /* Replaces this histogram with the one serialized in blob */
+  int Deserialize(const palMemBlob& blob);
+};
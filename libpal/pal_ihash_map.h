@@ -0,0 +1,398 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#ifndef LIBPAL_PAL_IHASH_MAP_H__
+#define LIBPAL_PAL_IHASH_MAP_H__
+
+/* Intrusive hash map: like palIList the node is placed inside the
+   container class, the map only owns an array of bucket heads.
+   Indexing objects that already live elsewhere costs no allocation
+   per entry.
+
+   Each node caches the hash of its key, so chains are walked comparing
+   hashes first and the table is grown without hashing keys again. Nodes
+   also keep the address of the pointer that points at them (like the
+   Linux kernel hlist) which makes removing a node O(1) without a search.
+
+   The bucket count is a power of two. When the load factor reaches 1
+   the bucket array doubles, but nodes are moved over incrementally: every
+   Insert and Remove moves a couple of the old buckets, so no single call
+   pays for rehashing the whole table. Until the move finishes lookups
+   check the bucket in the old array if it hasn't been moved yet.
+
+   An object must be removed from the map before it is destroyed or
+   moved, and can be in one map per node it declares.
+
+   Usage:
+
+   struct Texture {
+     palDynamicString name;
+     palIHashMapNodeDeclare(Texture, by_name);
+   };
+
+   struct TextureName {
+     const palDynamicString& operator()(const Texture* texture) const {
+       return texture->name;
+     }
+   };
+
+   palIHashMapDeclare(palDynamicString, Texture, by_name, TextureName) textures;
+*/
+
+#include "libpal/pal_debug.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_allocator_interface.h"
+#include "libpal/pal_memory.h"
+#include "libpal/pal_hash_functions.h"
+#include "libpal/pal_ilist.h"
+
+#define palIHashMapNodeDeclare(Type, MemberName)\
+  static size_t offset_##MemberName(void) { return palIListNode_offsetof(Type, MemberName); }\
+  palIHashMapNode MemberName
+
+#define palIHashMapDeclare(Key, Type, MemberName, KeyFunction) palIHashMap<Key, Type, Type::offset_##MemberName, KeyFunction>
+
+#define palIHashMapNodeValue(node, Type, MemberName) reinterpret_cast<Type*>(reinterpret_cast<unsigned char*>(node) - Type::offset_##MemberName())
+
+// smallest bucket array
+#define kPalIHashMapMinimumBuckets 16
+// old buckets moved to the new bucket array per Insert or Remove while growing
+#define kPalIHashMapBucketsMovedPerUpdate 2
+
+struct palIHashMapNode {
+  palIHashMapNode* next;
+  // address of the bucket head or previous node's next pointing at this node, NULL when not in a map
+  palIHashMapNode** pprev;
+  uint64_t hash;
+
+  palIHashMapNode() : next(NULL), pprev(NULL), hash(0) {
+  }
+};
+
+/* KeyFunction returns the key of an object: const Key& operator()(const T* object) const */
+template <class Key, typename T, size_t offset(void), class KeyFunction, class HashFunction = palHashFunction<Key>, class KeyEqual = palHashEqual<Key> >
+class palIHashMap {
+public:
+  /* Types and constants */
+  typedef palIHashMap<Key, T, offset, KeyFunction, HashFunction, KeyEqual> this_type;
+  typedef Key key_type;
+  typedef T value_type;
+protected:
+  palAllocatorInterface* allocator_;
+
+  palIHashMapNode** buckets_;
+  int bucket_count_;
+  int bucket_shift_;
+
+  // bucket array being moved into buckets_, buckets [0, moved_buckets_) are already empty
+  palIHashMapNode** old_buckets_;
+  int old_bucket_count_;
+  int old_bucket_shift_;
+  int moved_buckets_;
+
+  int size_;
+
+  HashFunction hash_function_;
+  KeyEqual key_equal_function_;
+  KeyFunction key_function_;
+
+  static T* NodeValue(const palIHashMapNode* node) {
+    return reinterpret_cast<T*>(reinterpret_cast<size_t>(node) - offset());
+  }
+
+  static palIHashMapNode* ValueNode(const T* value) {
+    return reinterpret_cast<palIHashMapNode*>(reinterpret_cast<size_t>(value) + offset());
+  }
+
+  /* Fibonacci hashing, the top bits of the product select the bucket */
+  static int BucketIndex(uint64_t hash, int shift) {
+    return static_cast<int>((hash * 0x9e3779b97f4a7c15ULL) >> shift);
+  }
+
+  static int BucketShift(int bucket_count) {
+    int shift = 64;
+    while (bucket_count > 1) {
+      bucket_count >>= 1;
+      shift--;
+    }
+    return shift;
+  }
+
+  palIHashMapNode** GetBucket(uint64_t hash) const {
+    if (old_buckets_ != NULL) {
+      int index = BucketIndex(hash, old_bucket_shift_);
+      if (index >= moved_buckets_) {
+        return &old_buckets_[index];
+      }
+    }
+    return &buckets_[BucketIndex(hash, bucket_shift_)];
+  }
+
+  static void LinkNode(palIHashMapNode* node, palIHashMapNode** head) {
+    node->next = *head;
+    if (node->next != NULL) {
+      node->next->pprev = &node->next;
+    }
+    node->pprev = head;
+    *head = node;
+  }
+
+  static void UnlinkNode(palIHashMapNode* node) {
+    *node->pprev = node->next;
+    if (node->next != NULL) {
+      node->next->pprev = node->pprev;
+    }
+    node->next = NULL;
+    node->pprev = NULL;
+  }
+
+  palIHashMapNode** AllocateBuckets(int count) {
+    palIHashMapNode** buckets = static_cast<palIHashMapNode**>(allocator_->Allocate(count * sizeof(palIHashMapNode*)));
+    palMemoryZeroBytes(buckets, count * sizeof(palIHashMapNode*));
+    return buckets;
+  }
+
+  void MoveBuckets(int count) {
+    while (old_buckets_ != NULL && count > 0) {
+      palIHashMapNode* node = old_buckets_[moved_buckets_];
+      while (node != NULL) {
+        palIHashMapNode* next = node->next;
+        LinkNode(node, &buckets_[BucketIndex(node->hash, bucket_shift_)]);
+        node = next;
+      }
+      old_buckets_[moved_buckets_] = NULL;
+      moved_buckets_++;
+      count--;
+      if (moved_buckets_ == old_bucket_count_) {
+        allocator_->Deallocate(old_buckets_);
+        old_buckets_ = NULL;
+        old_bucket_count_ = 0;
+        old_bucket_shift_ = 64;
+        moved_buckets_ = 0;
+      }
+    }
+  }
+
+  /* Starts moving into a bucket array of new_bucket_count buckets.
+     A previous move is finished first. */
+  void Rehash(int new_bucket_count) {
+    MoveBuckets(old_bucket_count_);
+    palIHashMapNode** new_buckets = AllocateBuckets(new_bucket_count);
+    if (size_ == 0) {
+      if (buckets_ != NULL) {
+        allocator_->Deallocate(buckets_);
+      }
+    } else {
+      old_buckets_ = buckets_;
+      old_bucket_count_ = bucket_count_;
+      old_bucket_shift_ = bucket_shift_;
+      moved_buckets_ = 0;
+    }
+    buckets_ = new_buckets;
+    bucket_count_ = new_bucket_count;
+    bucket_shift_ = BucketShift(new_bucket_count);
+  }
+
+  const palIHashMapNode* FindNode(const Key& key, uint64_t hash) const {
+    if (size_ == 0) {
+      return NULL;
+    }
+    const palIHashMapNode* node = *GetBucket(hash);
+    while (node != NULL) {
+      if (node->hash == hash && key_equal_function_(key, key_function_(NodeValue(node)))) {
+        return node;
+      }
+      node = node->next;
+    }
+    return NULL;
+  }
+
+  /* First object in old buckets [old_index, old_bucket_count_) or after that in buckets [index, bucket_count_) */
+  T* FirstFrom(int old_index, int index) const {
+    if (old_buckets_ != NULL) {
+      for (; old_index < old_bucket_count_; old_index++) {
+        if (old_buckets_[old_index] != NULL) {
+          return NodeValue(old_buckets_[old_index]);
+        }
+      }
+    }
+    for (; index < bucket_count_; index++) {
+      if (buckets_[index] != NULL) {
+        return NodeValue(buckets_[index]);
+      }
+    }
+    return NULL;
+  }
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palIHashMap);
+public:
+  palIHashMap() : allocator_(NULL), buckets_(NULL), bucket_count_(0), bucket_shift_(64),
+                  old_buckets_(NULL), old_bucket_count_(0), old_bucket_shift_(64), moved_buckets_(0),
+                  size_(0), hash_function_(HashFunction()), key_equal_function_(KeyEqual()), key_function_(KeyFunction()) {
+  }
+
+  ~palIHashMap() {
+    Reset();
+  }
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    allocator_ = allocator;
+  }
+
+  palAllocatorInterface* GetAllocator() const {
+    return allocator_;
+  }
+
+  /* Inserts object, returns false if an object with an equal key is already in the map */
+  bool Insert(T* value) {
+    palIHashMapNode* node = ValueNode(value);
+    palAssert(node->pprev == NULL);
+    uint64_t hash = hash_function_(key_function_(value));
+    if (FindNode(key_function_(value), hash) != NULL) {
+      return false;
+    }
+    if (size_ >= bucket_count_) {
+      Rehash(bucket_count_ > 0 ? bucket_count_ * 2 : kPalIHashMapMinimumBuckets);
+    }
+    MoveBuckets(kPalIHashMapBucketsMovedPerUpdate);
+    node->hash = hash;
+    LinkNode(node, GetBucket(hash));
+    size_++;
+    return true;
+  }
+
+  /* Removes object from the map in O(1) */
+  void Remove(T* value) {
+    palIHashMapNode* node = ValueNode(value);
+    palAssert(node->pprev != NULL);
+    UnlinkNode(node);
+    size_--;
+    MoveBuckets(kPalIHashMapBucketsMovedPerUpdate);
+  }
+
+  /* Removes and returns the object with key, NULL if not present */
+  T* Remove(const Key& key) {
+    const palIHashMapNode* node = FindNode(key, hash_function_(key));
+    if (node == NULL) {
+      return NULL;
+    }
+    T* value = NodeValue(node);
+    Remove(value);
+    return value;
+  }
+
+  T* Find(const Key& key) const {
+    const palIHashMapNode* node = FindNode(key, hash_function_(key));
+    return node != NULL ? NodeValue(node) : NULL;
+  }
+
+  bool Contains(const Key& key) const {
+    return Find(key) != NULL;
+  }
+
+  /* Is object in a map using this node */
+  static bool IsInserted(const T* value) {
+    return ValueNode(value)->pprev != NULL;
+  }
+
+  /* Iteration in no particular order. The map must not be changed while iterating */
+  T* GetFirst() const {
+    return FirstFrom(moved_buckets_, 0);
+  }
+
+  T* GetNext(const T* value) const {
+    const palIHashMapNode* node = ValueNode(value);
+    if (node->next != NULL) {
+      return NodeValue(node->next);
+    }
+    if (old_buckets_ != NULL) {
+      int old_index = BucketIndex(node->hash, old_bucket_shift_);
+      if (old_index >= moved_buckets_) {
+        return FirstFrom(old_index + 1, 0);
+      }
+    }
+    return FirstFrom(old_bucket_count_, BucketIndex(node->hash, bucket_shift_) + 1);
+  }
+
+  /* Grows the bucket array to hold count objects without growing again, moving all objects now */
+  void Reserve(int count) {
+    int new_bucket_count = bucket_count_ > 0 ? bucket_count_ : kPalIHashMapMinimumBuckets;
+    while (new_bucket_count < count) {
+      new_bucket_count *= 2;
+    }
+    if (new_bucket_count > bucket_count_) {
+      Rehash(new_bucket_count);
+      MoveBuckets(old_bucket_count_);
+    }
+  }
+
+  int GetSize() const {
+    return size_;
+  }
+
+  bool IsEmpty() const {
+    return size_ == 0;
+  }
+
+  int GetBucketCount() const {
+    return bucket_count_;
+  }
+
+  /* Are objects still being moved into a grown bucket array */
+  bool IsGrowing() const {
+    return old_buckets_ != NULL;
+  }
+
+  float LoadFactor() const {
+    return bucket_count_ > 0 ? (float)size_ / (float)bucket_count_ : 0.0f;
+  }
+
+  /* Removes all objects, keeps the bucket array */
+  void Clear() {
+    MoveBuckets(old_bucket_count_);
+    for (int i = 0; i < bucket_count_; i++) {
+      palIHashMapNode* node = buckets_[i];
+      while (node != NULL) {
+        palIHashMapNode* next = node->next;
+        node->next = NULL;
+        node->pprev = NULL;
+        node = next;
+      }
+      buckets_[i] = NULL;
+    }
+    size_ = 0;
+  }
+
+  /* Removes all objects and frees the bucket array */
+  void Reset() {
+    Clear();
+    if (buckets_ != NULL) {
+      allocator_->Deallocate(buckets_);
+      buckets_ = NULL;
+    }
+    bucket_count_ = 0;
+    bucket_shift_ = 64;
+  }
+};
+
+#endif  // LIBPAL_PAL_IHASH_MAP_H__
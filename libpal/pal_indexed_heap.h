@@ -0,0 +1,264 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#ifndef LIBPAL_PAL_INDEXED_HEAP_H__
+#define LIBPAL_PAL_INDEXED_HEAP_H__
+
+#include "libpal/pal_debug.h"
+#include "libpal/pal_array.h"
+#include "libpal/pal_algorithms.h"
+
+typedef int palIndexedHeapHandle;
+#define kPalIndexedHeapInvalidHandle (-1)
+
+/* A d-ary min heap whose elements can be found again after insertion.
+ *
+ * Insert returns a handle that stays valid until the element is removed,
+ * no matter how the element moves around inside the heap. With a handle
+ * an element's key can be changed (DecreaseKey, IncreaseKey, Update) or
+ * the element removed, all in O(log n).
+ *
+ * The heap array stores the element next to its handle, so sifting only
+ * touches the heap array and the handle -> position table. With Arity 4
+ * all children of a node sit in one or two cache lines and the tree is half
+ * as deep as a binary heap.
+ *
+ * Handles of removed elements are recycled.
+ */
+template <typename T, typename CompareFuncLessThan = palCompareFuncLessThan<T>, int Arity = 4>
+class palIndexedHeap
+{
+public:
+  /* Types and constants */
+  typedef palIndexedHeap<T, CompareFuncLessThan, Arity> this_type;
+  typedef T element_type;
+  static const int arity = Arity;
+protected:
+  struct Entry {
+    T value;
+    palIndexedHeapHandle handle;
+  };
+
+  palArray<Entry> heap_;
+  /* position of each handle in heap_. Free handles hold -(next_free + 2) */
+  palArray<int> positions_;
+  int free_handle_;
+  CompareFuncLessThan LessThan_;
+
+  static int EncodeFree(int next_free) {
+    return -(next_free + 2);
+  }
+
+  static int DecodeFree(int encoded) {
+    return -encoded - 2;
+  }
+
+  void Place(int position, const Entry& entry) {
+    heap_[position] = entry;
+    positions_[entry.handle] = position;
+  }
+
+  /* Move the entry at position toward the root, returns its final position */
+  int SiftUp(int position) {
+    Entry entry = heap_[position];
+    while (position > 0) {
+      int parent = (position - 1) / Arity;
+      if (!LessThan_(entry.value, heap_[parent].value)) {
+        break;
+      }
+      Place(position, heap_[parent]);
+      position = parent;
+    }
+    Place(position, entry);
+    return position;
+  }
+
+  /* Move the entry at position toward the leaves, returns its final position */
+  int SiftDown(int position) {
+    const int size = heap_.GetSize();
+    Entry entry = heap_[position];
+    while (true) {
+      int first_child = position * Arity + 1;
+      if (first_child >= size) {
+        break;
+      }
+      int last_child = palMin(first_child + Arity, size);
+      int smallest = first_child;
+      for (int child = first_child + 1; child < last_child; child++) {
+        if (LessThan_(heap_[child].value, heap_[smallest].value)) {
+          smallest = child;
+        }
+      }
+      if (!LessThan_(heap_[smallest].value, entry.value)) {
+        break;
+      }
+      Place(position, heap_[smallest]);
+      position = smallest;
+    }
+    Place(position, entry);
+    return position;
+  }
+
+  palIndexedHeapHandle AllocateHandle() {
+    if (free_handle_ != kPalIndexedHeapInvalidHandle) {
+      palIndexedHeapHandle handle = free_handle_;
+      free_handle_ = DecodeFree(positions_[handle]);
+      return handle;
+    }
+    return positions_.push_back(0);
+  }
+
+  void FreeHandle(palIndexedHeapHandle handle) {
+    positions_[handle] = EncodeFree(free_handle_);
+    free_handle_ = handle;
+  }
+
+  void RemoveAtPosition(int position) {
+    palIndexedHeapHandle handle = heap_[position].handle;
+    int last = heap_.GetSize() - 1;
+    if (position != last) {
+      Place(position, heap_[last]);
+      heap_.pop_back();
+      // the moved entry may belong above or below its new spot
+      if (SiftUp(position) == position) {
+        SiftDown(position);
+      }
+    } else {
+      heap_.pop_back();
+    }
+    FreeHandle(handle);
+  }
+public:
+  palIndexedHeap() : heap_(), positions_(), free_handle_(kPalIndexedHeapInvalidHandle), LessThan_(CompareFuncLessThan()) {
+  }
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    heap_.SetAllocator(allocator);
+    positions_.SetAllocator(allocator);
+  }
+
+  palAllocatorInterface* GetAllocator() const {
+    return heap_.GetAllocator();
+  }
+
+  void Reserve(int capacity) {
+    heap_.Reserve(capacity);
+    positions_.Reserve(capacity);
+  }
+
+  palIndexedHeapHandle Insert(const T& element) {
+    palIndexedHeapHandle handle = AllocateHandle();
+    Entry entry;
+    entry.value = element;
+    entry.handle = handle;
+    int position = heap_.push_back(entry);
+    positions_[handle] = position;
+    SiftUp(position);
+    return handle;
+  }
+
+  T& FindMin() {
+    return heap_[0].value;
+  }
+
+  const T& FindMin() const {
+    return heap_[0].value;
+  }
+
+  palIndexedHeapHandle FindMinHandle() const {
+    return heap_[0].handle;
+  }
+
+  void DeleteMin() {
+    palAssert(!IsEmpty());
+    RemoveAtPosition(0);
+  }
+
+  bool IsValidHandle(palIndexedHeapHandle handle) const {
+    return handle >= 0 && handle < positions_.GetSize() && positions_[handle] >= 0;
+  }
+
+  const T& Get(palIndexedHeapHandle handle) const {
+    palAssert(IsValidHandle(handle));
+    return heap_[positions_[handle]].value;
+  }
+
+  /* element must not be greater than the current value */
+  void DecreaseKey(palIndexedHeapHandle handle, const T& element) {
+    palAssert(IsValidHandle(handle));
+    int position = positions_[handle];
+    palAssert(!LessThan_(heap_[position].value, element));
+    heap_[position].value = element;
+    SiftUp(position);
+  }
+
+  /* element must not be less than the current value */
+  void IncreaseKey(palIndexedHeapHandle handle, const T& element) {
+    palAssert(IsValidHandle(handle));
+    int position = positions_[handle];
+    palAssert(!LessThan_(element, heap_[position].value));
+    heap_[position].value = element;
+    SiftDown(position);
+  }
+
+  /* element may move in either direction */
+  void Update(palIndexedHeapHandle handle, const T& element) {
+    palAssert(IsValidHandle(handle));
+    int position = positions_[handle];
+    bool decrease = LessThan_(element, heap_[position].value);
+    heap_[position].value = element;
+    if (decrease) {
+      SiftUp(position);
+    } else {
+      SiftDown(position);
+    }
+  }
+
+  void Remove(palIndexedHeapHandle handle) {
+    palAssert(IsValidHandle(handle));
+    RemoveAtPosition(positions_[handle]);
+  }
+
+  int GetSize() const {
+    return heap_.GetSize();
+  }
+
+  bool IsEmpty() const {
+    return heap_.IsEmpty();
+  }
+
+  /* Invalidates all handles */
+  void Clear() {
+    heap_.Clear();
+    positions_.Clear();
+    free_handle_ = kPalIndexedHeapInvalidHandle;
+  }
+
+  void Reset() {
+    heap_.Reset();
+    positions_.Reset();
+    free_handle_ = kPalIndexedHeapInvalidHandle;
+  }
+};
+
+#endif  // LIBPAL_PAL_INDEXED_HEAP_H__
@@ -23,6 +23,7 @@
 
 #include "libpal/pal_array.h"
 #include "libpal/pal_string.h"
+#include "libpal/pal_number_parse.h"
 #include "libpal/pal_json.h"
 
 const char* json_token_type_strings[NUM_palJSONTokenType] = {
@@ -66,16 +67,32 @@ palJSONTokenType palJSONToken::GetTypeOfValue() const {
   return kJSONTokenTypeParseError;
 }
 
-bool palJSONToken::NameMatch(const char* name) const {
-  return false;
+bool palJSONToken::NameMatch(const palStringView& name) const {
+  if (name_first_index == -1) {
+    return false;
+  }
+  return GetNameView() == name;
 }
 
 float palJSONToken::GetAsFloat() const {
-  return (float)atof(JSON_str+value_first_index);
+  return (float)GetAsDouble();
+}
+
+double palJSONToken::GetAsDouble() const {
+  double value = 0.0;
+  palParseDouble(JSON_str+value_first_index, value_length, &value);
+  return value;
 }
 
 int palJSONToken::GetAsInt() const {
-  return atoi(JSON_str+value_first_index);
+  return (int)GetAsInt64();
+}
+
+int64_t palJSONToken::GetAsInt64() const {
+  // stops at a fraction or exponent, 1.9 reads as 1
+  int64_t value = 0;
+  palParseInt64(JSON_str+value_first_index, value_length, &value);
+  return value;
 }
 
 bool palJSONToken::GetAsBool() const {
@@ -87,13 +104,19 @@ void* palJSONToken::GetAsPointer() const {
 }
 
 void palJSONToken::GetAsString(palDynamicString* str) const {
-  str->Set("");
-  str->Append(JSON_str+value_first_index+1, value_length-2);
+  GetAsStringView().CopyTo(str);
+}
+
+palStringView palJSONToken::GetAsStringView() const {
+  return palStringView(JSON_str+value_first_index+1, value_length-2);
 }
 
 void palJSONToken::GetName(palDynamicString* name) const {
-  name->Set("");
-  name->Append(JSON_str+name_first_index+1, name_length-2);
+  GetNameView().CopyTo(name);
+}
+
+palStringView palJSONToken::GetNameView() const {
+  return palStringView(JSON_str+name_first_index+1, name_length-2);
 }
 
 void palJSONToken::DebugPrintf() const {
@@ -148,13 +171,12 @@ void palJSONToken::DebugPrintf() const {
   }
 }
 
-palJSONToken* palJSONFindTokenWithName(palJSONToken* token_buffer, int token_buffer_length, const char* name) {
+palJSONToken* palJSONFindTokenWithName(palJSONToken* token_buffer, int token_buffer_length, const palStringView& name) {
   for (int i = 0; i < token_buffer_length; i++) {
     if (token_buffer[i].name_first_index == -1) {
       break;
     }
-    const char* name_string = token_buffer[i].JSON_str+(token_buffer[i].name_first_index+1);
-    if (palStringEqualsN(name, name_string, (token_buffer[i].name_length-2))) {
+    if (token_buffer[i].GetNameView() == name) {
       return &token_buffer[i];
     }
   }
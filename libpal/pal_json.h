@@ -26,6 +26,7 @@
 #include "libpal/pal_mem_blob.h"
 #include "libpal/pal_memory_stream.h"
 #include "libpal/pal_tokenizer.h"
+#include "libpal/pal_string_view.h"
 
 enum palJSONTokenType {
   kJSONTokenTypeParseError = 0,
@@ -61,20 +62,25 @@ struct palJSONToken {
 
   palJSONTokenType GetTypeOfValue() const;
 
-  bool NameMatch(const char* name) const;
+  bool NameMatch(const palStringView& name) const;
 
   float GetAsFloat() const;
+  double GetAsDouble() const;
   int GetAsInt() const;
+  int64_t GetAsInt64() const;
   bool GetAsBool() const;
   void* GetAsPointer() const;
   void GetAsString(palDynamicString* str) const;
+  /* The characters between the quotes, without copying */
+  palStringView GetAsStringView() const;
 
   void GetName(palDynamicString* name) const;
+  palStringView GetNameView() const;
 
   void DebugPrintf() const;
 };
 
-palJSONToken* palJSONFindTokenWithName(palJSONToken* token_buffer, int token_buffer_length, const char* name);
+palJSONToken* palJSONFindTokenWithName(palJSONToken* token_buffer, int token_buffer_length, const palStringView& name);
 
 class palJSONParser {
   const char* JSON_str_;
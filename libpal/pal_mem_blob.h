@@ -165,7 +165,7 @@ public:
   }
 
   void Reset(bool deallocate_buffer = true) {
-    if (allocator_ != NULL && buffer != NULL && deallocate_buffer == false) {
+    if (allocator_ != NULL && buffer != NULL && deallocate_buffer) {
       allocator_->Deallocate(buffer);
     }
     buffer = NULL;
@@ -237,9 +237,9 @@ class palRingBlob {
   }
 
   void* MakeWritePointer() {
-    uint64_t offset = _buffer_size % _buffer_capacity;
-    uintptr_t start = reinterpret_cast<uintptr_t>(_read_pointer);
-    return reinterpret_cast<void*>(start+offset);
+    uint64_t read_offset = _read_pointer - reinterpret_cast<uint8_t*>(_buffer);
+    uint64_t offset = (read_offset + _buffer_size) % _buffer_capacity;
+    return reinterpret_cast<uint8_t*>(_buffer) + offset;
   }
 
   void MoveReadPointer(uint64_t bytes) {
@@ -300,7 +300,7 @@ public:
   }
 
   int Append(const void* data, uint64_t data_size) {
-    if (_buffer_size + data_size >= _buffer_capacity) {
+    if (_buffer_size + data_size > _buffer_capacity) {
       return PAL_MEM_BLOB_NO_ROOM;
     }
     Write(data, data_size);
@@ -467,7 +467,7 @@ public:
   }
 
   int Append(const void* data, uint64_t data_size) {
-    if (_buffer_size + data_size >= _buffer_capacity) {
+    if (_buffer_size + data_size > _buffer_capacity) {
       return PAL_MEM_BLOB_NO_ROOM;
     }
     palMemoryCopyBytes(reinterpret_cast<void*>(_buffer+_buffer_size), data, data_size);
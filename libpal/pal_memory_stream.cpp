@@ -163,6 +163,15 @@ int palMemoryStream::Write(const void* buffer, uint64_t buffer_offset, uint64_t
   uintptr_t bp = (uintptr_t)buffer;
   bp += (uintptr_t)buffer_offset;
   if (_growable) {
+    uint64_t end = _position + count_bytes;
+    if (end > _growing_blob.GetBufferSize()) {
+      // grow geometrically so a run of small writes stays linear
+      uint64_t capacity = _growing_blob.GetBufferCapacity();
+      if (end > capacity) {
+        _growing_blob.IncreaseCapacity(end > 2 * capacity ? end : 2 * capacity);
+      }
+      _growing_blob.SetSize(end);
+    }
     palMemoryCopyBytes(_growing_blob.GetPtr(_position), (void*)bp, count_bytes);
     *bytes_written = count_bytes;
   } else {
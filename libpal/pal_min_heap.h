@@ -60,7 +60,7 @@ protected:
 
 	void HeapUp (int node) {
 		while (node > 0) {
-      int parent = node / 2;
+      int parent = (node - 1) / 2;
       if (LessThan_(array_[node],array_[parent]))
       {
         array_.Swap(node, parent);
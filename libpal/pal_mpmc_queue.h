@@ -0,0 +1,239 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include <new>
+#include "libpal/pal_debug.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_atomic.h"
+#include "libpal/pal_thread.h"
+#include "libpal/pal_allocator_interface.h"
+
+#define kPalMpmcQueueCacheLineSize 64
+
+/*
+  Bounded queue shared by any number of producer and consumer threads
+  without a lock.
+
+  Every slot carries a sequence number. A slot is free for the producer
+  claiming position p when its sequence is p, and holds a value for the
+  consumer claiming position p when its sequence is p + 1. Producers and
+  consumers claim positions with a compare and swap on their own counter
+  (each on its own cache line), copy the value and then publish the slot by
+  advancing its sequence, so the only shared writes are one counter and
+  one slot per operation and nothing is allocated after Create.
+
+  TryPush fails when the queue is full and TryPop when it is empty. Push
+  and Pop block on a palSemaphore instead. A blocked thread registers as a
+  waiter before checking the queue one last time, and every successful
+  TryPush (TryPop) wakes one registered consumer (producer), so the
+  semaphores are only touched while somebody is waiting.
+
+  The capacity is a power of two. T is copied with operator= into slots
+  that are constructed once in Create.
+*/
+template <typename T>
+class palMpmcQueue {
+protected:
+  struct Slot {
+    palAtomicInt64 sequence;
+    T value;
+  };
+
+  palAllocatorInterface* allocator_;
+  Slot* slots_;
+  int64_t mask_;
+
+  unsigned char producer_pad_[kPalMpmcQueueCacheLineSize];
+  palAtomicInt64 push_position_;
+  unsigned char consumer_pad_[kPalMpmcQueueCacheLineSize];
+  palAtomicInt64 pop_position_;
+  unsigned char waiter_pad_[kPalMpmcQueueCacheLineSize];
+
+  palAtomicInt32 push_waiters_;
+  palAtomicInt32 pop_waiters_;
+  palSemaphore push_semaphore_;
+  palSemaphore pop_semaphore_;
+
+  /* Wakes one thread blocked on semaphore, if any */
+  static void WakeOne(volatile palAtomicInt32& waiters, palSemaphore& semaphore) {
+    int32_t count = waiters.Load();
+    while (count > 0) {
+      if (waiters.CompareExchange(count, count - 1)) {
+        semaphore.Release();
+        return;
+      }
+    }
+  }
+
+  /* Undoes a registration that turned out not to need sleeping */
+  static void CancelWait(volatile palAtomicInt32& waiters, palSemaphore& semaphore) {
+    int32_t count = waiters.Load();
+    while (count > 0) {
+      if (waiters.CompareExchange(count, count - 1)) {
+        return;
+      }
+    }
+    // a wake already claimed this registration, take its release
+    semaphore.Acquire();
+  }
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palMpmcQueue);
+public:
+  palMpmcQueue() : allocator_(NULL), slots_(NULL), mask_(-1), push_position_(0), pop_position_(0), push_waiters_(0), pop_waiters_(0) {
+  }
+
+  ~palMpmcQueue() {
+    Destroy();
+  }
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    allocator_ = allocator;
+  }
+
+  /* capacity is rounded up to a power of two */
+  int Create(uint32_t capacity) {
+    palAssert(allocator_ != NULL);
+    palAssert(slots_ == NULL);
+    int64_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    slots_ = static_cast<Slot*>(allocator_->Allocate((uint64_t)size * sizeof(Slot), kPalMpmcQueueCacheLineSize));
+    for (int64_t i = 0; i < size; i++) {
+      new (&slots_[i]) Slot();
+      slots_[i].sequence.Store(i);
+    }
+    mask_ = size - 1;
+    push_position_.Store(0);
+    pop_position_.Store(0);
+    push_waiters_.Store(0);
+    pop_waiters_.Store(0);
+    palSemaphoreDescription semaphore_desc;
+    semaphore_desc.name = NULL;
+    semaphore_desc.initial_reservation = 0;
+    semaphore_desc.maximum = 0x7fffffff;
+    push_semaphore_.Create(semaphore_desc);
+    pop_semaphore_.Create(semaphore_desc);
+    return 0;
+  }
+
+  /* No thread may be using the queue */
+  void Destroy() {
+    if (slots_ == NULL) {
+      return;
+    }
+    for (int64_t i = 0; i <= mask_; i++) {
+      slots_[i].~Slot();
+    }
+    allocator_->Deallocate(slots_);
+    slots_ = NULL;
+    mask_ = -1;
+    push_semaphore_.Destroy();
+    pop_semaphore_.Destroy();
+  }
+
+  uint32_t GetCapacity() const {
+    return (uint32_t)(mask_ + 1);
+  }
+
+  /* Only a snapshot while other threads are pushing or popping */
+  uint32_t GetSize() const {
+    int64_t size = push_position_.Load() - pop_position_.Load();
+    return size < 0 ? 0 : (uint32_t)size;
+  }
+
+  /* Returns false if the queue is full */
+  bool TryPush(const T& value) {
+    int64_t position = push_position_.Load();
+    Slot* slot;
+    for (;;) {
+      slot = &slots_[position & mask_];
+      int64_t difference = slot->sequence.Load() - position;
+      if (difference == 0) {
+        if (push_position_.CompareExchange(position, position + 1)) {
+          break;
+        }
+      } else if (difference < 0) {
+        // the slot still holds the value pushed one lap ago
+        return false;
+      } else {
+        position = push_position_.Load();
+      }
+    }
+    slot->value = value;
+    // Store is a full barrier, the pop waiter count is read after it
+    slot->sequence.Store(position + 1);
+    WakeOne(pop_waiters_, pop_semaphore_);
+    return true;
+  }
+
+  /* Returns false if the queue is empty */
+  bool TryPop(T* value) {
+    int64_t position = pop_position_.Load();
+    Slot* slot;
+    for (;;) {
+      slot = &slots_[position & mask_];
+      int64_t difference = slot->sequence.Load() - (position + 1);
+      if (difference == 0) {
+        if (pop_position_.CompareExchange(position, position + 1)) {
+          break;
+        }
+      } else if (difference < 0) {
+        // nothing has been pushed at this position yet
+        return false;
+      } else {
+        position = pop_position_.Load();
+      }
+    }
+    *value = slot->value;
+    slot->sequence.Store(position + mask_ + 1);
+    WakeOne(push_waiters_, push_semaphore_);
+    return true;
+  }
+
+  /* Blocks while the queue is full */
+  void Push(const T& value) {
+    while (!TryPush(value)) {
+      push_waiters_.FetchAdd(1);
+      if (TryPush(value)) {
+        CancelWait(push_waiters_, push_semaphore_);
+        return;
+      }
+      push_semaphore_.Acquire();
+    }
+  }
+
+  /* Blocks while the queue is empty */
+  void Pop(T* value) {
+    while (!TryPop(value)) {
+      pop_waiters_.FetchAdd(1);
+      if (TryPop(value)) {
+        CancelWait(pop_waiters_, pop_semaphore_);
+        return;
+      }
+      pop_semaphore_.Acquire();
+    }
+  }
+};
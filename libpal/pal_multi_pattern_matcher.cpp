@@ -0,0 +1,202 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#include "libpal/pal_string.h"
+#include "libpal/pal_multi_pattern_matcher.h"
+
+palMultiPatternMatcher::palMultiPatternMatcher() : allocator_(NULL), built_(false), num_classes_(0) {
+  palMemoryZeroBytes(byte_class_, sizeof(byte_class_));
+}
+
+void palMultiPatternMatcher::SetAllocator(palAllocatorInterface* allocator) {
+  allocator_ = allocator;
+  pattern_chars_.SetAllocator(allocator);
+  pattern_offsets_.SetAllocator(allocator);
+  pattern_lengths_.SetAllocator(allocator);
+  pattern_next_same_.SetAllocator(allocator);
+  transitions_.SetAllocator(allocator);
+  state_pattern_.SetAllocator(allocator);
+  state_output_.SetAllocator(allocator);
+  output_link_.SetAllocator(allocator);
+}
+
+int palMultiPatternMatcher::AddPattern(const char* pattern, int length) {
+  palAssert(!built_);
+  palAssert(length > 0);
+  int index = pattern_lengths_.GetSize();
+  pattern_offsets_.push_back(pattern_chars_.GetSize());
+  pattern_lengths_.push_back(length);
+  pattern_next_same_.push_back(-1);
+  for (int i = 0; i < length; i++) {
+    pattern_chars_.push_back(pattern[i]);
+  }
+  return index;
+}
+
+int palMultiPatternMatcher::AddPattern(const char* pattern) {
+  return AddPattern(pattern, palStringLength(pattern));
+}
+
+int palMultiPatternMatcher::AddState() {
+  int state = state_pattern_.GetSize();
+  state_pattern_.push_back(-1);
+  state_output_.push_back(-1);
+  output_link_.push_back(-1);
+  transitions_.Resize(transitions_.GetSize() + num_classes_, -1);
+  return state;
+}
+
+void palMultiPatternMatcher::Build() {
+  palAssert(!built_);
+  const int num_patterns = GetNumPatterns();
+
+  // input classes, 0 is every byte that is in no pattern. When the patterns
+  // use all 256 byte values no byte is left for it and every byte gets its own.
+  bool used[256];
+  palMemoryZeroBytes(used, sizeof(used));
+  int num_used = 0;
+  for (int i = 0; i < pattern_chars_.GetSize(); i++) {
+    unsigned char ch = (unsigned char)pattern_chars_[i];
+    if (!used[ch]) {
+      used[ch] = true;
+      num_used++;
+    }
+  }
+  num_classes_ = num_used < 256 ? 1 : 0;
+  for (int ch = 0; ch < 256; ch++) {
+    byte_class_[ch] = used[ch] ? (uint8_t)num_classes_++ : 0;
+  }
+  palAssert(num_classes_ <= 256);
+
+  // trie of the patterns
+  AddState();
+  for (int p = 0; p < num_patterns; p++) {
+    const char* chars = &pattern_chars_[pattern_offsets_[p]];
+    int state = 0;
+    for (int i = 0; i < pattern_lengths_[p]; i++) {
+      int slot = state * num_classes_ + byte_class_[(unsigned char)chars[i]];
+      if (transitions_[slot] < 0) {
+        int next = AddState();
+        transitions_[slot] = next;
+      }
+      state = transitions_[slot];
+    }
+    if (state_pattern_[state] < 0) {
+      state_pattern_[state] = p;
+    } else {
+      // same characters as an earlier pattern, append to its list
+      int last = state_pattern_[state];
+      while (pattern_next_same_[last] >= 0) {
+        last = pattern_next_same_[last];
+      }
+      pattern_next_same_[last] = p;
+    }
+  }
+
+  // breadth first, a state's failure state is shallower and already complete
+  const int num_states = GetNumStates();
+  palArray<int> fail;
+  palArray<int> queue;
+  fail.SetAllocator(allocator_);
+  queue.SetAllocator(allocator_);
+  fail.Resize(num_states, 0);
+  queue.Reserve(num_states);
+  for (int c = 0; c < num_classes_; c++) {
+    int next = transitions_[c];
+    if (next < 0) {
+      transitions_[c] = 0;
+    } else {
+      fail[next] = 0;
+      queue.push_back(next);
+    }
+  }
+  for (int head = 0; head < queue.GetSize(); head++) {
+    int state = queue[head];
+    int* row = &transitions_[state * num_classes_];
+    const int* fail_row = &transitions_[fail[state] * num_classes_];
+    for (int c = 0; c < num_classes_; c++) {
+      int next = row[c];
+      if (next < 0) {
+        row[c] = fail_row[c];
+        continue;
+      }
+      int next_fail = fail_row[c];
+      fail[next] = next_fail;
+      output_link_[next] = state_pattern_[next_fail] >= 0 ? next_fail : output_link_[next_fail];
+      queue.push_back(next);
+    }
+  }
+  for (int s = 0; s < num_states; s++) {
+    state_output_[s] = state_pattern_[s] >= 0 ? s : output_link_[s];
+  }
+  // premultiplied rows save the multiply in Scan, the sign saves a lookup per byte
+  for (int i = 0; i < transitions_.GetSize(); i++) {
+    int next = transitions_[i];
+    int offset = next * num_classes_;
+    transitions_[i] = state_output_[next] >= 0 ? -offset - 1 : offset;
+  }
+  built_ = true;
+}
+
+void palMultiPatternMatcher::Reset() {
+  pattern_chars_.Reset();
+  pattern_offsets_.Reset();
+  pattern_lengths_.Reset();
+  pattern_next_same_.Reset();
+  transitions_.Reset();
+  state_pattern_.Reset();
+  state_output_.Reset();
+  output_link_.Reset();
+  num_classes_ = 0;
+  built_ = false;
+}
+
+struct palMultiPatternMatcherFirst {
+  int pattern;
+  int start;
+  palMultiPatternMatcherFirst() : pattern(-1), start(-1) {
+  }
+  bool operator()(int p, int s) {
+    pattern = p;
+    start = s;
+    return false;
+  }
+};
+
+bool palMultiPatternMatcher::FindFirst(const char* buffer, int length, int* pattern, int* start) const {
+  palMultiPatternMatcherFirst first;
+  if (Scan(buffer, length, first) == 0) {
+    return false;
+  }
+  if (pattern) {
+    *pattern = first.pattern;
+  }
+  if (start) {
+    *start = first.start;
+  }
+  return true;
+}
+
+bool palMultiPatternMatcher::Contains(const char* buffer, int length) const {
+  return FindFirst(buffer, length, NULL, NULL);
+}
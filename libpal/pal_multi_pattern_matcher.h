@@ -0,0 +1,160 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_debug.h"
+#include "libpal/pal_array.h"
+#include "libpal/pal_allocator_interface.h"
+
+/*
+  Finds every occurrence of any of a set of patterns in one pass over a
+  buffer (Aho-Corasick).
+
+  Patterns are added, then Build turns them into a DFA: one transition per
+  state and input byte, so scanning is a table load per byte no matter how
+  many patterns there are. Bytes that appear in no pattern share one input
+  class, which keeps the table at states * (distinct pattern bytes + 1)
+  entries.
+
+  Matches are reported in the order they end. Overlapping matches and
+  matches of patterns that are suffixes of others are all reported.
+
+  Usage:
+
+    palMultiPatternMatcher matcher;
+    matcher.SetAllocator(g_DefaultHeapAllocator);
+    matcher.AddPattern("ERROR");
+    matcher.AddPattern("WARN");
+    matcher.Build();
+
+    struct Printer {
+      bool operator()(int pattern, int start) {
+        palPrintf("pattern %d at %d\n", pattern, start);
+        return true;  // keep going
+      }
+    } printer;
+    matcher.Scan(log, log_length, printer);
+*/
+class palMultiPatternMatcher {
+protected:
+  palAllocatorInterface* allocator_;
+  bool built_;
+
+  // patterns, back to back
+  palArray<char> pattern_chars_;
+  palArray<int> pattern_offsets_;
+  palArray<int> pattern_lengths_;
+  // next pattern with the same characters, or -1
+  palArray<int> pattern_next_same_;
+
+  uint8_t byte_class_[256];
+  int num_classes_;
+
+  // num_states * num_classes_ next states, stored as the next state's row
+  // offset, or as -(offset + 1) when a pattern ends in the next state
+  palArray<int32_t> transitions_;
+  // first pattern ending at a state, or -1
+  palArray<int> state_pattern_;
+  // first state with a pattern on the state's failure chain, the state itself included, or -1
+  palArray<int> state_output_;
+  // next state with a pattern on the failure chain, excluding the state, or -1
+  palArray<int> output_link_;
+
+  int AddState();
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palMultiPatternMatcher);
+public:
+  palMultiPatternMatcher();
+
+  void SetAllocator(palAllocatorInterface* allocator);
+
+  /* Returns the pattern's index. Patterns must not be empty and can't be added after Build. */
+  int AddPattern(const char* pattern, int length);
+  int AddPattern(const char* pattern);
+
+  /* Builds the automaton, must be called before scanning */
+  void Build();
+
+  /* Drops patterns and automaton */
+  void Reset();
+
+  int GetNumPatterns() const {
+    return pattern_lengths_.GetSize();
+  }
+
+  int GetPatternLength(int pattern) const {
+    return pattern_lengths_[pattern];
+  }
+
+  int GetNumStates() const {
+    return state_pattern_.GetSize();
+  }
+
+  /* Calls callback(pattern, start) for each match, in the order matches
+     end, until it returns false. Returns the number of matches reported.
+
+     To scan a stream in pieces, pass the same state (start with 0) to each
+     call. Matches that began in an earlier piece are reported with a
+     negative start. */
+  template <typename Callback>
+  int Scan(const char* buffer, int length, Callback& callback, int* stream_state = NULL) const {
+    palAssert(built_);
+    const int32_t* transitions = transitions_.GetConstPtr();
+    const int num_classes = num_classes_;
+    int row = (stream_state ? *stream_state : 0) * num_classes;
+    int matches = 0;
+    for (int i = 0; i < length; i++) {
+      int32_t next = transitions[row + byte_class_[(unsigned char)buffer[i]]];
+      if (next >= 0) {
+        row = next;
+        continue;
+      }
+      row = -next - 1;
+      for (int s = state_output_[row / num_classes]; s >= 0; s = output_link_[s]) {
+        for (int p = state_pattern_[s]; p >= 0; p = pattern_next_same_[p]) {
+          matches++;
+          if (!callback(p, i + 1 - pattern_lengths_[p])) {
+            if (stream_state) {
+              *stream_state = row / num_classes;
+            }
+            return matches;
+          }
+        }
+      }
+    }
+    if (stream_state) {
+      *stream_state = row / num_classes;
+    }
+    return matches;
+  }
+
+  /* The match that ends first (the longest of those ending at the same byte).
+     Returns false if no pattern occurs. */
+  bool FindFirst(const char* buffer, int length, int* pattern, int* start) const;
+
+  /* True if any pattern occurs */
+  bool Contains(const char* buffer, int length) const;
+};
@@ -0,0 +1,358 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#include <string.h>
+#include "libpal/pal_number_format.h"
+
+static const char kPalFormatDigitPairs[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static int palFormatCountDigits(uint64_t value) {
+  int digits = 1;
+  for (;;) {
+    if (value < 10) return digits;
+    if (value < 100) return digits + 1;
+    if (value < 1000) return digits + 2;
+    if (value < 10000) return digits + 3;
+    value /= 10000;
+    digits += 4;
+  }
+}
+
+/* Writes the digits of value backwards, ending just before end */
+static void palFormatDigitsBackwards(char* end, uint64_t value) {
+  // 64 bit division is a library call on 32 bit targets, leave it early
+  while (value > 0xffffffffULL) {
+    uint64_t quotient = value / 100;
+    int pair = (int)(value - quotient * 100) * 2;
+    end -= 2;
+    end[0] = kPalFormatDigitPairs[pair];
+    end[1] = kPalFormatDigitPairs[pair + 1];
+    value = quotient;
+  }
+  uint32_t small = (uint32_t)value;
+  while (small >= 100) {
+    uint32_t quotient = small / 100;
+    int pair = (int)(small - quotient * 100) * 2;
+    end -= 2;
+    end[0] = kPalFormatDigitPairs[pair];
+    end[1] = kPalFormatDigitPairs[pair + 1];
+    small = quotient;
+  }
+  if (small >= 10) {
+    end[-2] = kPalFormatDigitPairs[small * 2];
+    end[-1] = kPalFormatDigitPairs[small * 2 + 1];
+  } else {
+    end[-1] = (char)('0' + small);
+  }
+}
+
+int palFormatUint(char* buffer, uint64_t value) {
+  int length = palFormatCountDigits(value);
+  palFormatDigitsBackwards(buffer + length, value);
+  buffer[length] = '\0';
+  return length;
+}
+
+int palFormatInt(char* buffer, int64_t value) {
+  if (value < 0) {
+    buffer[0] = '-';
+    // negating in unsigned keeps INT64_MIN intact
+    return 1 + palFormatUint(buffer + 1, 0 - (uint64_t)value);
+  }
+  return palFormatUint(buffer, (uint64_t)value);
+}
+
+/* Grisu2, from Florian Loitsch, "Printing Floating-Point Numbers Quickly
+   and Accurately with Integers". A value is f * 2^e with a 64 bit f. */
+struct palFormatDiyFp {
+  uint64_t f;
+  int e;
+};
+
+static palFormatDiyFp palFormatDiyFpMake(uint64_t f, int e) {
+  palFormatDiyFp r;
+  r.f = f;
+  r.e = e;
+  return r;
+}
+
+/* Upper 64 bits of the 128 bit product, rounded */
+static palFormatDiyFp palFormatDiyFpMultiply(palFormatDiyFp x, palFormatDiyFp y) {
+  const uint64_t kLow = 0xffffffffULL;
+  uint64_t a = x.f >> 32;
+  uint64_t b = x.f & kLow;
+  uint64_t c = y.f >> 32;
+  uint64_t d = y.f & kLow;
+  uint64_t ac = a * c;
+  uint64_t bc = b * c;
+  uint64_t ad = a * d;
+  uint64_t bd = b * d;
+  uint64_t middle = (bd >> 32) + (ad & kLow) + (bc & kLow) + (1ULL << 31);
+  return palFormatDiyFpMake(ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64);
+}
+
+static palFormatDiyFp palFormatDiyFpNormalize(palFormatDiyFp x) {
+  if ((x.f >> 32) == 0) { x.f <<= 32; x.e -= 32; }
+  if ((x.f >> 48) == 0) { x.f <<= 16; x.e -= 16; }
+  if ((x.f >> 56) == 0) { x.f <<= 8; x.e -= 8; }
+  if ((x.f >> 60) == 0) { x.f <<= 4; x.e -= 4; }
+  if ((x.f >> 62) == 0) { x.f <<= 2; x.e -= 2; }
+  if ((x.f >> 63) == 0) { x.f <<= 1; x.e -= 1; }
+  return x;
+}
+
+/* Normalized 10^k for k = -348, -340, ..., 340 */
+static const palFormatDiyFp kPalFormatCachedPowers[87] = {
+  { 0xfa8fd5a0081c0288ULL, -1220 }, { 0xbaaee17fa23ebf76ULL, -1193 }, { 0x8b16fb203055ac76ULL, -1166 },
+  { 0xcf42894a5dce35eaULL, -1140 }, { 0x9a6bb0aa55653b2dULL, -1113 }, { 0xe61acf033d1a45dfULL, -1087 },
+  { 0xab70fe17c79ac6caULL, -1060 }, { 0xff77b1fcbebcdc4fULL, -1034 }, { 0xbe5691ef416bd60cULL, -1007 },
+  { 0x8dd01fad907ffc3cULL, -980 }, { 0xd3515c2831559a83ULL, -954 }, { 0x9d71ac8fada6c9b5ULL, -927 },
+  { 0xea9c227723ee8bcbULL, -901 }, { 0xaecc49914078536dULL, -874 }, { 0x823c12795db6ce57ULL, -847 },
+  { 0xc21094364dfb5637ULL, -821 }, { 0x9096ea6f3848984fULL, -794 }, { 0xd77485cb25823ac7ULL, -768 },
+  { 0xa086cfcd97bf97f4ULL, -741 }, { 0xef340a98172aace5ULL, -715 }, { 0xb23867fb2a35b28eULL, -688 },
+  { 0x84c8d4dfd2c63f3bULL, -661 }, { 0xc5dd44271ad3cdbaULL, -635 }, { 0x936b9fcebb25c996ULL, -608 },
+  { 0xdbac6c247d62a584ULL, -582 }, { 0xa3ab66580d5fdaf6ULL, -555 }, { 0xf3e2f893dec3f126ULL, -529 },
+  { 0xb5b5ada8aaff80b8ULL, -502 }, { 0x87625f056c7c4a8bULL, -475 }, { 0xc9bcff6034c13053ULL, -449 },
+  { 0x964e858c91ba2655ULL, -422 }, { 0xdff9772470297ebdULL, -396 }, { 0xa6dfbd9fb8e5b88fULL, -369 },
+  { 0xf8a95fcf88747d94ULL, -343 }, { 0xb94470938fa89bcfULL, -316 }, { 0x8a08f0f8bf0f156bULL, -289 },
+  { 0xcdb02555653131b6ULL, -263 }, { 0x993fe2c6d07b7facULL, -236 }, { 0xe45c10c42a2b3b06ULL, -210 },
+  { 0xaa242499697392d3ULL, -183 }, { 0xfd87b5f28300ca0eULL, -157 }, { 0xbce5086492111aebULL, -130 },
+  { 0x8cbccc096f5088ccULL, -103 }, { 0xd1b71758e219652cULL, -77 }, { 0x9c40000000000000ULL, -50 },
+  { 0xe8d4a51000000000ULL, -24 }, { 0xad78ebc5ac620000ULL, 3 }, { 0x813f3978f8940984ULL, 30 },
+  { 0xc097ce7bc90715b3ULL, 56 }, { 0x8f7e32ce7bea5c70ULL, 83 }, { 0xd5d238a4abe98068ULL, 109 },
+  { 0x9f4f2726179a2245ULL, 136 }, { 0xed63a231d4c4fb27ULL, 162 }, { 0xb0de65388cc8ada8ULL, 189 },
+  { 0x83c7088e1aab65dbULL, 216 }, { 0xc45d1df942711d9aULL, 242 }, { 0x924d692ca61be758ULL, 269 },
+  { 0xda01ee641a708deaULL, 295 }, { 0xa26da3999aef774aULL, 322 }, { 0xf209787bb47d6b85ULL, 348 },
+  { 0xb454e4a179dd1877ULL, 375 }, { 0x865b86925b9bc5c2ULL, 402 }, { 0xc83553c5c8965d3dULL, 428 },
+  { 0x952ab45cfa97a0b3ULL, 455 }, { 0xde469fbd99a05fe3ULL, 481 }, { 0xa59bc234db398c25ULL, 508 },
+  { 0xf6c69a72a3989f5cULL, 534 }, { 0xb7dcbf5354e9beceULL, 561 }, { 0x88fcf317f22241e2ULL, 588 },
+  { 0xcc20ce9bd35c78a5ULL, 614 }, { 0x98165af37b2153dfULL, 641 }, { 0xe2a0b5dc971f303aULL, 667 },
+  { 0xa8d9d1535ce3b396ULL, 694 }, { 0xfb9b7cd9a4a7443cULL, 720 }, { 0xbb764c4ca7a44410ULL, 747 },
+  { 0x8bab8eefb6409c1aULL, 774 }, { 0xd01fef10a657842cULL, 800 }, { 0x9b10a4e5e9913129ULL, 827 },
+  { 0xe7109bfba19c0c9dULL, 853 }, { 0xac2820d9623bf429ULL, 880 }, { 0x80444b5e7aa7cf85ULL, 907 },
+  { 0xbf21e44003acdd2dULL, 933 }, { 0x8e679c2f5e44ff8fULL, 960 }, { 0xd433179d9c8cb841ULL, 986 },
+  { 0x9e19db92b4e31ba9ULL, 1013 }, { 0xeb96bf6ebadf77d9ULL, 1039 }, { 0xaf87023b9bf0ee6bULL, 1066 }
+};
+
+/* A power c = 10^-k that brings e into [-60, -32] after multiplying */
+static palFormatDiyFp palFormatCachedPower(int e, int* k) {
+  double dk = (-61 - e) * 0.30102999566398114 + 347;
+  int ik = (int)dk;
+  if (dk - ik > 0.0) {
+    ik++;
+  }
+  int index = (ik >> 3) + 1;
+  *k = -(-348 + index * 8);
+  return kPalFormatCachedPowers[index];
+}
+
+static const uint64_t kPalFormatPow10[20] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+  1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+  100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+  1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/* Moves the last digit towards w while the result stays inside the interval */
+static void palFormatGrisuRound(char* buffer, int length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+  while (rest < wp_w && delta - rest >= ten_kappa &&
+         (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+    buffer[length - 1]--;
+    rest += ten_kappa;
+  }
+}
+
+/* Shortest digits for a number in (Mp - delta, Mp), as close to W as possible */
+static int palFormatDigitGen(palFormatDiyFp W, palFormatDiyFp Mp, uint64_t delta, char* buffer, int* k) {
+  const int shift = -Mp.e;
+  const uint64_t one = 1ULL << shift;
+  const uint64_t wp_w = Mp.f - W.f;
+  uint32_t p1 = (uint32_t)(Mp.f >> shift);
+  uint64_t p2 = Mp.f & (one - 1);
+  int kappa = palFormatCountDigits(p1);
+  int length = 0;
+
+  // integral part
+  while (kappa > 0) {
+    uint32_t divisor = (uint32_t)kPalFormatPow10[kappa - 1];
+    uint32_t digit = p1 / divisor;
+    p1 -= digit * divisor;
+    if (digit != 0 || length != 0) {
+      buffer[length++] = (char)('0' + digit);
+    }
+    kappa--;
+    uint64_t rest = ((uint64_t)p1 << shift) + p2;
+    if (rest <= delta) {
+      *k += kappa;
+      palFormatGrisuRound(buffer, length, delta, rest, kPalFormatPow10[kappa] << shift, wp_w);
+      return length;
+    }
+  }
+
+  // fractional part
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    char digit = (char)(p2 >> shift);
+    if (digit != 0 || length != 0) {
+      buffer[length++] = (char)('0' + digit);
+    }
+    p2 &= one - 1;
+    kappa--;
+    if (p2 < delta) {
+      *k += kappa;
+      int index = -kappa;
+      palFormatGrisuRound(buffer, length, delta, p2, one, index < 20 ? wp_w * kPalFormatPow10[index] : 0);
+      return length;
+    }
+  }
+}
+
+/* Lays out digits * 10^k as a plain decimal or in exponent form */
+static int palFormatDecimal(char* buffer, int length, int k) {
+  // position of the decimal point relative to the first digit
+  const int point = length + k;
+  if (k >= 0 && point <= 21) {
+    for (int i = length; i < point; i++) {
+      buffer[i] = '0';
+    }
+    buffer[point] = '\0';
+    return point;
+  }
+  if (point > 0 && point <= 21) {
+    memmove(buffer + point + 1, buffer + point, length - point);
+    buffer[point] = '.';
+    buffer[length + 1] = '\0';
+    return length + 1;
+  }
+  if (point > -6 && point <= 0) {
+    int offset = 2 - point;
+    memmove(buffer + offset, buffer, length);
+    buffer[0] = '0';
+    buffer[1] = '.';
+    for (int i = 2; i < offset; i++) {
+      buffer[i] = '0';
+    }
+    buffer[length + offset] = '\0';
+    return length + offset;
+  }
+  int n = 1;
+  if (length > 1) {
+    memmove(buffer + 2, buffer + 1, length - 1);
+    buffer[1] = '.';
+    n = length + 1;
+  }
+  buffer[n++] = 'e';
+  int exponent = point - 1;
+  if (exponent < 0) {
+    buffer[n++] = '-';
+    exponent = -exponent;
+  } else {
+    buffer[n++] = '+';
+  }
+  return n + palFormatUint(buffer + n, (uint64_t)exponent);
+}
+
+/* f * 2^e, f including the hidden bit. The gap below is half the gap above
+   when f is a power of two that is not the smallest normal. */
+static int palFormatGrisu(char* buffer, uint64_t f, int e, bool lower_gap_smaller) {
+  palFormatDiyFp plus = palFormatDiyFpNormalize(palFormatDiyFpMake((f << 1) + 1, e - 1));
+  palFormatDiyFp minus = lower_gap_smaller ? palFormatDiyFpMake((f << 2) - 1, e - 2) : palFormatDiyFpMake((f << 1) - 1, e - 1);
+  minus.f <<= minus.e - plus.e;
+  minus.e = plus.e;
+
+  int k;
+  const palFormatDiyFp c = palFormatCachedPower(plus.e, &k);
+  const palFormatDiyFp W = palFormatDiyFpMultiply(palFormatDiyFpNormalize(palFormatDiyFpMake(f, e)), c);
+  palFormatDiyFp Wp = palFormatDiyFpMultiply(plus, c);
+  palFormatDiyFp Wm = palFormatDiyFpMultiply(minus, c);
+  // stay inside the interval despite the rounding of the products
+  Wm.f++;
+  Wp.f--;
+  int length = palFormatDigitGen(W, Wp, Wp.f - Wm.f, buffer, &k);
+  return palFormatDecimal(buffer, length, k);
+}
+
+static int palFormatSpecial(char* buffer, const char* text, int length) {
+  memcpy(buffer, text, length + 1);
+  return length;
+}
+
+int palFormatDouble(char* buffer, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const int biased_exponent = (int)((bits >> 52) & 0x7ff);
+  const uint64_t fraction = bits & ((1ULL << 52) - 1);
+  if (biased_exponent == 0x7ff) {
+    if (fraction != 0) {
+      return palFormatSpecial(buffer, "nan", 3);
+    }
+    return (bits >> 63) ? palFormatSpecial(buffer, "-inf", 4) : palFormatSpecial(buffer, "inf", 3);
+  }
+  int n = 0;
+  if (bits >> 63) {
+    buffer[n++] = '-';
+  }
+  if (biased_exponent == 0 && fraction == 0) {
+    return n + palFormatSpecial(buffer + n, "0", 1);
+  }
+  if (biased_exponent == 0) {
+    return n + palFormatGrisu(buffer + n, fraction, 1 - 1075, false);
+  }
+  return n + palFormatGrisu(buffer + n, fraction | (1ULL << 52), biased_exponent - 1075, fraction == 0 && biased_exponent > 1);
+}
+
+int palFormatFloat(char* buffer, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const int biased_exponent = (int)((bits >> 23) & 0xff);
+  const uint32_t fraction = bits & ((1u << 23) - 1);
+  if (biased_exponent == 0xff) {
+    if (fraction != 0) {
+      return palFormatSpecial(buffer, "nan", 3);
+    }
+    return (bits >> 31) ? palFormatSpecial(buffer, "-inf", 4) : palFormatSpecial(buffer, "inf", 3);
+  }
+  int n = 0;
+  if (bits >> 31) {
+    buffer[n++] = '-';
+  }
+  if (biased_exponent == 0 && fraction == 0) {
+    return n + palFormatSpecial(buffer + n, "0", 1);
+  }
+  // the interval is the float's own, so the digits are the shortest that read back as this float
+  if (biased_exponent == 0) {
+    return n + palFormatGrisu(buffer + n, fraction, 1 - 150, false);
+  }
+  return n + palFormatGrisu(buffer + n, fraction | (1u << 23), biased_exponent - 150, fraction == 0 && biased_exponent > 1);
+}
@@ -0,0 +1,51 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+
+/*
+  Number to text conversion without printf and without allocating.
+
+  Each function writes a NUL terminated string into buffer and returns its
+  length. buffer must hold at least kPalFormatIntBufferSize or
+  kPalFormatFloatBufferSize bytes.
+
+  Floats are printed with the fewest digits that read back to the same
+  value (Grisu2: always round-trips, and is the shortest for almost every
+  input). Magnitudes from 1e-6 up to 1e21 are printed as plain decimals,
+  others as 1.5e+30 or 2e-7. Integral values have no fraction: 100, not
+  100.0. Infinities and NaN print as inf, -inf and nan.
+*/
+
+// "-9223372036854775808" and the terminator
+static const int kPalFormatIntBufferSize = 21;
+// "-0.0000012345678901234567" and the terminator, rounded up
+static const int kPalFormatFloatBufferSize = 32;
+
+int palFormatInt(char* buffer, int64_t value);
+int palFormatUint(char* buffer, uint64_t value);
+int palFormatDouble(char* buffer, double value);
+int palFormatFloat(char* buffer, float value);
@@ -0,0 +1,53 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_errorcode.h"
+
+#define PAL_NUMBER_ERROR_SYNTAX palMakeErrorCode(PAL_ERROR_CODE_NUMBER_GROUP, 1)
+#define PAL_NUMBER_ERROR_RANGE palMakeErrorCode(PAL_ERROR_CODE_NUMBER_GROUP, 2)
+
+/*
+  Text to number conversion that ignores the C locale and reads at most
+  length characters, so the text does not have to be NUL terminated.
+
+  Parsing stops at the first character that can't continue the number.
+  consumed (may be NULL) receives the number of characters used.
+
+  Integers are an optional sign followed by decimal digits. Returns
+  PAL_OK, PAL_NUMBER_ERROR_SYNTAX when there are no digits, or
+  PAL_NUMBER_ERROR_RANGE when the value does not fit, in which case value
+  is clamped to the nearest limit.
+
+  Doubles are an optional sign, digits with an optional fraction, and an
+  optional exponent: -12, 0.5, .5, 6.02e23. The result is correctly
+  rounded (Eisel-Lemire, with an exact fallback for the rare inputs that
+  have more than 19 significant digits and sit on a rounding boundary).
+  Values too large for a double become infinity, too small become zero.
+*/
+int palParseUint64(const char* str, int length, uint64_t* value, int* consumed = NULL);
+int palParseInt64(const char* str, int length, int64_t* value, int* consumed = NULL);
+int palParseDouble(const char* str, int length, double* value, int* consumed = NULL);
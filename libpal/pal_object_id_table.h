@@ -104,10 +104,10 @@ public:
       return max_objects;
     }
 
-    generation_count_++;
-    if (generation_count_ == 1) {
-      // never allow a generation of 1
-      generation_count_++;
+    generation_count_ = (generation_count_ + 1) & generation_mask_;
+    if (generation_count_ <= 1) {
+      // never allow a generation of 1, wrap around to 2
+      generation_count_ = 2;
     }
 
     uint32_t id = next_available_slot_;
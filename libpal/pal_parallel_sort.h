@@ -0,0 +1,141 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_debug.h"
+#include "libpal/pal_algorithms.h"
+#include "libpal/pal_thread.h"
+
+/* Upper bound on the threads one palParallelSort uses, the calling thread included */
+#define kPalParallelSortMaxThreads 16
+/* Below this many elements per thread a thread costs more than it saves */
+#define kPalParallelSortMinPerThread 16384
+
+/* One slice sort or one merge, run on a palThread or on the calling thread */
+template<class T, typename CompareFuncLessThan>
+struct palParallelSortJob {
+  const T* source;
+  T* destination;
+  T* scratch;
+  int lo;
+  int mid;
+  int hi;
+  CompareFuncLessThan* LessThan;
+
+  void Run() {
+    if (scratch != NULL) {
+      palMergeSort(destination + lo, scratch + lo, hi - lo, *LessThan);
+    } else {
+      palMergeSortMerge(source, destination, lo, mid, hi, *LessThan);
+    }
+  }
+
+  static void ThreadMain(uintptr_t param) {
+    reinterpret_cast<palParallelSortJob*>(param)->Run();
+    palThread::Exit(0);
+  }
+};
+
+/* Forks jobs 1 .. count-1 onto threads, runs job 0 here and joins.
+   A job whose thread does not start runs on the calling thread. */
+template<class Job>
+void palParallelSortFork(Job* jobs, int count) {
+  palThread threads[kPalParallelSortMaxThreads];
+  bool started[kPalParallelSortMaxThreads];
+  for (int i = 1; i < count; i++) {
+    palThreadDescription desc;
+    desc.name = "palParallelSort";
+    desc.start_method = palThreadStart(Job::ThreadMain);
+    started[i] = threads[i].Start(desc, reinterpret_cast<uintptr_t>(&jobs[i])) == 0;
+    if (!started[i]) {
+      jobs[i].Run();
+    }
+  }
+  jobs[0].Run();
+  for (int i = 1; i < count; i++) {
+    if (started[i]) {
+      threads[i].Join(NULL);
+    }
+  }
+}
+
+/* Stable fork/join merge sort, scratch must hold buffer_size elements.
+   Splits the buffer into one slice per thread and merge sorts the slices
+   in parallel, then merges pairs of slices, in parallel per level, back
+   and forth between buffer and scratch. Small inputs are sorted on the
+   calling thread. LessThan is called from several threads at once. */
+template<class T, typename CompareFuncLessThan>
+void palParallelSort(T* buffer, T* scratch, int buffer_size, int num_threads, CompareFuncLessThan LessThan) {
+  if (num_threads > kPalParallelSortMaxThreads) {
+    num_threads = kPalParallelSortMaxThreads;
+  }
+  if (num_threads > buffer_size / kPalParallelSortMinPerThread) {
+    num_threads = buffer_size / kPalParallelSortMinPerThread;
+  }
+  if (num_threads <= 1) {
+    palMergeSort(buffer, scratch, buffer_size, LessThan);
+    return;
+  }
+
+  int bounds[kPalParallelSortMaxThreads + 1];
+  for (int i = 0; i <= num_threads; i++) {
+    bounds[i] = (int)((int64_t)buffer_size * i / num_threads);
+  }
+
+  palParallelSortJob<T, CompareFuncLessThan> jobs[kPalParallelSortMaxThreads];
+  for (int i = 0; i < num_threads; i++) {
+    jobs[i].source = NULL;
+    jobs[i].destination = buffer;
+    jobs[i].scratch = scratch;
+    jobs[i].lo = bounds[i];
+    jobs[i].mid = bounds[i];
+    jobs[i].hi = bounds[i + 1];
+    jobs[i].LessThan = &LessThan;
+  }
+  palParallelSortFork(jobs, num_threads);
+
+  T* source = buffer;
+  T* destination = scratch;
+  for (int width = 1; width < num_threads; width *= 2) {
+    int count = 0;
+    for (int slice = 0; slice < num_threads; slice += 2 * width) {
+      jobs[count].source = source;
+      jobs[count].destination = destination;
+      jobs[count].scratch = NULL;
+      jobs[count].lo = bounds[slice];
+      jobs[count].mid = bounds[palMin(slice + width, num_threads)];
+      jobs[count].hi = bounds[palMin(slice + 2 * width, num_threads)];
+      count++;
+    }
+    palParallelSortFork(jobs, count);
+    palSwap(source, destination);
+  }
+  if (source != buffer) {
+    for (int i = 0; i < buffer_size; i++) {
+      buffer[i] = source[i];
+    }
+  }
+}
@@ -146,6 +146,16 @@
   TypeName(const TypeName&); \
   void operator=(const TypeName&)
 
+/* Hint that the cache line holding address will be read soon */
+#if defined(PAL_COMPILER_MICROSOFT)
+#include <xmmintrin.h>
+#define PAL_PREFETCH(address) _mm_prefetch((const char*)(address), _MM_HINT_T0)
+#elif defined(PAL_COMPILER_GNU)
+#define PAL_PREFETCH(address) __builtin_prefetch((address))
+#else
+#define PAL_PREFETCH(address)
+#endif
+
 #define PAL_LIBRARY_PRESENT 1
 
 void palBreakHere();
@@ -0,0 +1,147 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#include "libpal/pal_shared_string.h"
+
+palSharedStringHeader* palSharedString::CreateHeader(const char* str, int length, uint64_t hash, palAllocatorInterface* allocator) {
+  palAssert(length > 0);
+  palSharedStringHeader* header = static_cast<palSharedStringHeader*>(allocator->Allocate(sizeof(palSharedStringHeader) + length + 1));
+  new (&header->references) palAtomicReferenceCount();
+  header->length = length;
+  header->hash = hash;
+  header->allocator = allocator;
+  char* data = header->Data();
+  memcpy(data, str, length);
+  data[length] = '\0';
+  return header;
+}
+
+palSharedString::palSharedString(const palStringView& str, palAllocatorInterface* allocator) : header_(NULL) {
+  if (str.IsEmpty()) {
+    return;
+  }
+  if (allocator == NULL) {
+    allocator = g_StringProxyAllocator;
+  }
+  header_ = CreateHeader(str.GetPtr(), str.GetLength(), palHash64(str.GetPtr(), str.GetLength()), allocator);
+  header_->references.Ref();
+}
+
+palSharedStringTable::palSharedStringTable() : allocator_(NULL) {
+  palMutexDescription md;
+  md.initial_ownership = false;
+  md.name = "palSharedStringTableMutex";
+  int r = mutex_.Create(md);
+  palAssert(r == 0);
+}
+
+palSharedStringTable::~palSharedStringTable() {
+  Reset();
+  mutex_.Destroy();
+}
+
+void palSharedStringTable::SetAllocator(palAllocatorInterface* allocator) {
+  palScopedMutex m(&mutex_);
+  palAssert(table_.IsEmpty());
+  allocator_ = allocator;
+  table_.SetAllocator(allocator);
+}
+
+palSharedString palSharedStringTable::Intern(const palStringView& str) {
+  if (str.IsEmpty()) {
+    return palSharedString();
+  }
+  palHashedString key(str.GetPtr(), str.GetLength());
+  palScopedMutex m(&mutex_);
+  palSharedStringHeader** existing = table_.Find(key);
+  if (existing != NULL) {
+    return palSharedString(*existing);
+  }
+  palAssert(allocator_ != NULL);
+  palSharedStringHeader* header = palSharedString::CreateHeader(key.C(), key.GetLength(), key.GetHash(), allocator_);
+  /* The table's reference */
+  header->references.Ref();
+  table_.Insert(palHashedString(header->Data(), header->length, header->hash), header);
+  return palSharedString(header);
+}
+
+palSharedString palSharedStringTable::Intern(const palSharedString& str) {
+  if (str.IsEmpty()) {
+    return str;
+  }
+  palScopedMutex m(&mutex_);
+  palSharedStringHeader** existing = table_.Find(str.GetHashedString());
+  if (existing != NULL) {
+    return palSharedString(*existing);
+  }
+  palSharedStringHeader* header = str.header_;
+  header->references.Ref();
+  table_.Insert(palHashedString(header->Data(), header->length, header->hash), header);
+  return str;
+}
+
+palSharedString palSharedStringTable::Find(const palStringView& str) {
+  if (str.IsEmpty()) {
+    return palSharedString();
+  }
+  palHashedString key(str.GetPtr(), str.GetLength());
+  palScopedMutex m(&mutex_);
+  palSharedStringHeader** existing = table_.Find(key);
+  return existing != NULL ? palSharedString(*existing) : palSharedString();
+}
+
+int palSharedStringTable::GetSize() {
+  palScopedMutex m(&mutex_);
+  return table_.GetSize();
+}
+
+int palSharedStringTable::Purge() {
+  palScopedMutex m(&mutex_);
+  int released = 0;
+  /* Remove moves the last entry into the removed slot, walking backwards
+   * means that entry has already been visited.
+   */
+  for (int i = table_.GetSize() - 1; i >= 0; i--) {
+    palSharedStringHeader* header = *table_.GetValueAtIndex(i);
+    /* New references to an interned string only come from the table (under
+     * the lock) or from copying a palSharedString someone else holds, so a
+     * count of one can not grow behind our back.
+     */
+    if (header->references.Load() != 1) {
+      continue;
+    }
+    palHashedString key = *table_.GetKeyAtIndex(i);
+    table_.Remove(key);
+    palSharedString::ReleaseHeader(header);
+    released++;
+  }
+  return released;
+}
+
+void palSharedStringTable::Reset() {
+  palScopedMutex m(&mutex_);
+  for (int i = 0; i < table_.GetSize(); i++) {
+    palSharedString::ReleaseHeader(*table_.GetValueAtIndex(i));
+  }
+  table_.Reset();
+}
@@ -0,0 +1,252 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#ifndef LIBPAL_PAL_SHARED_STRING_H_
+#define LIBPAL_PAL_SHARED_STRING_H_
+
+#include <string.h>
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_debug.h"
+#include "libpal/pal_atomic.h"
+#include "libpal/pal_allocator_interface.h"
+#include "libpal/pal_hash_functions.h"
+#include "libpal/pal_hash_map.h"
+#include "libpal/pal_hashed_string.h"
+#include "libpal/pal_string_view.h"
+#include "libpal/pal_thread.h"
+
+/* Header of a palSharedString's single allocation, the NUL terminated
+ * characters follow it directly.
+ */
+struct palSharedStringHeader {
+  palAtomicReferenceCount references;
+  int length;
+  uint64_t hash;
+  palAllocatorInterface* allocator;
+
+  char* Data() {
+    return reinterpret_cast<char*>(this + 1);
+  }
+  const char* Data() const {
+    return reinterpret_cast<const char*>(this + 1);
+  }
+};
+
+/*
+  palSharedString is an immutable, reference counted string.
+
+  The characters, length and palHash64 hash live in one allocation next to
+  an atomic reference count. Copying or assigning a palSharedString only
+  bumps that count, so a string handed to many objects or threads is stored
+  once and every copy is O(1). The characters can never change, which makes
+  it safe to read a palSharedString from any number of threads; only the
+  palSharedString objects themselves (not the text) need the usual care when
+  one object is written by one thread and read by another.
+
+  The empty string does not allocate. GetHash matches palHashFunction for
+  palStringView, palHashedString and palDynamicString with the same
+  characters, so a palSharedString can be looked up in tables keyed by any
+  of those without rehashing.
+
+  Use palDynamicString or palStringBuilder to build text, then turn the
+  result into a palSharedString once it is done changing.
+*/
+class palSharedString {
+  palSharedStringHeader* header_;
+
+  static palSharedStringHeader* CreateHeader(const char* str, int length, uint64_t hash, palAllocatorInterface* allocator);
+  static void ReleaseHeader(palSharedStringHeader* header) {
+    if (header != NULL && header->references.Unref() == 0) {
+      header->allocator->Deallocate(header);
+    }
+  }
+
+  /* Takes a new reference to header */
+  explicit palSharedString(palSharedStringHeader* header) : header_(header) {
+    if (header_ != NULL) {
+      header_->references.Ref();
+    }
+  }
+
+  friend class palSharedStringTable;
+public:
+  palSharedString() : header_(NULL) {
+  }
+
+  /* Copies str, allocator defaults to g_StringProxyAllocator */
+  explicit palSharedString(const palStringView& str, palAllocatorInterface* allocator = NULL);
+
+  palSharedString(const palSharedString& other) : header_(other.header_) {
+    if (header_ != NULL) {
+      header_->references.Ref();
+    }
+  }
+
+  ~palSharedString() {
+    ReleaseHeader(header_);
+  }
+
+  palSharedString& operator=(const palSharedString& other) {
+    /* Ref first so self assignment never drops the last reference */
+    if (other.header_ != NULL) {
+      other.header_->references.Ref();
+    }
+    ReleaseHeader(header_);
+    header_ = other.header_;
+    return *this;
+  }
+
+  void Swap(palSharedString& other) {
+    palSharedStringHeader* header = header_;
+    header_ = other.header_;
+    other.header_ = header;
+  }
+
+  /* Drops this reference, leaving the empty string */
+  void Reset() {
+    ReleaseHeader(header_);
+    header_ = NULL;
+  }
+
+  const char* C() const {
+    return header_ != NULL ? header_->Data() : "";
+  }
+
+  int GetLength() const {
+    return header_ != NULL ? header_->length : 0;
+  }
+
+  bool IsEmpty() const {
+    return header_ == NULL;
+  }
+
+  uint64_t GetHash() const {
+    return header_ != NULL ? header_->hash : palHash64(NULL, 0);
+  }
+
+  palStringView GetView() const {
+    return palStringView(C(), GetLength());
+  }
+
+  palHashedString GetHashedString() const {
+    return palHashedString(C(), GetLength(), GetHash());
+  }
+
+  /* Number of palSharedString objects (and tables) sharing the characters,
+   * 0 for the empty string. Only a hint while other threads hold copies.
+   */
+  int GetReferenceCount() const {
+    return header_ != NULL ? header_->references.Load() : 0;
+  }
+
+  /* True when both share the same characters, always the case for equal
+   * strings interned in the same palSharedStringTable.
+   */
+  bool IsSameInstance(const palSharedString& other) const {
+    return header_ == other.header_;
+  }
+
+  bool Equals(const palSharedString& other) const {
+    if (header_ == other.header_) {
+      return true;
+    }
+    if (GetHash() != other.GetHash() || GetLength() != other.GetLength()) {
+      return false;
+    }
+    return memcmp(C(), other.C(), GetLength()) == 0;
+  }
+
+  bool Equals(const palStringView& str) const {
+    return GetView().Equals(str);
+  }
+};
+
+PAL_INLINE bool operator==(const palSharedString& A, const palSharedString& B) {
+  return A.Equals(B);
+}
+
+PAL_INLINE bool operator!=(const palSharedString& A, const palSharedString& B) {
+  return A.Equals(B) == false;
+}
+
+PAL_INLINE bool operator==(const palStringView& A, const palSharedString& B) {
+  return B.Equals(A);
+}
+
+PAL_INLINE bool operator!=(const palStringView& A, const palSharedString& B) {
+  return B.Equals(A) == false;
+}
+
+template<>
+struct palHashFunction<palSharedString> {
+  uint64_t operator()(const palSharedString& key) const {
+    return key.GetHash();
+  }
+};
+
+/*
+  palSharedStringTable interns palSharedStrings: every Intern call with the
+  same characters returns a palSharedString sharing one allocation, so equal
+  interned strings compare by pointer and are stored once no matter how many
+  threads produce them. All methods lock the table's mutex.
+
+  The table keeps its own reference to every string it interns, so interned
+  strings live until Purge finds nobody else using them or the table is
+  Reset or destroyed.
+*/
+class palSharedStringTable {
+  palHashMap<palHashedString, palSharedStringHeader*> table_;
+  palAllocatorInterface* allocator_;
+  palMutex mutex_;
+  PAL_DISALLOW_COPY_AND_ASSIGN(palSharedStringTable);
+public:
+  palSharedStringTable();
+  ~palSharedStringTable();
+
+  /* Used for the table and new strings, call before the first Intern */
+  void SetAllocator(palAllocatorInterface* allocator);
+
+  /* Returns the interned copy of str, allocating it on first use */
+  palSharedString Intern(const palStringView& str);
+
+  /* Returns the interned copy of str. When none exists yet str itself
+   * becomes the interned copy, so no characters are copied or rehashed.
+   */
+  palSharedString Intern(const palSharedString& str);
+
+  /* Returns the interned copy of str or the empty string if there is none */
+  palSharedString Find(const palStringView& str);
+
+  int GetSize();
+
+  /* Releases interned strings only the table still references, returns how
+   * many were released.
+   */
+  int Purge();
+
+  /* Drops the table's reference to every interned string */
+  void Reset();
+};
+
+#endif  // LIBPAL_PAL_SHARED_STRING_H_
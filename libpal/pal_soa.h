@@ -0,0 +1,322 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_debug.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_allocator_interface.h"
+#include "libpal/pal_memory.h"
+#include "libpal/pal_mem_blob.h"
+
+/*
+  Structure of arrays container.
+
+  palSoA<float, float, float, uint32_t> holds each field in its own array
+  (a column) with one size and capacity for all of them, so a loop that
+  touches two fields of an element only streams those two columns.
+
+  All columns live in one allocation. Every column starts on a
+  kPalSoAColumnAlignment byte boundary and is padded to a multiple of
+  kPalSoAColumnAlignment bytes, so a column can be processed with aligned
+  16 or 32 byte vector loads from the start through GetPaddedSize, the
+  lanes past GetSize hold garbage.
+
+  Up to kPalSoAMaxFields fields are supported, unused trailing fields are
+  palSoANoField and take no memory. Fields are plain data: they are
+  copied bitwise when the columns grow or elements are erased and their
+  destructors are not called.
+
+  Column N is accessed with GetColumn<N>() or as a palTypeBlob with
+  GetColumnSpan<N>(). In template code that is soa.template GetColumn<N>().
+*/
+
+#define kPalSoAMaxFields 8
+#define kPalSoAColumnAlignment 32
+
+struct palSoANoField {
+};
+
+template <typename T>
+struct palSoAFieldSize {
+  static const uint32_t size = sizeof(T);
+};
+
+template <>
+struct palSoAFieldSize<palSoANoField> {
+  static const uint32_t size = 0;
+};
+
+template <int N, typename F0, typename F1, typename F2, typename F3, typename F4, typename F5, typename F6, typename F7>
+struct palSoAFieldSelect;
+
+template <typename F0, typename F1, typename F2, typename F3, typename F4, typename F5, typename F6, typename F7>
+struct palSoAFieldSelect<0, F0, F1, F2, F3, F4, F5, F6, F7> {
+  typedef F0 type;
+};
+
+template <typename F0, typename F1, typename F2, typename F3, typename F4, typename F5, typename F6, typename F7>
+struct palSoAFieldSelect<1, F0, F1, F2, F3, F4, F5, F6, F7> {
+  typedef F1 type;
+};
+
+template <typename F0, typename F1, typename F2, typename F3, typename F4, typename F5, typename F6, typename F7>
+struct palSoAFieldSelect<2, F0, F1, F2, F3, F4, F5, F6, F7> {
+  typedef F2 type;
+};
+
+template <typename F0, typename F1, typename F2, typename F3, typename F4, typename F5, typename F6, typename F7>
+struct palSoAFieldSelect<3, F0, F1, F2, F3, F4, F5, F6, F7> {
+  typedef F3 type;
+};
+
+template <typename F0, typename F1, typename F2, typename F3, typename F4, typename F5, typename F6, typename F7>
+struct palSoAFieldSelect<4, F0, F1, F2, F3, F4, F5, F6, F7> {
+  typedef F4 type;
+};
+
+template <typename F0, typename F1, typename F2, typename F3, typename F4, typename F5, typename F6, typename F7>
+struct palSoAFieldSelect<5, F0, F1, F2, F3, F4, F5, F6, F7> {
+  typedef F5 type;
+};
+
+template <typename F0, typename F1, typename F2, typename F3, typename F4, typename F5, typename F6, typename F7>
+struct palSoAFieldSelect<6, F0, F1, F2, F3, F4, F5, F6, F7> {
+  typedef F6 type;
+};
+
+template <typename F0, typename F1, typename F2, typename F3, typename F4, typename F5, typename F6, typename F7>
+struct palSoAFieldSelect<7, F0, F1, F2, F3, F4, F5, F6, F7> {
+  typedef F7 type;
+};
+
+template <typename F0, typename F1 = palSoANoField, typename F2 = palSoANoField, typename F3 = palSoANoField, typename F4 = palSoANoField, typename F5 = palSoANoField, typename F6 = palSoANoField, typename F7 = palSoANoField>
+class palSoA {
+public:
+  /* Types and constants */
+  typedef palSoA<F0, F1, F2, F3, F4, F5, F6, F7> this_type;
+  template <int N>
+  struct Field {
+    typedef typename palSoAFieldSelect<N, F0, F1, F2, F3, F4, F5, F6, F7>::type type;
+  };
+protected:
+  palAllocatorInterface* allocator_;
+  unsigned char* buffer_;
+  unsigned char* columns_[kPalSoAMaxFields];
+  uint32_t field_size_[kPalSoAMaxFields];
+  int capacity_;
+  int size_;
+
+  static uint64_t ColumnBytes(uint32_t field_size, int capacity) {
+    uint64_t bytes = (uint64_t)field_size * capacity;
+    return (bytes + kPalSoAColumnAlignment - 1) & ~(uint64_t)(kPalSoAColumnAlignment - 1);
+  }
+
+  template <typename T>
+  static void StoreField(unsigned char* column, int i, const T& value) {
+    new (column + (uint64_t)i * sizeof(T)) T(value);
+  }
+
+  static void StoreField(unsigned char* column, int i, const palSoANoField& value) {
+  }
+
+  void Grow(int new_capacity) {
+    uint64_t total = 0;
+    for (int f = 0; f < kPalSoAMaxFields; f++) {
+      total += ColumnBytes(field_size_[f], new_capacity);
+    }
+    unsigned char* new_buffer = static_cast<unsigned char*>(allocator_->Allocate(total, kPalSoAColumnAlignment));
+    unsigned char* column = new_buffer;
+    for (int f = 0; f < kPalSoAMaxFields; f++) {
+      if (size_ > 0 && field_size_[f] > 0) {
+        palMemoryCopyBytes(column, columns_[f], (uint64_t)field_size_[f] * size_);
+      }
+      columns_[f] = column;
+      column += ColumnBytes(field_size_[f], new_capacity);
+    }
+    if (buffer_ != NULL) {
+      allocator_->Deallocate(buffer_);
+    }
+    buffer_ = new_buffer;
+    capacity_ = new_capacity;
+  }
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palSoA);
+public:
+  palSoA() : allocator_(NULL), buffer_(NULL), capacity_(0), size_(0) {
+    field_size_[0] = palSoAFieldSize<F0>::size;
+    field_size_[1] = palSoAFieldSize<F1>::size;
+    field_size_[2] = palSoAFieldSize<F2>::size;
+    field_size_[3] = palSoAFieldSize<F3>::size;
+    field_size_[4] = palSoAFieldSize<F4>::size;
+    field_size_[5] = palSoAFieldSize<F5>::size;
+    field_size_[6] = palSoAFieldSize<F6>::size;
+    field_size_[7] = palSoAFieldSize<F7>::size;
+    for (int f = 0; f < kPalSoAMaxFields; f++) {
+      columns_[f] = NULL;
+    }
+  }
+
+  ~palSoA() {
+    Reset();
+  }
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    allocator_ = allocator;
+  }
+
+  palAllocatorInterface* GetAllocator() const {
+    return allocator_;
+  }
+
+  int GetSize() const {
+    return size_;
+  }
+
+  int GetCapacity() const {
+    return capacity_;
+  }
+
+  bool IsEmpty() const {
+    return size_ == 0;
+  }
+
+  /* Number of elements of column N that can be read with aligned vector loads */
+  template <int N>
+  int GetPaddedSize() const {
+    const uint32_t field_size = palSoAFieldSize<typename Field<N>::type>::size;
+    return (int)(ColumnBytes(field_size, size_) / field_size);
+  }
+
+  template <int N>
+  typename Field<N>::type* GetColumn() {
+    return reinterpret_cast<typename Field<N>::type*>(columns_[N]);
+  }
+
+  template <int N>
+  const typename Field<N>::type* GetColumn() const {
+    return reinterpret_cast<const typename Field<N>::type*>(columns_[N]);
+  }
+
+  template <int N>
+  palTypeBlob<typename Field<N>::type> GetColumnSpan() {
+    return palTypeBlob<typename Field<N>::type>(GetColumn<N>(), size_);
+  }
+
+  /* Field N of element i */
+  template <int N>
+  typename Field<N>::type& Get(int i) {
+    palAssert(i >= 0 && i < size_);
+    return GetColumn<N>()[i];
+  }
+
+  template <int N>
+  const typename Field<N>::type& Get(int i) const {
+    palAssert(i >= 0 && i < size_);
+    return GetColumn<N>()[i];
+  }
+
+  void Reserve(int new_capacity) {
+    if (new_capacity > capacity_) {
+      Grow(new_capacity);
+    }
+  }
+
+  /* New elements are left uninitialized */
+  void Resize(int new_size) {
+    Reserve(new_size);
+    size_ = new_size;
+  }
+
+  /* Appends an element, returns its index */
+  int push_back(const F0& f0, const F1& f1 = F1(), const F2& f2 = F2(), const F3& f3 = F3(), const F4& f4 = F4(), const F5& f5 = F5(), const F6& f6 = F6(), const F7& f7 = F7()) {
+    if (size_ == capacity_) {
+      Grow(capacity_ > 0 ? capacity_ * 2 : 16);
+    }
+    StoreField(columns_[0], size_, f0);
+    StoreField(columns_[1], size_, f1);
+    StoreField(columns_[2], size_, f2);
+    StoreField(columns_[3], size_, f3);
+    StoreField(columns_[4], size_, f4);
+    StoreField(columns_[5], size_, f5);
+    StoreField(columns_[6], size_, f6);
+    StoreField(columns_[7], size_, f7);
+    return size_++;
+  }
+
+  void pop_back() {
+    palAssert(size_ > 0);
+    size_--;
+  }
+
+  /* Removes element i by moving the last element into its place */
+  void Erase(int i) {
+    palAssert(i >= 0 && i < size_);
+    int last = size_ - 1;
+    if (i != last) {
+      for (int f = 0; f < kPalSoAMaxFields; f++) {
+        uint32_t field_size = field_size_[f];
+        palMemoryCopyBytes(columns_[f] + (uint64_t)i * field_size, columns_[f] + (uint64_t)last * field_size, field_size);
+      }
+    }
+    size_ = last;
+  }
+
+  /* Removes element i keeping the order of the following elements */
+  void EraseStable(int i) {
+    palAssert(i >= 0 && i < size_);
+    for (int f = 0; f < kPalSoAMaxFields; f++) {
+      uint32_t field_size = field_size_[f];
+      palMemoryCopyBytes(columns_[f] + (uint64_t)i * field_size, columns_[f] + (uint64_t)(i + 1) * field_size, (uint64_t)(size_ - i - 1) * field_size);
+    }
+    size_--;
+  }
+
+  void Swap(int i, int j) {
+    for (int f = 0; f < kPalSoAMaxFields; f++) {
+      unsigned char* a = columns_[f] + (uint64_t)i * field_size_[f];
+      unsigned char* b = columns_[f] + (uint64_t)j * field_size_[f];
+      for (uint32_t k = 0; k < field_size_[f]; k++) {
+        unsigned char t = a[k];
+        a[k] = b[k];
+        b[k] = t;
+      }
+    }
+  }
+
+  void Clear() {
+    size_ = 0;
+  }
+
+  void Reset() {
+    if (buffer_ != NULL) {
+      allocator_->Deallocate(buffer_);
+      buffer_ = NULL;
+    }
+    for (int f = 0; f < kPalSoAMaxFields; f++) {
+      columns_[f] = NULL;
+    }
+    capacity_ = 0;
+    size_ = 0;
+  }
+};
@@ -0,0 +1,223 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#include "libpal/pal_debug.h"
+#include "libpal/pal_memory.h"
+#include "libpal/pal_spsc_ring_blob.h"
+
+#if defined(PAL_PLATFORM_WINDOWS)
+#include <windows.h>
+#elif defined(PAL_PLATFORM_APPLE)
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+static uint64_t palSpscRingBlobRoundUp(uint64_t capacity, uint64_t granularity) {
+  uint64_t rounded = granularity;
+  while (rounded < capacity) {
+    rounded *= 2;
+  }
+  return rounded;
+}
+
+palSpscRingBlob::palSpscRingBlob() : allocator_(NULL), buffer_(NULL), capacity_(0), mask_(0), mirrored_(false), mapping_(NULL),
+                                     head_(0), producer_head_(0), producer_cached_tail_(0), reserved_(0),
+                                     tail_(0), consumer_tail_(0), consumer_cached_head_(0) {
+}
+
+palSpscRingBlob::~palSpscRingBlob() {
+  Destroy();
+}
+
+int palSpscRingBlob::Create(uint64_t capacity, bool mirrored) {
+  Destroy();
+  if (mirrored) {
+    int r = CreateMirrored(capacity);
+    if (r != 0) {
+      return r;
+    }
+  } else {
+    capacity_ = palSpscRingBlobRoundUp(capacity, kPalSpscRingBlobCacheLineSize);
+    buffer_ = static_cast<unsigned char*>(allocator_->Allocate(capacity_, kPalSpscRingBlobCacheLineSize));
+  }
+  mirrored_ = mirrored;
+  mask_ = capacity_ - 1;
+  head_.Store(0);
+  tail_.Store(0);
+  producer_head_ = 0;
+  producer_cached_tail_ = 0;
+  reserved_ = 0;
+  consumer_tail_ = 0;
+  consumer_cached_head_ = 0;
+  return 0;
+}
+
+void palSpscRingBlob::Destroy() {
+  if (buffer_ != NULL) {
+    if (mirrored_) {
+      DestroyMirrored();
+    } else {
+      allocator_->Deallocate(buffer_);
+    }
+  }
+  buffer_ = NULL;
+  mapping_ = NULL;
+  capacity_ = 0;
+  mask_ = 0;
+  mirrored_ = false;
+}
+
+#if defined(PAL_PLATFORM_WINDOWS)
+
+/* Maps one pagefile backed section twice into a 2 * capacity hole. Another
+   thread can take the hole between VirtualFree and MapViewOfFileEx so a
+   few attempts are made. */
+int palSpscRingBlob::CreateMirrored(uint64_t capacity) {
+  SYSTEM_INFO si;
+  GetSystemInfo(&si);
+  capacity_ = palSpscRingBlobRoundUp(capacity, si.dwAllocationGranularity);
+  HANDLE mapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(capacity_ >> 32), (DWORD)capacity_, NULL);
+  if (mapping == NULL) {
+    return PAL_SPSC_RING_BLOB_ERROR_MAPPING;
+  }
+  for (int attempt = 0; attempt < 16; attempt++) {
+    unsigned char* hole = static_cast<unsigned char*>(VirtualAlloc(NULL, (SIZE_T)(capacity_ * 2), MEM_RESERVE, PAGE_NOACCESS));
+    if (hole == NULL) {
+      break;
+    }
+    VirtualFree(hole, 0, MEM_RELEASE);
+    void* first = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T)capacity_, hole);
+    void* second = first != NULL ? MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T)capacity_, hole + capacity_) : NULL;
+    if (first == hole && second == hole + capacity_) {
+      buffer_ = hole;
+      mapping_ = mapping;
+      return 0;
+    }
+    if (second != NULL) {
+      UnmapViewOfFile(second);
+    }
+    if (first != NULL) {
+      UnmapViewOfFile(first);
+    }
+  }
+  CloseHandle(mapping);
+  capacity_ = 0;
+  return PAL_SPSC_RING_BLOB_ERROR_MAPPING;
+}
+
+void palSpscRingBlob::DestroyMirrored() {
+  UnmapViewOfFile(buffer_ + capacity_);
+  UnmapViewOfFile(buffer_);
+  CloseHandle(static_cast<HANDLE>(mapping_));
+}
+
+#elif defined(PAL_PLATFORM_APPLE)
+
+/* Maps an unlinked temporary file twice over a reserved 2 * capacity range */
+int palSpscRingBlob::CreateMirrored(uint64_t capacity) {
+  capacity_ = palSpscRingBlobRoundUp(capacity, (uint64_t)sysconf(_SC_PAGESIZE));
+  char path[] = "/tmp/palSpscRingBlob.XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    capacity_ = 0;
+    return PAL_SPSC_RING_BLOB_ERROR_MAPPING;
+  }
+  unlink(path);
+  void* reserved = MAP_FAILED;
+  if (ftruncate(fd, (off_t)capacity_) == 0) {
+    reserved = mmap(NULL, (size_t)(capacity_ * 2), PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
+  }
+  if (reserved != MAP_FAILED) {
+    unsigned char* hole = static_cast<unsigned char*>(reserved);
+    void* first = mmap(hole, (size_t)capacity_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    void* second = mmap(hole + capacity_, (size_t)capacity_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    if (first == hole && second == hole + capacity_) {
+      close(fd);
+      buffer_ = hole;
+      return 0;
+    }
+    munmap(hole, (size_t)(capacity_ * 2));
+  }
+  close(fd);
+  capacity_ = 0;
+  return PAL_SPSC_RING_BLOB_ERROR_MAPPING;
+}
+
+void palSpscRingBlob::DestroyMirrored() {
+  munmap(buffer_, (size_t)(capacity_ * 2));
+}
+
+#else
+
+int palSpscRingBlob::CreateMirrored(uint64_t capacity) {
+  return PAL_SPSC_RING_BLOB_ERROR_MAPPING;
+}
+
+void palSpscRingBlob::DestroyMirrored() {
+}
+
+#endif
+
+int palSpscRingBlob::Write(const void* data, uint64_t bytes) {
+  uint64_t head = producer_head_;
+  if (bytes > capacity_ - (head - producer_cached_tail_)) {
+    producer_cached_tail_ = (uint64_t)tail_.Load();
+    if (bytes > capacity_ - (head - producer_cached_tail_)) {
+      return PAL_MEM_BLOB_NO_ROOM;
+    }
+  }
+  uint64_t first = ContiguousFrom(head);
+  if (first > bytes) {
+    first = bytes;
+  }
+  palMemoryCopyBytes(buffer_ + (head & mask_), data, first);
+  if (first < bytes) {
+    palMemoryCopyBytes(buffer_, static_cast<const unsigned char*>(data) + first, bytes - first);
+  }
+  producer_head_ += bytes;
+  head_.Store((int64_t)producer_head_);
+  return 0;
+}
+
+int palSpscRingBlob::Read(void* data, uint64_t bytes) {
+  uint64_t tail = consumer_tail_;
+  if (bytes > consumer_cached_head_ - tail) {
+    consumer_cached_head_ = (uint64_t)head_.Load();
+    if (bytes > consumer_cached_head_ - tail) {
+      return PAL_MEM_BLOB_NO_DATA;
+    }
+  }
+  uint64_t first = ContiguousFrom(tail);
+  if (first > bytes) {
+    first = bytes;
+  }
+  palMemoryCopyBytes(data, buffer_ + (tail & mask_), first);
+  if (first < bytes) {
+    palMemoryCopyBytes(static_cast<unsigned char*>(data) + first, buffer_, bytes - first);
+  }
+  consumer_tail_ += bytes;
+  tail_.Store((int64_t)consumer_tail_);
+  return 0;
+}
@@ -0,0 +1,168 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_atomic.h"
+#include "libpal/pal_mem_blob.h"
+
+#define PAL_SPSC_RING_BLOB_ERROR_MAPPING palMakeErrorCode(PAL_ERROR_CODE_BLOB_GROUP, 3)
+
+#define kPalSpscRingBlobCacheLineSize 64
+
+/* Byte ring shared by exactly one producer thread and one consumer thread
+   without locks.
+
+   head (bytes ever committed) is written only by the producer and tail
+   (bytes ever consumed) only by the consumer. They sit on separate cache
+   lines, next to a cached copy of the other side's index, so each side
+   only reads the other's cache line when its cached copy says the ring
+   looks full (or empty).
+
+   Producer: Reserve returns a contiguous region to fill in place, Commit
+   publishes it. Write copies.
+   Consumer: Peek returns the contiguous readable region, Consume releases
+   it. Read copies.
+
+   The capacity is a power of two. A mirrored ring maps its memory twice,
+   back to back, so a region that wraps past the end is still contiguous
+   and Reserve/Peek always see all free/readable bytes. Without mirroring
+   they stop at the end of the buffer and Reserve fails if the requested
+   bytes would wrap; Write and Read handle the wrap by copying in two parts.
+*/
+class palSpscRingBlob {
+protected:
+  palAllocatorInterface* allocator_;
+  unsigned char* buffer_;
+  uint64_t capacity_;
+  uint64_t mask_;
+  bool mirrored_;
+  // platform mapping handle of a mirrored ring
+  void* mapping_;
+
+  unsigned char producer_pad_[kPalSpscRingBlobCacheLineSize];
+  palAtomicInt64 head_;
+  // producer's copies of head_ and tail_
+  uint64_t producer_head_;
+  uint64_t producer_cached_tail_;
+  uint64_t reserved_;
+
+  unsigned char consumer_pad_[kPalSpscRingBlobCacheLineSize];
+  palAtomicInt64 tail_;
+  // consumer's copies of tail_ and head_
+  uint64_t consumer_tail_;
+  uint64_t consumer_cached_head_;
+
+  unsigned char end_pad_[kPalSpscRingBlobCacheLineSize];
+
+  int CreateMirrored(uint64_t capacity);
+  void DestroyMirrored();
+
+  /* Bytes from the write position to the end of the buffer (or the whole capacity if mirrored) */
+  uint64_t ContiguousFrom(uint64_t position) const {
+    return mirrored_ ? capacity_ : capacity_ - (position & mask_);
+  }
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palSpscRingBlob);
+public:
+  palSpscRingBlob();
+  ~palSpscRingBlob();
+
+  void SetAllocator(palAllocatorInterface* allocator) {
+    allocator_ = allocator;
+  }
+
+  /* capacity is rounded up to a power of two, and for a mirrored ring to
+     the operating system's mapping granularity (64KB on Windows) */
+  int Create(uint64_t capacity, bool mirrored);
+  void Destroy();
+
+  uint64_t GetCapacity() const {
+    return capacity_;
+  }
+
+  bool IsMirrored() const {
+    return mirrored_;
+  }
+
+  /* Bytes committed and not yet consumed, exact only on the consumer when the producer is idle */
+  uint64_t GetSize() const {
+    return (uint64_t)head_.Load() - (uint64_t)tail_.Load();
+  }
+
+  /* Producer side */
+
+  /* Returns bytes of contiguous space to write into, or NULL if there isn't that much */
+  void* Reserve(uint64_t bytes) {
+    uint64_t head = producer_head_;
+    if (bytes > capacity_ - (head - producer_cached_tail_)) {
+      producer_cached_tail_ = (uint64_t)tail_.Load();
+      if (bytes > capacity_ - (head - producer_cached_tail_)) {
+        return NULL;
+      }
+    }
+    if (bytes > ContiguousFrom(head)) {
+      return NULL;
+    }
+    reserved_ = bytes;
+    return buffer_ + (head & mask_);
+  }
+
+  /* Publishes the first bytes of the last Reserve to the consumer */
+  void Commit(uint64_t bytes) {
+    palAssert(bytes <= reserved_);
+    reserved_ = 0;
+    producer_head_ += bytes;
+    head_.Store((int64_t)producer_head_);
+  }
+
+  /* Copies data into the ring, PAL_MEM_BLOB_NO_ROOM if it doesn't fit */
+  int Write(const void* data, uint64_t bytes);
+
+  /* Consumer side */
+
+  /* Returns the contiguous readable bytes, bytes is set to their count (0 when empty) */
+  const void* Peek(uint64_t* bytes) {
+    uint64_t tail = consumer_tail_;
+    uint64_t contiguous = ContiguousFrom(tail);
+    if (consumer_cached_head_ - tail < contiguous) {
+      // there may be more than last seen
+      consumer_cached_head_ = (uint64_t)head_.Load();
+    }
+    uint64_t readable = consumer_cached_head_ - tail;
+    *bytes = readable < contiguous ? readable : contiguous;
+    return buffer_ + (tail & mask_);
+  }
+
+  /* Releases bytes returned by Peek back to the producer */
+  void Consume(uint64_t bytes) {
+    palAssert(bytes <= consumer_cached_head_ - consumer_tail_);
+    consumer_tail_ += bytes;
+    tail_.Store((int64_t)consumer_tail_);
+  }
+
+  /* Copies bytes out of the ring, PAL_MEM_BLOB_NO_DATA if fewer are available */
+  int Read(void* data, uint64_t bytes);
+};
@@ -29,10 +29,75 @@
 #include "libpal/pal_platform.h"
 #include "libpal/pal_algorithms.h"
 #include "libpal/pal_string.h"
+#include "libpal/pal_number_format.h"
 #include "libpal/pal_memory.h"
 #include "libpal/pal_debug.h"
 #include "libpal/pal_allocator.h"
 
+#if defined(PAL_CPU_X86)
+#include <emmintrin.h>
+#define PAL_STRING_SSE2
+#endif
+#if defined(PAL_COMPILER_MICROSOFT)
+#include <intrin.h>
+#endif
+
+/* The SSE2 loops read 16 bytes at a time and may read past the terminator.
+   Aligned blocks never straddle a page and unaligned blocks are only read
+   when they don't reach the next page, so the extra bytes are always on a
+   page the string already touches. AddressSanitizer still objects to them. */
+#if defined(PAL_COMPILER_GNU) && defined(__SANITIZE_ADDRESS__)
+#define PAL_STRING_WIDE_READ __attribute__((no_sanitize_address))
+#else
+#define PAL_STRING_WIDE_READ
+#endif
+
+#if defined(PAL_STRING_SSE2)
+static const uintptr_t kPalStringPageSize = 4096;
+
+/* Number of whole 16 byte blocks that can be read from both a and b without touching the next page */
+static PAL_INLINE int palStringBlocksBeforePageEdge(const char* a, const char* b) {
+  uintptr_t room_a = kPalStringPageSize - ((uintptr_t)a & (kPalStringPageSize - 1));
+  uintptr_t room_b = kPalStringPageSize - ((uintptr_t)b & (kPalStringPageSize - 1));
+  return (int)((room_a < room_b ? room_a : room_b) >> 4);
+}
+
+/* One bit per byte of the unaligned blocks at a and b that differs or ends a */
+static PAL_INLINE uint32_t palStringMismatchMask(const char* a, const char* b) {
+  __m128i va = _mm_loadu_si128((const __m128i*)a);
+  __m128i vb = _mm_loadu_si128((const __m128i*)b);
+  uint32_t differ = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) ^ 0xffff;
+  return differ | (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, _mm_setzero_si128()));
+}
+
+/* Index of the lowest set bit, mask must not be 0 */
+static PAL_INLINE int palStringLowestBit(uint32_t mask) {
+#if defined(PAL_COMPILER_MICROSOFT)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (int)index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+/* Index of the highest set bit, mask must not be 0 */
+static PAL_INLINE int palStringHighestBit(uint32_t mask) {
+#if defined(PAL_COMPILER_MICROSOFT)
+  unsigned long index;
+  _BitScanReverse(&index, mask);
+  return (int)index;
+#else
+  return 31 - __builtin_clz(mask);
+#endif
+}
+
+/* One bit per byte of the aligned block at p that equals any byte of v */
+static PAL_INLINE uint32_t palStringMatchMask(const char* p, __m128i v) {
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i*)p), v));
+}
+#endif
+
 bool    palIsAlpha(char ch) {
   return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z');
 }
@@ -65,10 +130,27 @@ int palHexDigitValue(char ch) {
   return 0;
 }
 
-int palStringLength(const char* str) {
+PAL_STRING_WIDE_READ int palStringLength(const char* str) {
   if (!str || *str == '\0')
     return 0;
+#if defined(PAL_STRING_SSE2)
+  // aligned blocks, the bits for bytes before str are shifted out of the first
+  const __m128i zero = _mm_setzero_si128();
+  const char* block = (const char*)((uintptr_t)str & ~(uintptr_t)15);
+  uint32_t mask = palStringMatchMask(block, zero) >> (str - block);
+  if (mask != 0) {
+    return palStringLowestBit(mask);
+  }
+  for (;;) {
+    block += 16;
+    mask = palStringMatchMask(block, zero);
+    if (mask != 0) {
+      return (int)(block - str) + palStringLowestBit(mask);
+    }
+  }
+#else
   return (int)strlen(str);
+#endif
 }
 
 char* palStringDuplicate(const char* str) {
@@ -98,12 +180,60 @@ void palStringCopy(char* dest, const char* src) {
 #endif
 }
 
-int palStringCompare(const char* a, const char* b) {
+PAL_STRING_WIDE_READ int palStringCompare(const char* a, const char* b) {
+#if defined(PAL_STRING_SSE2)
+  for (;;) {
+    for (int blocks = palStringBlocksBeforePageEdge(a, b); blocks > 0; blocks--) {
+      uint32_t mask = palStringMismatchMask(a, b);
+      if (mask != 0) {
+        int i = palStringLowestBit(mask);
+        return (int)(unsigned char)a[i] - (int)(unsigned char)b[i];
+      }
+      a += 16;
+      b += 16;
+    }
+    // a block would cross a page edge, step over it a byte at a time
+    if (*a != *b || *a == '\0') {
+      return (int)(unsigned char)*a - (int)(unsigned char)*b;
+    }
+    a++;
+    b++;
+  }
+#else
   return strcmp(a, b);
+#endif
 }
 
-int palStringCompareN(const char* a, const char* b, int n) {
+PAL_STRING_WIDE_READ int palStringCompareN(const char* a, const char* b, int n) {
+#if defined(PAL_STRING_SSE2)
+  while (n > 0) {
+    for (int blocks = palStringBlocksBeforePageEdge(a, b); blocks > 0 && n > 0; blocks--) {
+      uint32_t mask = palStringMismatchMask(a, b);
+      if (mask != 0) {
+        int i = palStringLowestBit(mask);
+        if (i >= n) {
+          return 0;
+        }
+        return (int)(unsigned char)a[i] - (int)(unsigned char)b[i];
+      }
+      a += 16;
+      b += 16;
+      n -= 16;
+    }
+    if (n <= 0) {
+      break;
+    }
+    if (*a != *b || *a == '\0') {
+      return (int)(unsigned char)*a - (int)(unsigned char)*b;
+    }
+    a++;
+    b++;
+    n--;
+  }
+  return 0;
+#else
   return strncmp(a, b, n);
+#endif
 }
 
 bool palStringEquals(const char* a, const char* b) {
@@ -134,7 +264,10 @@ int pal_printf_upper_bound(const char* format, ...) {
 }
 
 char* palStringAllocatingPrintfInternal(const char* format, va_list args) {
-  int len = internal_pal_printf_upper_bound(format, args)+1;
+  va_list args_copy;
+  palVaCopy(args_copy, args);
+  int len = internal_pal_printf_upper_bound(format, args_copy)+1;
+  palVaCopyEnd(args_copy);
   palAssert(len >= 0);
   char* str = static_cast<char*>(g_StringProxyAllocator->Allocate(len+1));
   int n = palStringPrintfInternal(str, len, format, args);
@@ -178,10 +311,30 @@ int palStringPrintf(char* str, uint32_t size, const char* format, ...) {
   return n;
 }
 
-int palStringFindCh(const char* str, char ch) {
+PAL_STRING_WIDE_READ int palStringFindCh(const char* str, char ch) {
   if (!str)
     return -1;
 
+#if defined(PAL_STRING_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i needle = _mm_set1_epi8(ch);
+  const char* block = (const char*)((uintptr_t)str & ~(uintptr_t)15);
+  int skip = (int)(str - block);
+  for (;;) {
+    uint32_t zero_mask = palStringMatchMask(block, zero) >> skip;
+    uint32_t ch_mask = palStringMatchMask(block, needle) >> skip;
+    if ((zero_mask | ch_mask) != 0) {
+      int i = palStringLowestBit(zero_mask | ch_mask);
+      // the terminator wins, so searching for '\0' fails like the scalar loop
+      if (zero_mask & (1u << i)) {
+        return -1;
+      }
+      return (int)(block - str) + skip + i;
+    }
+    block += 16;
+    skip = 0;
+  }
+#else
   int index = 0;
   while (*str != 0) {
     if (*str == ch) {
@@ -191,56 +344,221 @@ int palStringFindCh(const char* str, char ch) {
     str++;
   }
   return -1;
+#endif
 }
 
-int palStringFindChFromRight(const char* str, char ch) {
+PAL_STRING_WIDE_READ int palStringFindChFromRight(const char* str, char ch) {
+  if (!str)
+    return -1;
+
+#if defined(PAL_STRING_SSE2)
+  // one pass forward, remembering the last match before the terminator
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i needle = _mm_set1_epi8(ch);
+  const char* block = (const char*)((uintptr_t)str & ~(uintptr_t)15);
+  int skip = (int)(str - block);
+  int last = -1;
+  for (;;) {
+    uint32_t zero_mask = palStringMatchMask(block, zero) >> skip;
+    uint32_t ch_mask = palStringMatchMask(block, needle) >> skip;
+    if (zero_mask != 0) {
+      // only matches below the terminator count
+      uint32_t lowest_zero = zero_mask & (0u - zero_mask);
+      ch_mask &= lowest_zero - 1;
+    }
+    if (ch_mask != 0) {
+      last = (int)(block - str) + skip + palStringHighestBit(ch_mask);
+    }
+    if (zero_mask != 0) {
+      return last;
+    }
+    block += 16;
+    skip = 0;
+  }
+#else
   int length = palStringLength(str);
   while (length > 0) {
+    length--;
     if (str[length] == ch) {
       return length;
     }
-    length--;
   }
   return -1;
+#endif
 }
 
 bool palStringFindString(const char* str, const char* findstr, int* start_out, int* end_out) {
   int str_len = palStringLength(str);
   int findstr_len = palStringLength(findstr);
-  int start;
-  int end;
-
-  if (findstr_len > str_len) {
+  int start = palStringFind(str, str_len, findstr, findstr_len);
+  if (start < 0) {
     return false;
-  } else if (findstr_len == str_len) {
-    if (palStringCompareN(str, findstr, findstr_len) == 0) {
-      start = 0;
-      end = str_len;
-      if (start_out)
-        *start_out = start;
-      if (end_out)
-        *end_out = end;
-      return true;
+  }
+  if (start_out)
+    *start_out = start;
+  if (end_out)
+    *end_out = start + findstr_len;
+  return true;
+}
+
+/* Needles longer than this switch to Two-Way once verifying candidates costs
+   more than kPalStringFindVerifySlack bytes beyond the bytes scanned */
+static const int kPalStringFindFilterMaxNeedle = 32;
+static const int kPalStringFindVerifySlack = 4096;
+
+/* Maximal suffix of x under the byte order (or the reversed order) and its period */
+static int palStringMaximalSuffix(const unsigned char* x, int m, int* period, bool reversed) {
+  int ms = -1;
+  int j = 0;
+  int k = 1;
+  int p = 1;
+  while (j + k < m) {
+    unsigned char a = x[j + k];
+    unsigned char b = x[ms + k];
+    if (reversed ? a > b : a < b) {
+      j += k;
+      k = 1;
+      p = j - ms;
+    } else if (a == b) {
+      if (k != p) {
+        k++;
+      } else {
+        j += p;
+        k = 1;
+      }
+    } else {
+      ms = j;
+      j = ms + 1;
+      k = p = 1;
     }
-    return false;
+  }
+  *period = p;
+  return ms;
+}
+
+/* Crochemore-Perrin Two-Way: linear time and constant space for any needle */
+static int palStringFindTwoWay(const unsigned char* y, int n, const unsigned char* x, int m) {
+  int p, q;
+  int i = palStringMaximalSuffix(x, m, &p, false);
+  int j = palStringMaximalSuffix(x, m, &q, true);
+  int ell, per;
+  if (i > j) {
+    ell = i;
+    per = p;
+  } else {
+    ell = j;
+    per = q;
   }
 
-  const char* search_point = str;
-  for (int i = 0; i <= str_len - findstr_len; i++) {
-    if (palStringCompareN(search_point, findstr, findstr_len) == 0) {
-      start = search_point - str;
-      end = start + findstr_len;
-      if (start_out)
-        *start_out = start;
-      if (end_out)
-        *end_out = end;
-      return true;
+  if (memcmp(x, x + per, ell + 1) == 0) {
+    // periodic needle, remember how much of the last window matched
+    int memory = -1;
+    j = 0;
+    while (j <= n - m) {
+      i = (ell > memory ? ell : memory) + 1;
+      while (i < m && x[i] == y[i + j]) {
+        i++;
+      }
+      if (i >= m) {
+        i = ell;
+        while (i > memory && x[i] == y[i + j]) {
+          i--;
+        }
+        if (i <= memory) {
+          return j;
+        }
+        j += per;
+        memory = m - per - 1;
+      } else {
+        j += i - ell;
+        memory = -1;
+      }
+    }
+  } else {
+    per = (ell + 1 > m - ell - 1 ? ell + 1 : m - ell - 1) + 1;
+    j = 0;
+    while (j <= n - m) {
+      i = ell + 1;
+      while (i < m && x[i] == y[i + j]) {
+        i++;
+      }
+      if (i >= m) {
+        i = ell;
+        while (i >= 0 && x[i] == y[i + j]) {
+          i--;
+        }
+        if (i < 0) {
+          return j;
+        }
+        j += per;
+      } else {
+        j += i - ell;
+      }
     }
-    search_point++;
   }
-  return false;
+  return -1;
+}
+
+static int palStringFindTwoWayFrom(const char* haystack, int haystack_length, const char* needle, int needle_length, int start) {
+  int found = palStringFindTwoWay((const unsigned char*)haystack + start, haystack_length - start,
+                                  (const unsigned char*)needle, needle_length);
+  return found < 0 ? -1 : start + found;
 }
 
+int palStringFind(const char* haystack, int haystack_length, const char* needle, int needle_length) {
+  if (needle_length <= 0) {
+    return 0;
+  }
+  if (needle_length > haystack_length) {
+    return -1;
+  }
+  if (needle_length == 1) {
+    const char* found = (const char*)memchr(haystack, needle[0], haystack_length);
+    return found ? (int)(found - haystack) : -1;
+  }
+
+  const int last_start = haystack_length - needle_length;
+  const bool bounded = needle_length > kPalStringFindFilterMaxNeedle;
+  int verified = 0;
+  int i = 0;
+#if defined(PAL_STRING_SSE2)
+  // candidates are positions where both the first and the last needle byte match
+  const __m128i first = _mm_set1_epi8(needle[0]);
+  const __m128i last = _mm_set1_epi8(needle[needle_length - 1]);
+  for (; i + 15 <= last_start; i += 16) {
+    __m128i block_first = _mm_loadu_si128((const __m128i*)(haystack + i));
+    __m128i block_last = _mm_loadu_si128((const __m128i*)(haystack + i + needle_length - 1));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+    while (mask != 0) {
+      int bit = palStringLowestBit(mask);
+      if (bounded) {
+        verified += needle_length;
+        if (verified > i + kPalStringFindVerifySlack) {
+          return palStringFindTwoWayFrom(haystack, haystack_length, needle, needle_length, i + bit);
+        }
+      }
+      if (memcmp(haystack + i + bit + 1, needle + 1, needle_length - 2) == 0) {
+        return i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+  for (; i <= last_start; i++) {
+    if (haystack[i] == needle[0] && haystack[i + needle_length - 1] == needle[needle_length - 1]) {
+      if (bounded) {
+        verified += needle_length;
+        if (verified > i + kPalStringFindVerifySlack) {
+          return palStringFindTwoWayFrom(haystack, haystack_length, needle, needle_length, i);
+        }
+      }
+      if (memcmp(haystack + i + 1, needle + 1, needle_length - 2) == 0) {
+        return i;
+      }
+    }
+  }
+  return -1;
+}
 
 int palStringToInteger(const char* str) {
   int r = atoi(str);
@@ -275,22 +593,25 @@ bool operator!=(const char* B, const palDynamicString& A) {
   return A.Equals(B) == false;
 }
 
-static const int kPalDynamicStringMinimumCapacity = 16;
+static const int kPalDynamicStringMinimumCapacity = 32;
 static const int kPalDynamicStringGrowthFactor = 2;
 static int pal_dynamic_string_memory_used = 0;
 
-palDynamicString::palDynamicString() : _buffer(NULL), _capacity(0), _length(0) {
+palDynamicString::palDynamicString() : _length(0), _capacity(kInlineCapacity) {
+  _inline[0] = '\0';
 }
 
-palDynamicString::palDynamicString(const char* init_string) : _buffer(NULL), _capacity(0), _length(0) {
+palDynamicString::palDynamicString(const char* init_string) : _length(0), _capacity(kInlineCapacity) {
+  _inline[0] = '\0';
   if (init_string == NULL) {
     return;
   }
   Set(init_string);
 }
 
-palDynamicString::palDynamicString(const palDynamicString& other) : _buffer(NULL), _capacity(0), _length(0) {
-  Set(other.C());
+palDynamicString::palDynamicString(const palDynamicString& other) : _length(0), _capacity(kInlineCapacity) {
+  _inline[0] = '\0';
+  Set(other);
 }
 
 palDynamicString::~palDynamicString() {
@@ -299,10 +620,7 @@ palDynamicString::~palDynamicString() {
 }
 
 void palDynamicString::SetCapacity(int capacity) {
-  if (capacity < _length) {
-    // we are shrinking
-    SetLength(capacity);
-  }
+  // shrinking cuts the string
   Resize(capacity);
 }
 
@@ -311,12 +629,13 @@ void palDynamicString::SetLength(int new_length) {
     // can't grow longer than capacity
     return;
   }
+  char* buffer = Buffer();
   if (new_length > _length) {
     // string is being grown
     // fill with spaces
-    palMemorySetBytes(&_buffer[_length], ' ', new_length - _length);
+    palMemorySetBytes(&buffer[_length], ' ', new_length - _length);
   }
-  _buffer[new_length] = '\0';
+  buffer[new_length] = '\0';
   _length = new_length;
 }
 
@@ -330,15 +649,15 @@ int palDynamicString::GetLength() const {
 
 void palDynamicString::Reset() {
   Resize(0);
-  _length = 0;
+  SetLength(0);
 }
 
 const char* palDynamicString::C() const {
-  return _buffer;
+  return Buffer();
 }
 
 char* palDynamicString::C() {
-  return _buffer;
+  return Buffer();
 }
 
 bool palDynamicString::Equals(const char* str) const {
@@ -346,53 +665,47 @@ bool palDynamicString::Equals(const char* str) const {
 }
 
 bool palDynamicString::Equals(const palDynamicString& str) const {
-  return Compare(str) == 0;
+  if (_length != str._length) {
+    return false;
+  }
+  return memcmp(Buffer(), str.Buffer(), _length) == 0;
 }
 
 int palDynamicString::Compare(const char* str) const {
-  if (_buffer == NULL) {
-    return 1;
-  }
-  return palStringCompare(_buffer, str);
+  return palStringCompare(Buffer(), str);
 }
 
 int palDynamicString::Compare(const palDynamicString& str) const {
-  if (_buffer == NULL) {
-    return 1;
-  }
-  return palStringCompare(_buffer, str.C());
+  return palStringCompare(Buffer(), str.C());
 }
 
 void palDynamicString::Set(const char ch) {
   SetLength(0);
   ExpandCapacityIfNeeded(1);
-  _buffer[0] = ch;
-  _buffer[1] = '\0';
+  char* buffer = Buffer();
+  buffer[0] = ch;
+  buffer[1] = '\0';
   _length = 1;
 }
 
 void palDynamicString::Set(const char* str) {
-  SetLength(0);
-  int length = palStringLength(str);
-  ExpandCapacityIfNeeded(length);
-  palStringCopy(_buffer, str); 
-  _length = length;
+  Set(str, palStringLength(str));
 }
 
 void palDynamicString::Set(const char* str, int length) {
   SetLength(0);
   ExpandCapacityIfNeeded(length);
-  palMemoryCopyBytes(_buffer, str, length);
-  _buffer[length] = '\0';
+  char* buffer = Buffer();
+  palMemoryCopyBytes(buffer, str, length);
+  buffer[length] = '\0';
   _length = length;
 }
 
 void palDynamicString::Set(const palDynamicString& str) {
-  SetLength(0);
-  int length = str.GetLength();
-  ExpandCapacityIfNeeded(length);
-  palStringCopy(_buffer, str.C());
-  _length = length;
+  if (this == &str) {
+    return;
+  }
+  Set(str.C(), str.GetLength());
 }
 
 void palDynamicString::Set(const palDynamicString& str, int start, int count) {
@@ -405,12 +718,9 @@ void palDynamicString::Set(const palDynamicString& str, int start, int count) {
 }
 
 void palDynamicString::SetPrintf(const char* format, ...) {
-  SetLength(0);
   va_list args;
   va_start(args, format);
-  char* temp_string = palStringAllocatingPrintfInternal(format, args);
-  Set(temp_string);
-  g_StringProxyAllocator->Deallocate(temp_string);
+  PrintfInternal(true, format, args);
   va_end(args);
 }
 
@@ -437,12 +747,73 @@ void palDynamicString::Append(const palDynamicString& str, int start, int count)
 void palDynamicString::AppendPrintf(const char* format, ...) {
   va_list args;
   va_start(args, format);
-  char* temp_string = palStringAllocatingPrintfInternal(format, args);
-  Insert(-1, temp_string);
-  g_StringProxyAllocator->Deallocate(temp_string);
+  PrintfInternal(false, format, args);
   va_end(args);
 }
 
+/* Arguments may point into this string (s.AppendPrintf("%s", s.C())), so the
+ * result is never formatted into the string's own buffer: writing there, or
+ * growing it, would change the argument while it is being read. Short results
+ * go through stack scratch, longer ones through a measured temporary.
+ */
+void palDynamicString::PrintfInternal(bool replace, const char* format, va_list args) {
+  char scratch[kPrintfScratchSize];
+  va_list args_copy;
+  palVaCopy(args_copy, args);
+  int n = palStringPrintfInternal(scratch, kPrintfScratchSize, format, args_copy);
+  palVaCopyEnd(args_copy);
+  if (n >= 0 && n < kPrintfScratchSize) {
+    if (replace) {
+      SetLength(0);
+    }
+    Append(scratch, n);
+    return;
+  }
+  char* temp_string = palStringAllocatingPrintfInternal(format, args);
+  if (replace) {
+    SetLength(0);
+  }
+  Append(temp_string);
+  palStringAllocatingPrintfInternalDeallocate(temp_string);
+}
+
+/* Formats straight into the free space when max_length bytes fit, else into scratch */
+char* palDynamicString::FormatTarget(int max_length, char* scratch) {
+  return _capacity - _length >= max_length ? Buffer() + _length : scratch;
+}
+
+void palDynamicString::AppendFormatted(const char* formatted, int length) {
+  if (formatted == Buffer() + _length) {
+    _length += length;
+  } else {
+    Append(formatted, length);
+  }
+}
+
+void palDynamicString::AppendInt(int64_t value) {
+  char scratch[kPalFormatIntBufferSize];
+  char* target = FormatTarget(kPalFormatIntBufferSize, scratch);
+  AppendFormatted(target, palFormatInt(target, value));
+}
+
+void palDynamicString::AppendUint(uint64_t value) {
+  char scratch[kPalFormatIntBufferSize];
+  char* target = FormatTarget(kPalFormatIntBufferSize, scratch);
+  AppendFormatted(target, palFormatUint(target, value));
+}
+
+void palDynamicString::AppendFloat(float value) {
+  char scratch[kPalFormatFloatBufferSize];
+  char* target = FormatTarget(kPalFormatFloatBufferSize, scratch);
+  AppendFormatted(target, palFormatFloat(target, value));
+}
+
+void palDynamicString::AppendDouble(double value) {
+  char scratch[kPalFormatFloatBufferSize];
+  char* target = FormatTarget(kPalFormatFloatBufferSize, scratch);
+  AppendFormatted(target, palFormatDouble(target, value));
+}
+
 void palDynamicString::Prepend(const char ch) {
   Insert(0, ch);
 }
@@ -474,24 +845,7 @@ void palDynamicString::PrependPrintf(const char* format, ...) {
 
 
 void palDynamicString::Insert(int start, const char ch) {
- ExpandCapacityIfNeeded(1);
-
-  if (start < 0)
-    start = _length;
-
-  if (start > _length)
-    return;
-
-  /* create gap for new string by
-   * moving the tail (read: string->str_len_ - position) of the original string str_len_ bytes forward
-   */
-  if (start < _length) {
-    palMemoryCopyBytes(_buffer + start + 1, _buffer + start, _length - start);
-  }
-
-  _buffer[start] = ch;
-  _length += 1;
-  _buffer[_length] = '\0';
+  Insert(start, &ch, 1);
 }
 
 void palDynamicString::Insert(int start, const char* str) {
@@ -513,25 +867,26 @@ void palDynamicString::Insert(int start, const char* str, int count) {
     return;
 
   ExpandCapacityIfNeeded(count);
+  char* buffer = Buffer();
 
   /* create gap for new string by
    * moving the tail (read: str_len_ - position) of the original string str_len_ bytes forward
    */
   if (start < _length) {
-    palMemoryCopyBytes(_buffer + start + count, _buffer + start, _length - start);
+    palMemoryCopyBytes(buffer + start + count, buffer + start, _length - start);
   }
 
   /* insert new string */
   if (count == 1) {
     // single character
-    _buffer[start] = *str;
+    buffer[start] = *str;
   } else {
     // > 1 character
-    palMemoryCopyBytes(_buffer + start, str, count);
+    palMemoryCopyBytes(buffer + start, str, count);
   }
 
   _length += count;
-  _buffer[_length] = 0;
+  buffer[_length] = 0;
 }
 
 void palDynamicString::Insert(int start, const palDynamicString& str) {
@@ -556,10 +911,11 @@ void palDynamicString::Cut(int start, int count) {
     return;
   }
   if (start+count > _length) {
-    int allowed = start+count - _length;
-    count = allowed;
+    count = _length - start;
   }
-  palMemoryCopyBytes(_buffer+start, _buffer+start+count, _length-count);
+  char* buffer = Buffer();
+  // move the tail and its terminator down
+  palMemoryCopyBytes(buffer+start, buffer+start+count, _length-start-count+1);
   _length -= count;
 }
 
@@ -569,11 +925,7 @@ void palDynamicString::Cut(int start, int count, char* target_str) {
 }
 
 void palDynamicString::Cut(int start, int count, palDynamicString* target_str) {
-  target_str->SetLength(0);
-  if (target_str->GetCapacity() > count) {
-    target_str->ExpandCapacityIfNeeded(count);
-  }
-  Copy(start, count, target_str->C());
+  Copy(start, count, target_str);
   Cut(start, count);
 }
 
@@ -583,19 +935,21 @@ void palDynamicString::Copy(int start, int count, char* target_str) {
     return;
   }
   if (start+count > _length) {
-    int allowed = start+count - _length;
-    count = allowed;
+    count = _length - start;
   }
-  palMemoryCopyBytes(target_str, _buffer+start, count);
-  target_str[count+1] = '\0';
+  palMemoryCopyBytes(target_str, Buffer()+start, count);
+  target_str[count] = '\0';
 }
 
 void palDynamicString::Copy(int start, int count, palDynamicString* target_str) {
-  target_str->SetLength(0);
-  if (target_str->GetCapacity() > count) {
-    target_str->ExpandCapacityIfNeeded(count);
+  if (start < 0 || start >= _length) {
+    target_str->SetLength(0);
+    return;
+  }
+  if (start+count > _length) {
+    count = _length - start;
   }
-  return Copy(start, count, target_str->C());
+  target_str->Set(Buffer()+start, count);
 }
 
 void palDynamicString::SearchAndReplace(int start, int count, char search, char replace) {
@@ -603,10 +957,9 @@ void palDynamicString::SearchAndReplace(int start, int count, char search, char
     return;
   }
   if (start+count > _length) {
-    int allowed = start+count-_length;
-    count = allowed;
+    count = _length - start;
   }
-  char* s = _buffer;
+  char* s = Buffer();
   for (int i = start; i < start+count; i++) {
     if (s[i] == search) {
       s[i] = replace;
@@ -615,15 +968,7 @@ void palDynamicString::SearchAndReplace(int start, int count, char search, char
 }
 
 void palDynamicString::SearchAndReplace(int start, char search, char replace) {
-  if (start < 0 || start >= _length) {
-    return;
-  }
-  char* s = _buffer;
-  for (int i = start; _buffer[i] != NULL; i++) {
-    if (s[i] == search) {
-      s[i] = replace;
-    }
-  }
+  SearchAndReplace(start, _length - start, search, replace);
 }
 
 palDynamicString& palDynamicString::operator=(const palDynamicString& str) {
@@ -634,7 +979,7 @@ palDynamicString& palDynamicString::operator=(const palDynamicString& str) {
 }
 
 palDynamicString& palDynamicString::operator=(const char* str) {
-  if (_buffer != str) {
+  if (Buffer() != str) {
     Set(str);
   }
   return *this;
@@ -650,44 +995,41 @@ void palDynamicString::ExpandCapacityIfNeeded(int added_chars) {
   }
 }
 
+/* Capacities up to kInlineCapacity (including 0) select the inline buffer.
+   The string is cut if it does not fit. */
 void palDynamicString::Resize(int new_capacity) {
-  if (_buffer && new_capacity == 0) {
-    // deleting the string
-    pal_dynamic_string_memory_used -= _capacity;
-    g_StringProxyAllocator->Deallocate(_buffer);
-    _buffer = NULL;
-    _capacity = 0;
-  } else if (new_capacity > _capacity) {
-    // growing the string
-    char* new_buffer = (char*)g_StringProxyAllocator->Allocate(new_capacity);
-
-    // track memory used by dynamic strings
-    pal_dynamic_string_memory_used += new_capacity;
-    pal_dynamic_string_memory_used -= _capacity;
-
-    if (_buffer != NULL) {
-      palStringCopy(new_buffer, _buffer);
-    } else {
-      new_buffer[0] = '\0';
-    }
-    g_StringProxyAllocator->Deallocate(_buffer);
-    _buffer = new_buffer;
-    _capacity = new_capacity;
-  } else if (new_capacity < _capacity) {
-    // shrinking the string
-    char* new_buffer = (char*)g_StringProxyAllocator->Allocate(new_capacity);
-
+  if (new_capacity < kInlineCapacity) {
+    new_capacity = kInlineCapacity;
+  }
+  if (new_capacity == _capacity) {
+    return;
+  }
+  int new_length = _length < new_capacity ? _length : new_capacity - 1;
+  char* old_buffer = IsInline() ? NULL : _buffer;
+  const char* old_chars = Buffer();
+  char* new_buffer;
+  char inline_copy[kInlineCapacity];
+  if (new_capacity == kInlineCapacity) {
+    // back to inline, _buffer shares storage with _inline
+    new_buffer = inline_copy;
+  } else {
+    new_buffer = (char*)g_StringProxyAllocator->Allocate(new_capacity);
     // track memory used by dynamic strings
     pal_dynamic_string_memory_used += new_capacity;
+  }
+  palMemoryCopyBytes(new_buffer, old_chars, new_length);
+  new_buffer[new_length] = '\0';
+  if (old_buffer != NULL) {
     pal_dynamic_string_memory_used -= _capacity;
-
-    // copy beginning of old string into new string
-    palAssert(_buffer != NULL);
-    palMemoryCopyBytes(new_buffer, _buffer, new_capacity);
-    g_StringProxyAllocator->Deallocate(_buffer);
+    g_StringProxyAllocator->Deallocate(old_buffer);
+  }
+  if (new_capacity == kInlineCapacity) {
+    palMemoryCopyBytes(_inline, inline_copy, new_length + 1);
+  } else {
     _buffer = new_buffer;
-    _capacity = new_capacity;
   }
+  _capacity = new_capacity;
+  _length = new_length;
 }
 
 void palDynamicString::TrimWhiteSpaceFromStart() {
@@ -696,7 +1038,7 @@ void palDynamicString::TrimWhiteSpaceFromStart() {
   int ws_count = 0;
 
   while (index < GetLength()) {
-    bool ws = palIsWhiteSpace(_buffer[index]);
+    bool ws = palIsWhiteSpace(Buffer()[index]);
     if (start_ws == -1 && ws) {
       start_ws = index;
       ws_count++;
@@ -718,7 +1060,7 @@ void palDynamicString::TrimWhiteSpaceFromEnd() {
   int start_ws;
 
   while (index >= 0) {
-    bool ws = palIsWhiteSpace(_buffer[index]);
+    bool ws = palIsWhiteSpace(Buffer()[index]);
     if (start_ws == -1 && ws) {
       start_ws = index;
       palAssert(start_ws == GetLength()-1);
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <stdarg.h>
 #include "libpal/pal_types.h"
 #include "libpal/pal_memory.h"
 
@@ -48,16 +49,35 @@ void palStringAllocatingPrintfDeallocate(char* buff);
 char* palStringAllocatingPrintfInternal(const char* format, va_list args);
 void palStringAllocatingPrintfInternalDeallocate(char* buff);
 int palStringPrintfInternal(char* str, uint32_t size, const char* format, va_list args);
+/* Characters format produces, not counting the terminator */
+int internal_pal_printf_upper_bound(const char* format, va_list args);
+
+/* va_list can only be walked once on some ABIs, copy it for a second pass */
+#if defined(va_copy)
+#define palVaCopy(dest, src) va_copy(dest, src)
+#define palVaCopyEnd(dest) va_end(dest)
+#else
+#define palVaCopy(dest, src) ((dest) = (src))
+#define palVaCopyEnd(dest)
+#endif
 
 int   palStringFindCh(const char* str, char ch);
 int   palStringFindChFromRight(const char* str, char ch);
 bool  palStringFindString(const char* str, const char* findstr, int* start, int* end);
+/* Index of the first occurrence of needle in haystack, or -1. Neither needs to be NUL terminated. */
+int   palStringFind(const char* haystack, int haystack_length, const char* needle, int needle_length);
 
 int palStringToInteger(const char* str);
 float palStringToFloat(const char* str);
 
+/* Strings of up to kInlineCapacity-1 characters are stored inside the
+   object and never allocate. Longer strings live in a buffer from
+   g_StringProxyAllocator. The object holds no pointer into itself, so it
+   can be moved bitwise. */
 class palDynamicString {
 public:
+  static const int kInlineCapacity = 24;
+
   palDynamicString();
   palDynamicString(const char* init_string);
   palDynamicString(const palDynamicString& other);
@@ -96,6 +116,11 @@ public:
   void Append(const palDynamicString& str);
   void Append(const palDynamicString& str, int start, int count);
   void AppendPrintf(const char* format, ...);
+  /* Formatted like palFormatInt and friends, without going through printf */
+  void AppendInt(int64_t value);
+  void AppendUint(uint64_t value);
+  void AppendFloat(float value);
+  void AppendDouble(double value);
   
   void Prepend(const char ch);
   void Prepend(const char* str);
@@ -124,12 +149,29 @@ public:
   palDynamicString& operator=(const palDynamicString& str);
   palDynamicString& operator=(const char* str);
 private:
-  char* _buffer;
+  union {
+    // when _capacity > kInlineCapacity
+    char* _buffer;
+    char _inline[kInlineCapacity];
+  };
   int _length;
   int _capacity;
 protected:
+  bool IsInline() const {
+    return _capacity == kInlineCapacity;
+  }
+  char* Buffer() {
+    return IsInline() ? _inline : _buffer;
+  }
+  const char* Buffer() const {
+    return IsInline() ? _inline : _buffer;
+  }
   void ExpandCapacityIfNeeded(int added_chars);
   void Resize(int new_capacity);
+  static const int kPrintfScratchSize = 256;
+  void PrintfInternal(bool replace, const char* format, va_list args);
+  char* FormatTarget(int max_length, char* scratch);
+  void AppendFormatted(const char* formatted, int length);
 };
 
 bool operator==(const palDynamicString& A, const palDynamicString& B);
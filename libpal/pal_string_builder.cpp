@@ -0,0 +1,227 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#include "libpal/pal_string_builder.h"
+#include "libpal/pal_number_format.h"
+#include "libpal/pal_errorcode.h"
+
+palStringBuilder::palStringBuilder() : allocator_(NULL), head_(NULL), tail_(NULL), num_chunks_(0),
+                                       chunk_size_(kDefaultChunkSize), length_(0) {
+}
+
+palStringBuilder::~palStringBuilder() {
+  Reset();
+}
+
+void palStringBuilder::SetAllocator(palAllocatorInterface* allocator) {
+  palAssert(head_ == NULL);
+  allocator_ = allocator;
+}
+
+void palStringBuilder::SetChunkSize(int chunk_size) {
+  palAssert(chunk_size > 0);
+  chunk_size_ = chunk_size;
+}
+
+void palStringBuilder::AddChunk(int capacity) {
+  palAssert(allocator_ != NULL);
+  Chunk* chunk = static_cast<Chunk*>(allocator_->Allocate(sizeof(Chunk) + capacity));
+  chunk->next = NULL;
+  chunk->length = 0;
+  chunk->capacity = capacity;
+  if (tail_ != NULL) {
+    tail_->next = chunk;
+  } else {
+    head_ = chunk;
+  }
+  tail_ = chunk;
+  num_chunks_++;
+}
+
+char* palStringBuilder::Reserve(int count) {
+  if (tail_ == NULL || tail_->capacity - tail_->length < count) {
+    AddChunk(count > chunk_size_ ? count : chunk_size_);
+  }
+  return tail_->Data() + tail_->length;
+}
+
+void palStringBuilder::Append(char ch) {
+  *Reserve(1) = ch;
+  Commit(1);
+}
+
+void palStringBuilder::Append(const char* str) {
+  Append(str, palStringLength(str));
+}
+
+void palStringBuilder::Append(const char* str, int length) {
+  // fill the current chunk, then one chunk for all that is left
+  if (tail_ != NULL && length > 0) {
+    int available = tail_->capacity - tail_->length;
+    int count = length < available ? length : available;
+    palMemoryCopyBytes(tail_->Data() + tail_->length, str, count);
+    Commit(count);
+    str += count;
+    length -= count;
+  }
+  if (length > 0) {
+    palMemoryCopyBytes(Reserve(length), str, length);
+    Commit(length);
+  }
+}
+
+void palStringBuilder::Append(const palStringView& str) {
+  Append(str.GetPtr(), str.GetLength());
+}
+
+void palStringBuilder::Append(const palDynamicString& str) {
+  Append(str.C(), str.GetLength());
+}
+
+void palStringBuilder::AppendPrintf(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  AppendPrintfInternal(format, args);
+  va_end(args);
+}
+
+void palStringBuilder::AppendPrintfInternal(const char* format, va_list args) {
+  // try the free space in the current chunk first
+  int available = tail_ != NULL ? tail_->capacity - tail_->length : 0;
+  va_list args_copy;
+  if (available > 0) {
+    palVaCopy(args_copy, args);
+    int n = palStringPrintfInternal(tail_->Data() + tail_->length, available, format, args_copy);
+    palVaCopyEnd(args_copy);
+    if (n >= 0 && n < available) {
+      Commit(n);
+      return;
+    }
+  }
+  palVaCopy(args_copy, args);
+  int n = internal_pal_printf_upper_bound(format, args_copy);
+  palVaCopyEnd(args_copy);
+  // the formatter writes a terminator, which the next append overwrites
+  palStringPrintfInternal(Reserve(n + 1), n + 1, format, args);
+  Commit(n);
+}
+
+void palStringBuilder::AppendInt(int64_t value) {
+  Commit(palFormatInt(Reserve(kPalFormatIntBufferSize), value));
+}
+
+void palStringBuilder::AppendUint(uint64_t value) {
+  Commit(palFormatUint(Reserve(kPalFormatIntBufferSize), value));
+}
+
+void palStringBuilder::AppendFloat(float value) {
+  Commit(palFormatFloat(Reserve(kPalFormatFloatBufferSize), value));
+}
+
+void palStringBuilder::AppendDouble(double value) {
+  Commit(palFormatDouble(Reserve(kPalFormatFloatBufferSize), value));
+}
+
+void palStringBuilder::Clear() {
+  if (head_ == NULL) {
+    return;
+  }
+  Chunk* chunk = head_->next;
+  while (chunk != NULL) {
+    Chunk* next = chunk->next;
+    allocator_->Deallocate(chunk);
+    chunk = next;
+  }
+  head_->next = NULL;
+  head_->length = 0;
+  tail_ = head_;
+  num_chunks_ = 1;
+  length_ = 0;
+}
+
+void palStringBuilder::Reset() {
+  Clear();
+  if (head_ != NULL) {
+    allocator_->Deallocate(head_);
+  }
+  head_ = NULL;
+  tail_ = NULL;
+  num_chunks_ = 0;
+}
+
+int palStringBuilder::GetSpans(palStringBuilderSpan* spans, int max_spans, const void** cursor) const {
+  const Chunk* chunk = reinterpret_cast<const Chunk*>(*cursor);
+  int count = 0;
+  for (; chunk != NULL && count < max_spans; chunk = chunk->next) {
+    spans[count].data = chunk->Data();
+    spans[count].length = (size_t)chunk->length;
+    count++;
+  }
+  *cursor = chunk;
+  return count;
+}
+
+uint64_t palStringBuilder::CopyTo(char* buffer, uint64_t buffer_size) const {
+  if (buffer_size == 0) {
+    return 0;
+  }
+  uint64_t copied = 0;
+  for (const Chunk* chunk = head_; chunk != NULL && copied < buffer_size - 1; chunk = chunk->next) {
+    uint64_t count = (uint64_t)chunk->length;
+    if (count > buffer_size - 1 - copied) {
+      count = buffer_size - 1 - copied;
+    }
+    palMemoryCopyBytes(buffer + copied, chunk->Data(), count);
+    copied += count;
+  }
+  buffer[copied] = '\0';
+  return copied;
+}
+
+void palStringBuilder::CopyTo(palDynamicString* str) const {
+  palAssert(length_ < 0x7fffffff);
+  str->SetLength(0);
+  if (str->GetCapacity() <= (int)length_) {
+    str->SetCapacity((int)length_ + 1);
+  }
+  for (const Chunk* chunk = head_; chunk != NULL; chunk = chunk->next) {
+    str->Append(chunk->Data(), chunk->length);
+  }
+}
+
+int palStringBuilder::WriteTo(palStreamInterface* stream) const {
+  for (const Chunk* chunk = head_; chunk != NULL; chunk = chunk->next) {
+    if (chunk->length == 0) {
+      continue;
+    }
+    uint64_t written = 0;
+    int r = stream->Write(chunk->Data(), 0, chunk->length, &written);
+    if (r != 0) {
+      return r;
+    }
+    if (written != (uint64_t)chunk->length) {
+      return PAL_STREAM_ERROR_CANT_WRITE;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,155 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_debug.h"
+#include "libpal/pal_allocator_interface.h"
+#include "libpal/pal_stream_interface.h"
+#include "libpal/pal_string.h"
+#include "libpal/pal_string_view.h"
+
+/* One piece of a palStringBuilder's text, laid out like POSIX struct iovec */
+struct palStringBuilderSpan {
+  const char* data;
+  size_t length;
+};
+
+/*
+  Builds long text in a chain of chunks instead of one growing buffer, so
+  appending never reallocates or copies what was already written.
+
+  Chunks hold GetChunkSize() characters. An append that is larger than a
+  chunk gets a chunk of its own size. Formatted appends are written whole
+  into one chunk, so the chunk before them may end early.
+
+  The text is not NUL terminated and not contiguous. At the end, copy it
+  out with CopyTo, write it with WriteTo, or hand the spans to a vectored
+  write:
+
+    palStringBuilder report;
+    report.SetAllocator(g_DefaultHeapAllocator);
+    for (...) {
+      report.AppendPrintf("%s: ", name);
+      report.AppendDouble(seconds);
+      report.Append('\n');
+    }
+    report.WriteTo(&file_stream);
+*/
+class palStringBuilder {
+protected:
+  struct Chunk {
+    Chunk* next;
+    int length;
+    int capacity;
+    char* Data() {
+      return reinterpret_cast<char*>(this + 1);
+    }
+    const char* Data() const {
+      return reinterpret_cast<const char*>(this + 1);
+    }
+  };
+
+  palAllocatorInterface* allocator_;
+  Chunk* head_;
+  Chunk* tail_;
+  int num_chunks_;
+  int chunk_size_;
+  uint64_t length_;
+
+  void AddChunk(int capacity);
+  /* count contiguous characters at the end of the text, committed with Commit */
+  char* Reserve(int count);
+  void Commit(int count) {
+    tail_->length += count;
+    length_ += count;
+  }
+  void AppendPrintfInternal(const char* format, va_list args);
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palStringBuilder);
+public:
+  static const int kDefaultChunkSize = 16 * 1024;
+
+  palStringBuilder();
+  ~palStringBuilder();
+
+  void SetAllocator(palAllocatorInterface* allocator);
+  palAllocatorInterface* GetAllocator() const {
+    return allocator_;
+  }
+
+  /* Capacity of the chunks allocated from now on */
+  void SetChunkSize(int chunk_size);
+  int GetChunkSize() const {
+    return chunk_size_;
+  }
+
+  uint64_t GetLength() const {
+    return length_;
+  }
+
+  bool IsEmpty() const {
+    return length_ == 0;
+  }
+
+  void Append(char ch);
+  void Append(const char* str);
+  void Append(const char* str, int length);
+  void Append(const palStringView& str);
+  void Append(const palDynamicString& str);
+  void AppendPrintf(const char* format, ...);
+  void AppendInt(int64_t value);
+  void AppendUint(uint64_t value);
+  void AppendFloat(float value);
+  void AppendDouble(double value);
+
+  /* Empties the text and keeps the first chunk for reuse */
+  void Clear();
+  /* Empties the text and frees every chunk */
+  void Reset();
+
+  int GetNumChunks() const {
+    return num_chunks_;
+  }
+
+  /* Opaque position of the first chunk, for paging with GetSpans. NULL
+     when the text is empty. */
+  const void* GetSpansCursor() const {
+    return head_;
+  }
+
+  /* Fills spans for the chunks starting at *cursor and moves *cursor past
+     them, to NULL after the last chunk. Returns how many were filled, at
+     most max_spans. */
+  int GetSpans(palStringBuilderSpan* spans, int max_spans, const void** cursor) const;
+
+  /* Copies up to buffer_size - 1 characters and a terminator. Returns the
+     number of characters copied. */
+  uint64_t CopyTo(char* buffer, uint64_t buffer_size) const;
+  void CopyTo(palDynamicString* str) const;
+
+  /* Writes the chunks in order. Returns 0 or the stream's error. */
+  int WriteTo(palStreamInterface* stream) const;
+};
@@ -0,0 +1,263 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include <string.h>
+#include "libpal/pal_platform.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_debug.h"
+#include "libpal/pal_string.h"
+#include "libpal/pal_hash_functions.h"
+
+/*
+  A non-owning slice of characters: a pointer and a length. The characters
+  are not NUL terminated and must outlive the view.
+
+  Views convert implicitly from const char* (one strlen) and from
+  palDynamicString, so functions taking a palStringView accept either.
+  Substring, trimming and splitting return new views into the same
+  characters and never copy.
+
+  palHashFunction<palStringView> hashes to the same value as
+  palHashFunction<const char*>, palHashFunction<palDynamicString> and
+  palHashedString for the same characters. Tables keyed by any of those can
+  be searched with a view through palHashMap::FindAs without building an
+  owned key.
+*/
+class palStringView {
+  const char* str_;
+  int length_;
+public:
+  static const int kNotFound = -1;
+
+  palStringView() : str_(""), length_(0) {
+  }
+
+  palStringView(const char* str) : str_(str ? str : ""), length_(palStringLength(str)) {
+  }
+
+  palStringView(const char* str, int length) : str_(str), length_(length) {
+    palAssert(length >= 0);
+  }
+
+  palStringView(const palDynamicString& str) : str_(str.C()), length_(str.GetLength()) {
+  }
+
+  const char* GetPtr() const {
+    return str_;
+  }
+
+  int GetLength() const {
+    return length_;
+  }
+
+  bool IsEmpty() const {
+    return length_ == 0;
+  }
+
+  char operator[](int index) const {
+    palAssert(index >= 0 && index < length_);
+    return str_[index];
+  }
+
+  /* Comparison */
+
+  /* Byte-wise, a prefix sorts before the longer string */
+  int Compare(const palStringView& other) const {
+    int length = length_ < other.length_ ? length_ : other.length_;
+    int r = length > 0 ? memcmp(str_, other.str_, length) : 0;
+    if (r != 0) {
+      return r;
+    }
+    return length_ < other.length_ ? -1 : (length_ > other.length_ ? 1 : 0);
+  }
+
+  bool Equals(const palStringView& other) const {
+    if (length_ != other.length_) {
+      return false;
+    }
+    return str_ == other.str_ || memcmp(str_, other.str_, length_) == 0;
+  }
+
+  bool StartsWith(const palStringView& prefix) const {
+    return prefix.length_ <= length_ && memcmp(str_, prefix.str_, prefix.length_) == 0;
+  }
+
+  bool EndsWith(const palStringView& suffix) const {
+    return suffix.length_ <= length_ && memcmp(str_ + length_ - suffix.length_, suffix.str_, suffix.length_) == 0;
+  }
+
+  /* Searching, all return kNotFound on failure */
+
+  int Find(char ch, int start = 0) const {
+    if (start < 0 || start >= length_) {
+      return kNotFound;
+    }
+    const char* found = static_cast<const char*>(memchr(str_ + start, ch, length_ - start));
+    return found ? (int)(found - str_) : kNotFound;
+  }
+
+  int FindLast(char ch) const {
+    for (int i = length_ - 1; i >= 0; i--) {
+      if (str_[i] == ch) {
+        return i;
+      }
+    }
+    return kNotFound;
+  }
+
+  int Find(const palStringView& needle, int start = 0) const {
+    if (start < 0 || start > length_ || needle.length_ > length_ - start) {
+      return kNotFound;
+    }
+    int index = palStringFind(str_ + start, length_ - start, needle.str_, needle.length_);
+    return index < 0 ? kNotFound : start + index;
+  }
+
+  bool Contains(const palStringView& needle) const {
+    return Find(needle) != kNotFound;
+  }
+
+  /* Slicing, out of range arguments are clamped */
+
+  /* count == -1 runs to the end */
+  palStringView Substring(int start, int count = -1) const {
+    if (start < 0) {
+      start = 0;
+    }
+    if (start > length_) {
+      start = length_;
+    }
+    if (count < 0 || count > length_ - start) {
+      count = length_ - start;
+    }
+    return palStringView(str_ + start, count);
+  }
+
+  palStringView RemovePrefix(int count) const {
+    return Substring(count);
+  }
+
+  palStringView RemoveSuffix(int count) const {
+    return Substring(0, count < length_ ? length_ - count : 0);
+  }
+
+  palStringView TrimWhiteSpaceFromStart() const {
+    int start = 0;
+    while (start < length_ && palIsWhiteSpace(str_[start])) {
+      start++;
+    }
+    return palStringView(str_ + start, length_ - start);
+  }
+
+  palStringView TrimWhiteSpaceFromEnd() const {
+    int length = length_;
+    while (length > 0 && palIsWhiteSpace(str_[length - 1])) {
+      length--;
+    }
+    return palStringView(str_, length);
+  }
+
+  palStringView TrimWhiteSpace() const {
+    return TrimWhiteSpaceFromStart().TrimWhiteSpaceFromEnd();
+  }
+
+  /* Splitting */
+
+  /* Splits around the first separator. Returns false, with the whole view
+     in head and an empty tail, if there is none. */
+  bool Split(char separator, palStringView* head, palStringView* tail) const {
+    int index = Find(separator);
+    if (index == kNotFound) {
+      *head = *this;
+      *tail = palStringView(str_ + length_, 0);
+      return false;
+    }
+    *head = palStringView(str_, index);
+    *tail = palStringView(str_ + index + 1, length_ - index - 1);
+    return true;
+  }
+
+  /* Takes the next separated field off the front of this view, returns
+     false once the view is used up:
+
+       palStringView fields("a,b,,c"), field;
+       while (fields.NextToken(',', &field)) {
+         // "a", "b", "", "c"
+       }
+  */
+  bool NextToken(char separator, palStringView* token) {
+    if (str_ == NULL) {
+      return false;
+    }
+    if (!Split(separator, token, this)) {
+      // last field, mark the view as used up
+      str_ = NULL;
+      length_ = 0;
+    }
+    return true;
+  }
+
+  /* Copies into an owned, NUL terminated string */
+  void CopyTo(palDynamicString* str) const {
+    str->Set(str_, length_);
+  }
+};
+
+PAL_INLINE bool operator==(const palStringView& A, const palStringView& B) {
+  return A.Equals(B);
+}
+
+PAL_INLINE bool operator!=(const palStringView& A, const palStringView& B) {
+  return A.Equals(B) == false;
+}
+
+PAL_INLINE bool operator<(const palStringView& A, const palStringView& B) {
+  return A.Compare(B) < 0;
+}
+
+/* palStringView overloads of the const char* string functions */
+
+PAL_INLINE bool palStringEquals(const palStringView& a, const palStringView& b) {
+  return a.Equals(b);
+}
+
+PAL_INLINE int palStringCompare(const palStringView& a, const palStringView& b) {
+  return a.Compare(b);
+}
+
+PAL_INLINE int palStringFindCh(const palStringView& str, char ch) {
+  return str.Find(ch);
+}
+
+PAL_INLINE int palStringFind(const palStringView& haystack, const palStringView& needle) {
+  return haystack.Find(needle);
+}
+
+template<>
+struct palHashFunction<palStringView> {
+  uint64_t operator()(const palStringView& key) const {
+    return palHash64(key.GetPtr(), key.GetLength());
+  }
+};
@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "libpal/pal_string.h"
+#include "libpal/pal_number_parse.h"
 #include "libpal/pal_debug.h"
 #include "libpal/pal_tokenizer.h"
 
@@ -110,12 +111,14 @@ uint64_t palToken::GetIntegerValue() {
 		}
 		type_flags |= kTokenNumberValueComputed;
 	} else {
-		int base = 10;
-		value_integer = 0;
-		while (*str != 0) {
-			value_integer *= base;
-			value_integer += palDigitValue(*str);
-			str++;
+		if (*str == '-') {
+			// negative values wrap like a cast from int64_t
+			int64_t value = 0;
+			palParseInt64(str, value_string.GetLength(), &value);
+			value_integer = static_cast<uint64_t>(value);
+		} else {
+			// the full unsigned range, values past INT64_MAX do not clamp
+			palParseUint64(str, value_string.GetLength(), &value_integer);
 		}
 		type_flags |= kTokenNumberValueComputed;
 	}
@@ -131,7 +134,9 @@ float palToken::GetFloatValue() {
 		return value_float;
 
 	const char* str = value_string.C();
-	value_float = static_cast<float>(atof(str));
+	double value = 0.0;
+	palParseDouble(str, value_string.GetLength(), &value);
+	value_float = static_cast<float>(value);
 	value_integer = static_cast<int>(value_float);
 	type_flags |= kTokenNumberValueComputed;
 	return value_float;
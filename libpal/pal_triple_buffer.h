@@ -0,0 +1,110 @@
+/*
+  Copyright (c) 2011 John McCutchan <john@johnmccutchan.com>
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+  claim that you wrote the original software. If you use this software
+  in a product, an acknowledgment in the product documentation would be
+  appreciated but is not required.
+
+  2. Altered source versions must be plainly marked as such, and must not be
+  misrepresented as being the original software.
+
+  3. This notice may not be removed or altered from any source
+  distribution.
+*/
+
+#pragma once
+
+#include "libpal/pal_debug.h"
+#include "libpal/pal_types.h"
+#include "libpal/pal_atomic.h"
+
+#define kPalTripleBufferCacheLineSize 64
+
+/*
+  Hands the latest value from one writer thread to one reader thread.
+
+  There are three buffers: the writer fills one, the reader looks at
+  another and the third is the most recently published value waiting in
+  the middle. One atomic word holds the index of the middle buffer and a
+  fresh bit. Publishing swaps the writer's buffer into the middle and
+  marks it fresh; the reader swaps its buffer with the middle only when
+  the fresh bit is set. Each side is one atomic exchange, so neither ever
+  waits for the other and values are never copied.
+
+  The reader always sees the newest complete value, values published
+  between two reads are skipped. After Publish the writer gets back a
+  buffer holding an older value, not the one it just wrote, so it has to
+  fill in every field (or keep its own copy of incremental state).
+*/
+template <typename T>
+class palTripleBuffer {
+protected:
+  static const int32_t kIndexMask = 3;
+  static const int32_t kFresh = 4;
+
+  T buffers_[3];
+
+  unsigned char writer_pad_[kPalTripleBufferCacheLineSize];
+  // owned by the writer
+  int32_t write_index_;
+  unsigned char reader_pad_[kPalTripleBufferCacheLineSize];
+  // owned by the reader
+  int32_t read_index_;
+  unsigned char middle_pad_[kPalTripleBufferCacheLineSize];
+  // index of the middle buffer | kFresh
+  palAtomicInt32 middle_;
+  unsigned char end_pad_[kPalTripleBufferCacheLineSize];
+
+  PAL_DISALLOW_COPY_AND_ASSIGN(palTripleBuffer);
+public:
+  palTripleBuffer() : write_index_(0), read_index_(1), middle_(2) {
+  }
+
+  /* Writer side */
+
+  /* The buffer to fill before calling Publish */
+  T* GetWriteBuffer() {
+    return &buffers_[write_index_];
+  }
+
+  /* Makes the write buffer the latest value and hands the writer another buffer */
+  void Publish() {
+    write_index_ = middle_.Exchange(write_index_ | kFresh) & kIndexMask;
+  }
+
+  /* Reader side */
+
+  /* True if a value was published since the last Update */
+  bool HasNewValue() const {
+    return (middle_.Load() & kFresh) != 0;
+  }
+
+  /* Switches the read buffer to the latest published value, returns false if there is none newer */
+  bool Update() {
+    if (!HasNewValue()) {
+      return false;
+    }
+    read_index_ = middle_.Exchange(read_index_) & kIndexMask;
+    return true;
+  }
+
+  /* The value picked up by the last Update, stays valid until the next Update */
+  const T* GetReadBuffer() const {
+    return &buffers_[read_index_];
+  }
+
+  /* Update and return the latest value */
+  const T* Read() {
+    Update();
+    return GetReadBuffer();
+  }
+};
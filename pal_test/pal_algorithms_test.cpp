@@ -1,6 +1,318 @@
-
+#include <cstdio>
 #include "libpal/libpal.h"
 
+enum palSortTestPattern {
+  kPalSortTestRandom,
+  kPalSortTestSorted,
+  kPalSortTestReversed,
+  kPalSortTestEqual,
+  kPalSortTestFewUnique,
+  kPalSortTestOrganPipe,
+  kPalSortTestSawTooth,
+  NUM_palSortTestPatterns
+};
+
+static void palSortTestFill(int32_t* data, int count, palSortTestPattern pattern) {
+  for (int i = 0; i < count; i++) {
+    switch (pattern) {
+    case kPalSortTestRandom: data[i] = (int32_t)palGenerateRandom(); break;
+    case kPalSortTestSorted: data[i] = i; break;
+    case kPalSortTestReversed: data[i] = count - i; break;
+    case kPalSortTestEqual: data[i] = 7; break;
+    case kPalSortTestFewUnique: data[i] = palGenerateRandom() % 4 - 2; break;
+    case kPalSortTestOrganPipe: data[i] = i < count / 2 ? i : count - i; break;
+    case kPalSortTestSawTooth: data[i] = i % 31; break;
+    default: break;
+    }
+  }
+}
+
+template<typename T>
+static bool palSortTestIsSorted(const T* data, int count) {
+  for (int i = 1; i < count; i++) {
+    if (data[i] < data[i-1]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+struct palSortTestRecord {
+  uint32_t key;
+  int sequence;
+};
+
+class palSortTestRecordLessThan {
+public:
+  bool operator()(const palSortTestRecord& a, const palSortTestRecord& b) {
+    return a.key < b.key;
+  }
+};
+
+class palSortTestRecordKey {
+public:
+  uint32_t operator()(const palSortTestRecord& r) const {
+    return r.key;
+  }
+};
+
+bool palSortTest() {
+  const int sizes[] = { 0, 1, 2, 3, 15, 16, 17, 100, 1000, 20000 };
+  const int num_sizes = sizeof(sizes)/sizeof(sizes[0]);
+  const int max_size = 20000;
+  int32_t* original = new int32_t[max_size];
+  int32_t* intro = new int32_t[max_size];
+  int32_t* merge = new int32_t[max_size];
+  int32_t* heap = new int32_t[max_size];
+  int32_t* radix = new int32_t[max_size];
+  int32_t* scratch = new int32_t[max_size];
+
+  palSeedRandom(33);
+  for (int p = 0; p < NUM_palSortTestPatterns; p++) {
+    for (int s = 0; s < num_sizes; s++) {
+      int count = sizes[s];
+      palSortTestFill(original, count, (palSortTestPattern)p);
+      for (int i = 0; i < count; i++) {
+        intro[i] = merge[i] = heap[i] = radix[i] = original[i];
+      }
+      palIntroSort(intro, count, palCompareFuncLessThan<int32_t>());
+      palMergeSort(merge, scratch, count, palCompareFuncLessThan<int32_t>());
+      palHeapSort(heap, count, palCompareFuncLessThan<int32_t>());
+      palRadixSort(radix, scratch, count);
+      palAssertBreak(palSortTestIsSorted(intro, count));
+      for (int i = 0; i < count; i++) {
+        palAssertBreak(intro[i] == merge[i]);
+        palAssertBreak(intro[i] == heap[i]);
+        palAssertBreak(intro[i] == radix[i]);
+      }
+    }
+  }
+
+  {
+    // floats and 64-bit keys, with negative values
+    float f[1000];
+    float f_scratch[1000];
+    int64_t l[1000];
+    int64_t l_scratch[1000];
+    double d[1000];
+    double d_scratch[1000];
+    for (int i = 0; i < 1000; i++) {
+      f[i] = (palGenerateRandomFloat() - 0.5f) * 1e6f;
+      l[i] = (int64_t)((uint64_t)palGenerateRandom() << 32 | palGenerateRandom());
+      d[i] = (double)l[i] * 0.5;
+    }
+    f[0] = -1e30f;
+    f[1] = 1e30f;
+    f[2] = -1e-30f;
+    palRadixSort(f, f_scratch, 1000);
+    palRadixSort(l, l_scratch, 1000);
+    palRadixSort(d, d_scratch, 1000);
+    palAssertBreak(palSortTestIsSorted(f, 1000));
+    palAssertBreak(palSortTestIsSorted(l, 1000));
+    palAssertBreak(palSortTestIsSorted(d, 1000));
+    palAssertBreak(f[0] == -1e30f && f[999] == 1e30f);
+  }
+
+  {
+    // merge sort and radix sort are stable
+    palSortTestRecord* records = new palSortTestRecord[max_size];
+    palSortTestRecord* sorted = new palSortTestRecord[max_size];
+    palSortTestRecord* record_scratch = new palSortTestRecord[max_size];
+    for (int i = 0; i < max_size; i++) {
+      records[i].key = palGenerateRandom() % 100 + (palGenerateRandom() % 3 << 24);
+      records[i].sequence = i;
+    }
+    for (int pass = 0; pass < 2; pass++) {
+      for (int i = 0; i < max_size; i++) {
+        sorted[i] = records[i];
+      }
+      if (pass == 0) {
+        palMergeSort(sorted, record_scratch, max_size, palSortTestRecordLessThan());
+      } else {
+        palRadixSortByKey<uint32_t>(sorted, record_scratch, max_size, palSortTestRecordKey());
+      }
+      for (int i = 1; i < max_size; i++) {
+        palAssertBreak(sorted[i-1].key <= sorted[i].key);
+        if (sorted[i-1].key == sorted[i].key) {
+          palAssertBreak(sorted[i-1].sequence < sorted[i].sequence);
+        }
+      }
+    }
+    delete [] record_scratch;
+    delete [] sorted;
+    delete [] records;
+  }
+
+  {
+    // parallel sort is stable and matches merge sort, an odd thread count
+    // leaves a slice out of the first merge level
+    const int parallel_size = 5 * kPalParallelSortMinPerThread + 3;
+    palSortTestRecord* records = new palSortTestRecord[parallel_size];
+    palSortTestRecord* sorted = new palSortTestRecord[parallel_size];
+    palSortTestRecord* record_scratch = new palSortTestRecord[parallel_size];
+    for (int threads = 1; threads <= 8; threads++) {
+      for (int i = 0; i < parallel_size; i++) {
+        records[i].key = palGenerateRandom() % 1000;
+        records[i].sequence = i;
+        sorted[i] = records[i];
+      }
+      palParallelSort(sorted, record_scratch, parallel_size, threads, palSortTestRecordLessThan());
+      palMergeSort(records, record_scratch, parallel_size, palSortTestRecordLessThan());
+      for (int i = 0; i < parallel_size; i++) {
+        palAssertBreak(sorted[i].key == records[i].key && sorted[i].sequence == records[i].sequence);
+      }
+    }
+    delete [] record_scratch;
+    delete [] sorted;
+    delete [] records;
+  }
+
+  delete [] scratch;
+  delete [] radix;
+  delete [] heap;
+  delete [] merge;
+  delete [] intro;
+  delete [] original;
+  return true;
+}
+
+bool palSortBenchmark() {
+  const int count = 1024*1024;
+  uint32_t* original = new uint32_t[count];
+  uint32_t* data = new uint32_t[count];
+  uint32_t* scratch = new uint32_t[count];
+  palTimer timer;
+
+  printf("Sorting %d uint32_t\n", count);
+  printf("%10s %12s %12s %12s %12s %12s\n", "input", "heap", "intro", "merge", "radix", "parallel 4");
+  for (int p = 0; p < 3; p++) {
+    const char* names[3] = { "random", "sorted", "organ pipe" };
+    palSortTestFill(reinterpret_cast<int32_t*>(original), count, p == 0 ? kPalSortTestRandom : p == 1 ? kPalSortTestSorted : kPalSortTestOrganPipe);
+    float times[5];
+    for (int sort = 0; sort < 5; sort++) {
+      for (int i = 0; i < count; i++) {
+        data[i] = original[i];
+      }
+      timer.Start();
+      switch (sort) {
+      case 0: palHeapSort(data, count, palCompareFuncLessThan<uint32_t>()); break;
+      case 1: palIntroSort(data, count, palCompareFuncLessThan<uint32_t>()); break;
+      case 2: palMergeSort(data, scratch, count, palCompareFuncLessThan<uint32_t>()); break;
+      case 3: palRadixSort(data, scratch, count); break;
+      case 4: palParallelSort(data, scratch, count, 4, palCompareFuncLessThan<uint32_t>()); break;
+      }
+      timer.Stop();
+      times[sort] = timer.GetDeltaSeconds();
+      palAssertBreak(palSortTestIsSorted(data, count));
+    }
+    printf("%10s %12f %12f %12f %12f %12f\n", names[p], times[0], times[1], times[2], times[3], times[4]);
+  }
+
+  delete [] scratch;
+  delete [] data;
+  delete [] original;
+  return true;
+}
+
+bool palSearchTest() {
+  uint32_t data[70];
+  int slot_to_sorted[71];
+  for (int count = 0; count <= 70; count++) {
+    for (int i = 0; i < count; i++) {
+      // duplicates and gaps
+      data[i] = (i / 3) * 2 + 1;
+    }
+    palEytzingerArray<uint32_t> eytzinger;
+    eytzinger.SetAllocator(g_DefaultHeapAllocator);
+    eytzinger.Build(data, count, slot_to_sorted);
+    palAssertBreak(eytzinger.GetSize() == count);
+    for (uint32_t needle = 0; needle < 52; needle++) {
+      int lower = 0;
+      while (lower < count && data[lower] < needle) {
+        lower++;
+      }
+      int upper = lower;
+      while (upper < count && !(needle < data[upper])) {
+        upper++;
+      }
+      palAssertBreak(palLowerBound(data, count, needle) == lower);
+      palAssertBreak(palUpperBound(data, count, needle) == upper);
+
+      int slot = eytzinger.LowerBound(needle);
+      palAssertBreak((slot == 0) == (lower == count));
+      palAssertBreak(slot == 0 || slot_to_sorted[slot] == lower);
+      slot = eytzinger.UpperBound(needle);
+      palAssertBreak((slot == 0) == (upper == count));
+      palAssertBreak(slot == 0 || slot_to_sorted[slot] == upper);
+      slot = eytzinger.Find(needle);
+      palAssertBreak((slot != 0) == (lower < upper));
+      palAssertBreak(slot == 0 || eytzinger.GetAt(slot) == needle);
+    }
+  }
+  return true;
+}
+
+bool palSearchBenchmark() {
+  const int max_count = 16*1024*1024;
+  const int num_queries = 1024*1024;
+  uint32_t* data = new uint32_t[max_count];
+  uint32_t* queries = new uint32_t[num_queries];
+  palTimer timer;
+
+  printf("%d searches\n", num_queries);
+  printf("%10s %12s %12s %12s\n", "elements", "classic", "branchless", "eytzinger");
+  for (int count = 1024; count <= max_count; count *= 4) {
+    for (int i = 0; i < count; i++) {
+      data[i] = (uint32_t)i * 2;
+    }
+    for (int i = 0; i < num_queries; i++) {
+      queries[i] = palGenerateRandom() % (count * 2);
+    }
+    palEytzingerArray<uint32_t> eytzinger;
+    eytzinger.SetAllocator(g_DefaultHeapAllocator);
+    eytzinger.Build(data, count);
+
+    uint32_t classic_hits = 0;
+    timer.Start();
+    for (int i = 0; i < num_queries; i++) {
+      const uint32_t* hit;
+      if (palBinarySearch(data, count, queries[i], &hit) == 0) {
+        classic_hits++;
+      }
+    }
+    timer.Stop();
+    float classic_time = timer.GetDeltaSeconds();
+
+    uint32_t branchless_hits = 0;
+    timer.Start();
+    for (int i = 0; i < num_queries; i++) {
+      int index = palLowerBound(data, count, queries[i]);
+      if (index < count && data[index] == queries[i]) {
+        branchless_hits++;
+      }
+    }
+    timer.Stop();
+    float branchless_time = timer.GetDeltaSeconds();
+
+    uint32_t eytzinger_hits = 0;
+    timer.Start();
+    for (int i = 0; i < num_queries; i++) {
+      if (eytzinger.Find(queries[i]) != 0) {
+        eytzinger_hits++;
+      }
+    }
+    timer.Stop();
+    float eytzinger_time = timer.GetDeltaSeconds();
+
+    palAssertBreak(classic_hits == branchless_hits && branchless_hits == eytzinger_hits);
+    printf("%10d %12f %12f %12f\n", count, classic_time, branchless_time, eytzinger_time);
+  }
+
+  delete [] queries;
+  delete [] data;
+  return true;
+}
+
 bool PalAlgorithmsTest() {
   uint32_t data[] = { 11, 12, 13, 14, 15, 16, 17, 18, 19 };
   uint32_t num_data = sizeof(data)/sizeof(data[0]);
@@ -51,6 +363,11 @@ bool PalAlgorithmsTest() {
     // Equality
   }
 
+  palSortTest();
+  palSortBenchmark();
+  palSearchTest();
+  palSearchBenchmark();
+
 
   palBreakHere();
   return true;
@@ -1,5 +1,10 @@
+#include <cstdio>
 #include "libpal/pal_string.h"
 #include "libpal/pal_mem_blob.h"
+#include "libpal/pal_spsc_ring_blob.h"
+#include "libpal/pal_thread.h"
+#include "libpal/pal_timer.h"
+#include "libpal/pal_allocator.h"
 
 #include "pal_test/pal_blob_test.h"
 
@@ -111,9 +116,216 @@ bool TestRingBufferWrap() {
   return true;
 }
 
+bool TestAppendChopBlobFill() {
+  int r;
+  uint8_t small_buffer[16];
+  palAppendChopBlob acb(&small_buffer[0], 16);
+  uint64_t num_a = 0xf00dd00fcafebabe;
+  uint64_t num_b = 0xdeadbeeffeedbeeb;
+  uint8_t la = 'z';
+
+  // appends may fill the buffer exactly, like palRingBlob
+  r = acb.Append(&num_a);
+  palAssertBreak(r == 0);
+  r = acb.Append(&num_b);
+  palAssertBreak(r == 0);
+  palAssertBreak(acb.IsFull() && acb.GetAvailableSize() == 0);
+  r = acb.Append(&la);
+  palAssertBreak(r == PAL_MEM_BLOB_NO_ROOM);
+
+  r = acb.Chop(sizeof(num_a));
+  palAssertBreak(r == 0);
+  palAssertBreak(*acb.GetPtr<uint64_t>(0) == num_b);
+  r = acb.Append(&la);
+  palAssertBreak(r == 0);
+  palAssertBreak(acb.GetSize() == sizeof(num_b) + sizeof(la));
+
+  return true;
+}
+
+bool TestSpscRingBlobBasic() {
+  for (int mirrored = 0; mirrored < 2; mirrored++) {
+    palSpscRingBlob ring;
+    ring.SetAllocator(g_DefaultHeapAllocator);
+    int r = ring.Create(100, mirrored != 0);
+    palAssertBreak(r == 0);
+    uint64_t capacity = ring.GetCapacity();
+    palAssertBreak(capacity >= 100 && (capacity & (capacity - 1)) == 0);
+
+    uint64_t bytes;
+    ring.Peek(&bytes);
+    palAssertBreak(bytes == 0);
+    void* too_large = ring.Reserve(capacity + 1);
+    palAssertBreak(too_large == NULL);
+
+    // fill three quarters in place, consume half
+    unsigned char* region = static_cast<unsigned char*>(ring.Reserve(capacity / 4 * 3));
+    palAssertBreak(region != NULL);
+    for (uint64_t i = 0; i < capacity / 4 * 3; i++) {
+      region[i] = (unsigned char)i;
+    }
+    ring.Commit(capacity / 4 * 3);
+    const unsigned char* readable = static_cast<const unsigned char*>(ring.Peek(&bytes));
+    palAssertBreak(bytes == capacity / 4 * 3);
+    palAssertBreak(readable[0] == 0 && readable[bytes - 1] == (unsigned char)(bytes - 1));
+    ring.Consume(capacity / 2);
+    palAssertBreak(ring.GetSize() == capacity / 4);
+
+    // half the capacity is free but it wraps, only a mirrored ring can hand it out in one piece
+    region = static_cast<unsigned char*>(ring.Reserve(capacity / 2));
+    palAssertBreak((region != NULL) == (mirrored != 0));
+    if (region == NULL) {
+      region = static_cast<unsigned char*>(ring.Reserve(capacity / 4));
+      palAssertBreak(region != NULL);
+      too_large = ring.Reserve(capacity / 4 + 1);
+      palAssertBreak(too_large == NULL);
+    }
+    ring.Commit(0);
+
+    // copying writes and reads wrap around
+    unsigned char block[64];
+    for (int i = 0; i < 64; i++) {
+      block[i] = (unsigned char)(200 + i);
+    }
+    r = ring.Write(block, capacity);
+    palAssertBreak(r == PAL_MEM_BLOB_NO_ROOM);
+    r = ring.Write(block, 64);
+    palAssertBreak(r == 0);
+    unsigned char* check = static_cast<unsigned char*>(g_DefaultHeapAllocator->Allocate(capacity));
+    r = ring.Read(check, capacity / 4);
+    palAssertBreak(r == 0);
+    palAssertBreak(check[0] == (unsigned char)(capacity / 2));
+    readable = static_cast<const unsigned char*>(ring.Peek(&bytes));
+    // without mirroring Peek stops at the end of the buffer
+    palAssertBreak(bytes == (mirrored || capacity / 4 >= 64 ? 64 : capacity / 4));
+    palAssertBreak(readable[0] == 200);
+    r = ring.Read(check, 65);
+    palAssertBreak(r == PAL_MEM_BLOB_NO_DATA);
+    r = ring.Read(check, 64);
+    palAssertBreak(r == 0);
+    for (int i = 0; i < 64; i++) {
+      palAssertBreak(check[i] == block[i]);
+    }
+    palAssertBreak(ring.GetSize() == 0);
+    g_DefaultHeapAllocator->Deallocate(check);
+    ring.Destroy();
+  }
+  return true;
+}
+
+/* Producer writes numbered records of varying length, the consumer checks them */
+struct palSpscRingBlobTestRecord {
+  uint32_t sequence;
+  uint32_t length;
+};
+
+struct palSpscRingBlobTestShared {
+  palSpscRingBlob ring;
+  int num_records;
+  bool zero_copy;
+};
+
+static uint32_t palSpscRingBlobTestLength(uint32_t sequence) {
+  return sizeof(palSpscRingBlobTestRecord) + 1 + (sequence * 7) % 120;
+}
+
+static int palSpscRingBlobTestProducer(uintptr_t param) {
+  palSpscRingBlobTestShared* shared = reinterpret_cast<palSpscRingBlobTestShared*>(param);
+  unsigned char record[256];
+  for (int i = 0; i < shared->num_records; i++) {
+    palSpscRingBlobTestRecord header;
+    header.sequence = i;
+    header.length = palSpscRingBlobTestLength(i);
+    if (shared->zero_copy) {
+      unsigned char* region = NULL;
+      while ((region = static_cast<unsigned char*>(shared->ring.Reserve(header.length))) == NULL) {
+        palThread::SpinYield();
+      }
+      palMemoryCopyBytes(region, &header, sizeof(header));
+      palMemorySetBytes(region + sizeof(header), (unsigned char)i, header.length - sizeof(header));
+      shared->ring.Commit(header.length);
+    } else {
+      palMemoryCopyBytes(record, &header, sizeof(header));
+      palMemorySetBytes(record + sizeof(header), (unsigned char)i, header.length - sizeof(header));
+      while (shared->ring.Write(record, header.length) != 0) {
+        palThread::SpinYield();
+      }
+    }
+  }
+  palThread::Exit(0);
+  return 0;
+}
+
+static float palSpscRingBlobTestRun(int num_records, uint64_t capacity, bool mirrored) {
+  palSpscRingBlobTestShared shared;
+  shared.ring.SetAllocator(g_DefaultHeapAllocator);
+  int r = shared.ring.Create(capacity, mirrored);
+  palAssertBreak(r == 0);
+  shared.num_records = num_records;
+  // records are only contiguous when the ring is mirrored
+  shared.zero_copy = mirrored;
+
+  palTimer timer;
+  timer.Start();
+  palThread producer;
+  palThreadDescription thread_desc;
+  thread_desc.name = "palSpscRingBlobTestProducer";
+  thread_desc.start_method = palThreadStart(palSpscRingBlobTestProducer);
+  producer.Start(thread_desc, (uintptr_t)&shared);
+
+  unsigned char record[256];
+  for (int i = 0; i < num_records; i++) {
+    uint32_t length = palSpscRingBlobTestLength(i);
+    const unsigned char* data = NULL;
+    if (mirrored) {
+      uint64_t bytes = 0;
+      while (bytes < length) {
+        data = static_cast<const unsigned char*>(shared.ring.Peek(&bytes));
+        if (bytes < length) {
+          palThread::SpinYield();
+        }
+      }
+    } else {
+      while (shared.ring.Read(record, length) != 0) {
+        palThread::SpinYield();
+      }
+      data = record;
+    }
+    palSpscRingBlobTestRecord header;
+    palMemoryCopyBytes(&header, data, sizeof(header));
+    palAssertBreak(header.sequence == (uint32_t)i && header.length == length);
+    palAssertBreak(data[length - 1] == (unsigned char)i);
+    if (mirrored) {
+      shared.ring.Consume(length);
+    }
+  }
+  producer.Join(NULL);
+  timer.Stop();
+  palAssertBreak(shared.ring.GetSize() == 0);
+  return timer.GetDeltaSeconds();
+}
+
+bool TestSpscRingBlobThreads() {
+  palSpscRingBlobTestRun(100000, 4096, false);
+  palSpscRingBlobTestRun(100000, 4096, true);
+  return true;
+}
+
+bool BenchmarkSpscRingBlob() {
+  const int num_records = 4*1024*1024;
+  printf("%d records through a 64KB ring\n", num_records);
+  printf("%-24s %f\n", "Write/Read", palSpscRingBlobTestRun(num_records, 64*1024, false));
+  printf("%-24s %f\n", "mirrored Reserve/Peek", palSpscRingBlobTestRun(num_records, 64*1024, true));
+  return true;
+}
+
 bool PalBlobTest() {
   TestRingBufferBasic();
   TestRingBufferFillEmpty();
   TestRingBufferWrap();
+  TestAppendChopBlobFill();
+  TestSpscRingBlobBasic();
+  TestSpscRingBlobThreads();
+  BenchmarkSpscRingBlob();
   return true;
 }
@@ -210,6 +210,569 @@ bool palPalHashMapCacheTest() {
   return true;
 }
 
+static int palChunkedArrayLiveObjects = 0;
+
+struct palChunkedArrayObject {
+  int value;
+  palChunkedArrayObject() : value(0) {
+    palChunkedArrayLiveObjects++;
+  }
+  palChunkedArrayObject(const palChunkedArrayObject& o) : value(o.value) {
+    palChunkedArrayLiveObjects++;
+  }
+  ~palChunkedArrayObject() {
+    palChunkedArrayLiveObjects--;
+  }
+};
+
+bool palChunkedArrayTest() {
+  const int num_elements = 10000;
+  {
+    palChunkedArray<palChunkedArrayObject, 64> array;
+    array.SetAllocator(g_DefaultHeapAllocator);
+    palArray<palChunkedArrayObject*> addresses;
+    addresses.SetAllocator(g_DefaultHeapAllocator);
+
+    for (int i = 0; i < num_elements; i++) {
+      palChunkedArrayObject o;
+      o.value = i;
+      int index = array.push_back(o);
+      palAssertBreak(index == i);
+      addresses.push_back(&array[i]);
+    }
+    palAssertBreak(array.GetSize() == num_elements);
+    palAssertBreak(palChunkedArrayLiveObjects == num_elements);
+    palAssertBreak(array.GetChunkCount() == (num_elements + 63) / 64);
+
+    // growing never moved an element
+    for (int i = 0; i < num_elements; i++) {
+      palAssertBreak(addresses[i] == &array[i]);
+      palAssertBreak(array[i].value == i);
+    }
+
+    int count = 0;
+    for (int c = 0; c < array.GetChunkCount(); c++) {
+      palChunkedArrayObject* elements = array.GetChunk(c);
+      for (int i = 0; i < array.GetChunkSize(c); i++) {
+        palAssertBreak(elements[i].value == count);
+        count++;
+      }
+    }
+    palAssertBreak(count == num_elements);
+
+    for (int i = 0; i < 100; i++) {
+      array.pop_back();
+    }
+    palAssertBreak(palChunkedArrayLiveObjects == num_elements - 100);
+    array.AddTail().value = -1;
+    palAssertBreak(addresses[num_elements - 100] == &array[num_elements - 100]);
+    palAssertBreak(array[num_elements - 100].value == -1);
+
+    int capacity = array.GetCapacity();
+    array.Clear();
+    palAssertBreak(palChunkedArrayLiveObjects == 0);
+    palAssertBreak(array.GetCapacity() == capacity);
+    array.Resize(1000);
+    palAssertBreak(palChunkedArrayLiveObjects == 1000);
+    array.Resize(10);
+    palAssertBreak(palChunkedArrayLiveObjects == 10);
+  }
+  palAssertBreak(palChunkedArrayLiveObjects == 0);
+  return true;
+}
+
+/* Times push_back in batches and reports the slowest batch, which is where
+   palArray reallocates and copies */
+bool palChunkedArrayBenchmark() {
+  const int num_elements = 4*1024*1024;
+  const int batch_size = 1024;
+  palArray<int> array;
+  palChunkedArray<int, 4096> chunked;
+  array.SetAllocator(g_DefaultHeapAllocator);
+  chunked.SetAllocator(g_DefaultHeapAllocator);
+
+  palTimer total_timer;
+  palTimer batch_timer;
+  float array_worst = 0.0f;
+  total_timer.Start();
+  for (int i = 0; i < num_elements; i += batch_size) {
+    batch_timer.Start();
+    for (int j = 0; j < batch_size; j++) {
+      array.push_back(i + j);
+    }
+    batch_timer.Stop();
+    if (batch_timer.GetDeltaSeconds() > array_worst) {
+      array_worst = batch_timer.GetDeltaSeconds();
+    }
+  }
+  total_timer.Stop();
+  float array_total = total_timer.GetDeltaSeconds();
+
+  float chunked_worst = 0.0f;
+  total_timer.Start();
+  for (int i = 0; i < num_elements; i += batch_size) {
+    batch_timer.Start();
+    for (int j = 0; j < batch_size; j++) {
+      chunked.push_back(i + j);
+    }
+    batch_timer.Stop();
+    if (batch_timer.GetDeltaSeconds() > chunked_worst) {
+      chunked_worst = batch_timer.GetDeltaSeconds();
+    }
+  }
+  total_timer.Stop();
+  float chunked_total = total_timer.GetDeltaSeconds();
+
+  int64_t array_sum = 0;
+  int64_t chunked_sum = 0;
+  for (int i = 0; i < array.GetSize(); i++) {
+    array_sum += array[i];
+  }
+  for (int c = 0; c < chunked.GetChunkCount(); c++) {
+    const int* elements = chunked.GetChunk(c);
+    for (int i = 0; i < chunked.GetChunkSize(c); i++) {
+      chunked_sum += elements[i];
+    }
+  }
+  palAssertBreak(array_sum == chunked_sum);
+
+  printf("push_back %d ints in batches of %d\n", num_elements, batch_size);
+  printf("%16s %12s %12s\n", "", "total", "worst batch");
+  printf("%16s %12f %12f\n", "palArray", array_total, array_worst);
+  printf("%16s %12f %12f\n", "palChunkedArray", chunked_total, chunked_worst);
+  return true;
+}
+
+bool palDequeTest() {
+  {
+    palDeque<palChunkedArrayObject> deque;
+    deque.SetAllocator(g_DefaultHeapAllocator);
+    palArray<int> shadow;
+    shadow.SetAllocator(g_DefaultHeapAllocator);
+
+    palSeedRandom(32);
+    for (int i = 0; i < 100000; i++) {
+      int op = palGenerateRandom() % 5;
+      if (op == 0 || deque.IsEmpty()) {
+        palChunkedArrayObject o;
+        o.value = i;
+        deque.PushBack(o);
+        shadow.push_back(i);
+      } else if (op == 1) {
+        palChunkedArrayObject o;
+        o.value = i;
+        deque.PushFront(o);
+        shadow.push_front(i);
+      } else if (op == 2) {
+        palAssertBreak(deque.GetFront().value == shadow[0]);
+        deque.PopFront();
+        shadow.pop_front();
+      } else if (op == 3) {
+        palAssertBreak(deque.GetBack().value == shadow[shadow.GetSize() - 1]);
+        deque.PopBack();
+        shadow.pop_back();
+      } else {
+        int index = palGenerateRandom() % deque.GetSize();
+        palAssertBreak(deque[index].value == shadow[index]);
+      }
+      palAssertBreak(deque.GetSize() == shadow.GetSize());
+      palAssertBreak(palChunkedArrayLiveObjects == deque.GetSize());
+    }
+    for (int i = 0; i < deque.GetSize(); i++) {
+      palAssertBreak(deque[i].value == shadow[i]);
+    }
+
+    // wrap the ring, then grow it
+    deque.Clear();
+    palAssertBreak(palChunkedArrayLiveObjects == 0);
+    int capacity = deque.GetCapacity();
+    palChunkedArrayObject o;
+    for (int i = 0; i < capacity / 2; i++) {
+      o.value = i;
+      deque.PushBack(o);
+    }
+    for (int i = 1; i <= capacity / 2; i++) {
+      o.value = -i;
+      deque.PushFront(o);
+    }
+    o.value = capacity / 2;
+    deque.PushBack(o);
+    palAssertBreak(deque.GetCapacity() == capacity * 2);
+    for (int i = 0; i < deque.GetSize(); i++) {
+      palAssertBreak(deque[i].value == i - capacity / 2);
+    }
+
+    // pushing one of its own elements while it grows
+    while (deque.GetSize() < deque.GetCapacity()) {
+      o.value = deque.GetSize();
+      deque.PushBack(o);
+    }
+    capacity = deque.GetCapacity();
+    int front = deque.GetFront().value;
+    deque.PushBack(deque.GetFront());
+    palAssertBreak(deque.GetCapacity() == capacity * 2 && deque.GetBack().value == front);
+    while (deque.GetSize() < deque.GetCapacity()) {
+      o.value = deque.GetSize();
+      deque.PushBack(o);
+    }
+    int back = deque.GetBack().value;
+    deque.PushFront(deque.GetBack());
+    palAssertBreak(deque.GetCapacity() == capacity * 4 && deque.GetFront().value == back);
+  }
+  palAssertBreak(palChunkedArrayLiveObjects == 0);
+  return true;
+}
+
+struct palDequeWorkItem {
+  int id;
+  int payload[3];
+};
+
+/* A work queue that stays around queue_length items deep */
+bool palDequeBenchmark() {
+  const int num_operations = 4*1024*1024;
+  printf("%8s %12s %12s\n", "length", "palList", "palDeque");
+  for (int queue_length = 16; queue_length <= 64*1024; queue_length *= 16) {
+    palList<palDequeWorkItem> list;
+    palDeque<palDequeWorkItem> deque;
+    list.SetAllocator(g_DefaultHeapAllocator);
+    deque.SetAllocator(g_DefaultHeapAllocator);
+    palDequeWorkItem item;
+    item.payload[0] = item.payload[1] = item.payload[2] = 0;
+    int64_t list_sum = 0;
+    int64_t deque_sum = 0;
+
+    palTimer timer;
+    timer.Start();
+    for (int i = 0; i < queue_length; i++) {
+      item.id = i;
+      list.PushBack(item);
+    }
+    for (int i = queue_length; i < num_operations; i++) {
+      list_sum += list.GetFirst()->data.id;
+      list.PopFront();
+      item.id = i;
+      list.PushBack(item);
+    }
+    timer.Stop();
+    float list_time = timer.GetDeltaSeconds();
+
+    timer.Start();
+    for (int i = 0; i < queue_length; i++) {
+      item.id = i;
+      deque.PushBack(item);
+    }
+    for (int i = queue_length; i < num_operations; i++) {
+      deque_sum += deque.GetFront().id;
+      deque.PopFront();
+      item.id = i;
+      deque.PushBack(item);
+    }
+    timer.Stop();
+    float deque_time = timer.GetDeltaSeconds();
+
+    palAssertBreak(list_sum == deque_sum);
+    printf("%8d %12f %12f\n", queue_length, list_time, deque_time);
+  }
+  return true;
+}
+
+bool palMpmcQueueTest() {
+  palMpmcQueue<int> queue;
+  queue.SetAllocator(g_DefaultHeapAllocator);
+  queue.Create(5);
+  palAssertBreak(queue.GetCapacity() == 8);
+  int value = -1;
+  bool ok = queue.TryPop(&value);
+  palAssertBreak(ok == false);
+  // go around the ring a few times
+  for (int lap = 0; lap < 4; lap++) {
+    for (int i = 0; i < 8; i++) {
+      ok = queue.TryPush(lap * 8 + i);
+      palAssertBreak(ok);
+    }
+    ok = queue.TryPush(-1);
+    palAssertBreak(ok == false);
+    palAssertBreak(queue.GetSize() == 8);
+    for (int i = 0; i < 8; i++) {
+      ok = queue.TryPop(&value);
+      palAssertBreak(ok);
+      palAssertBreak(value == lap * 8 + i);
+    }
+    ok = queue.TryPop(&value);
+    palAssertBreak(ok == false);
+    palAssertBreak(queue.GetSize() == 0);
+  }
+  queue.Push(7);
+  queue.Pop(&value);
+  palAssertBreak(value == 7);
+  queue.Destroy();
+  return true;
+}
+
+/* Today's hand off: a palList behind a palMutex, a semaphore counts the items */
+class palLockedQueue {
+  palList<int> list_;
+  palMutex mutex_;
+  palSemaphore items_;
+public:
+  palLockedQueue() {
+    list_.SetAllocator(g_DefaultHeapAllocator);
+    palMutexDescription mutex_desc;
+    mutex_.Create(mutex_desc);
+    palSemaphoreDescription semaphore_desc;
+    semaphore_desc.name = NULL;
+    semaphore_desc.initial_reservation = 0;
+    semaphore_desc.maximum = 0x7fffffff;
+    items_.Create(semaphore_desc);
+  }
+
+  ~palLockedQueue() {
+    items_.Destroy();
+    mutex_.Destroy();
+  }
+
+  void Push(const int& value) {
+    mutex_.Acquire();
+    list_.PushBack(value);
+    mutex_.Release();
+    items_.Release();
+  }
+
+  void Pop(int* value) {
+    items_.Acquire();
+    mutex_.Acquire();
+    *value = list_.GetFirst()->data;
+    list_.PopFront();
+    mutex_.Release();
+  }
+};
+
+template <typename Queue>
+struct palMpmcQueueWorkload {
+  Queue* queue;
+  int items_per_producer;
+  int items_per_consumer;
+  palAtomicInt64 sum;
+};
+
+template <typename Queue>
+struct palMpmcQueueWorker {
+  palMpmcQueueWorkload<Queue>* workload;
+  int thread_index;
+};
+
+template <typename Queue>
+void palMpmcQueueProducerThread(uintptr_t param) {
+  palMpmcQueueWorker<Queue>* worker = reinterpret_cast<palMpmcQueueWorker<Queue>*>(param);
+  palMpmcQueueWorkload<Queue>* w = worker->workload;
+  int first = worker->thread_index * w->items_per_producer;
+  for (int i = 0; i < w->items_per_producer; i++) {
+    w->queue->Push(first + i);
+  }
+  palThread::Exit(0);
+}
+
+template <typename Queue>
+void palMpmcQueueConsumerThread(uintptr_t param) {
+  palMpmcQueueWorker<Queue>* worker = reinterpret_cast<palMpmcQueueWorker<Queue>*>(param);
+  palMpmcQueueWorkload<Queue>* w = worker->workload;
+  int64_t sum = 0;
+  for (int i = 0; i < w->items_per_consumer; i++) {
+    int value;
+    w->queue->Pop(&value);
+    sum += value;
+  }
+  w->sum.FetchAdd(sum);
+  palThread::Exit(0);
+}
+
+/* num_threads producers and num_threads consumers hand off num_items ints */
+template <typename Queue>
+float palMpmcQueueWorkloadRun(Queue* queue, int num_threads, int num_items) {
+  const int kMaxThreads = 16;
+  palMpmcQueueWorkload<Queue> w;
+  w.queue = queue;
+  w.items_per_producer = num_items / num_threads;
+  w.items_per_consumer = num_items / num_threads;
+  w.sum.Store(0);
+
+  palThread producers[kMaxThreads];
+  palThread consumers[kMaxThreads];
+  palMpmcQueueWorker<Queue> workers[kMaxThreads];
+  palTimer timer;
+  timer.Start();
+  for (int i = 0; i < num_threads; i++) {
+    workers[i].workload = &w;
+    workers[i].thread_index = i;
+    palThreadDescription consumer_desc;
+    consumer_desc.name = "MPMC Queue Consumer";
+    consumer_desc.start_method = palThreadStart(palMpmcQueueConsumerThread<Queue>);
+    consumers[i].Start(consumer_desc, reinterpret_cast<uintptr_t>(&workers[i]));
+    palThreadDescription producer_desc;
+    producer_desc.name = "MPMC Queue Producer";
+    producer_desc.start_method = palThreadStart(palMpmcQueueProducerThread<Queue>);
+    producers[i].Start(producer_desc, reinterpret_cast<uintptr_t>(&workers[i]));
+  }
+  for (int i = 0; i < num_threads; i++) {
+    producers[i].Join(NULL);
+    consumers[i].Join(NULL);
+  }
+  timer.Stop();
+
+  // every item was popped exactly once
+  int64_t n = (int64_t)w.items_per_producer * num_threads;
+  palAssertBreak(w.sum.Load() == n * (n - 1) / 2);
+  return timer.GetDeltaSeconds();
+}
+
+bool palMpmcQueueBenchmark() {
+  const int num_items = 1 << 20;
+  palMpmcQueue<int> queue;
+  queue.SetAllocator(g_DefaultHeapAllocator);
+  queue.Create(1024);
+  palLockedQueue locked;
+
+  printf("%d ints handed from N producers to N consumers\n", num_items);
+  printf("%8s %12s %12s\n", "threads", "mutex+list", "mpmc");
+  for (int num_threads = 1; num_threads <= 16; num_threads *= 2) {
+    float locked_time = palMpmcQueueWorkloadRun(&locked, num_threads, num_items);
+    float mpmc_time = palMpmcQueueWorkloadRun(&queue, num_threads, num_items);
+    palAssertBreak(queue.GetSize() == 0);
+    printf("%8d %12f %12f\n", num_threads, locked_time, mpmc_time);
+  }
+  queue.Destroy();
+  return true;
+}
+
+/* structure of arrays */
+struct palSoATestParticle {
+  float position[3];
+  float velocity[3];
+  float color[4];
+  float size;
+  float life;
+  uint32_t flags;
+  uint32_t id;
+};
+
+// x, vx, life, id
+typedef palSoA<float, float, float, uint32_t> palSoATestParticles;
+
+static bool palSoATestColumnsAligned(palSoATestParticles& particles) {
+  return ((uintptr_t)particles.GetColumn<0>() & 31) == 0 &&
+         ((uintptr_t)particles.GetColumn<1>() & 31) == 0 &&
+         ((uintptr_t)particles.GetColumn<2>() & 31) == 0 &&
+         ((uintptr_t)particles.GetColumn<3>() & 31) == 0;
+}
+
+bool palSoATest() {
+  palSoATestParticles particles;
+  particles.SetAllocator(g_DefaultHeapAllocator);
+  palAssertBreak(particles.IsEmpty());
+
+  for (uint32_t i = 0; i < 1000; i++) {
+    int index = particles.push_back((float)i, (float)i * 2.0f, 1.0f, i);
+    palAssertBreak(index == (int)i);
+    palAssertBreak(palSoATestColumnsAligned(particles));
+  }
+  palAssertBreak(particles.GetSize() == 1000);
+  palAssertBreak(particles.GetCapacity() >= 1000);
+  palAssertBreak(particles.GetPaddedSize<0>() == 1000);
+  particles.pop_back();
+  palAssertBreak(particles.GetPaddedSize<0>() == 1000);
+  palAssertBreak(particles.GetSize() == 999);
+
+  // every column of an element moves together
+  particles.Erase(0);
+  palAssertBreak(particles.Get<3>(0) == 998);
+  particles.EraseStable(1);
+  palAssertBreak(particles.GetSize() == 997);
+  for (int i = 0; i < particles.GetSize(); i++) {
+    uint32_t id = particles.Get<3>(i);
+    palAssertBreak(particles.Get<0>(i) == (float)id);
+    palAssertBreak(particles.Get<1>(i) == (float)id * 2.0f);
+    palAssertBreak(i < 2 || id == (uint32_t)i + 1);
+  }
+  particles.Swap(0, 1);
+  palAssertBreak(particles.Get<3>(0) == 2 && particles.Get<0>(0) == 2.0f);
+
+  palTypeBlob<float> life = particles.GetColumnSpan<2>();
+  palAssertBreak(life.elements == particles.GetColumn<2>() && life.size == 997);
+
+  particles.Reserve(5000);
+  palAssertBreak(palSoATestColumnsAligned(particles));
+  palAssertBreak(particles.Get<3>(0) == 2 && particles.Get<3>(996) == 997);
+
+  particles.Clear();
+  palAssertBreak(particles.IsEmpty());
+  particles.Reset();
+  palAssertBreak(particles.GetCapacity() == 0);
+
+  // one byte fields are padded to whole vectors too
+  palSoA<uint8_t, double> mixed;
+  mixed.SetAllocator(g_DefaultHeapAllocator);
+  mixed.push_back(1, 1.0);
+  palAssertBreak(mixed.GetPaddedSize<0>() == 32);
+  palAssertBreak(mixed.GetPaddedSize<1>() == 4);
+  palAssertBreak(((uintptr_t)mixed.GetColumn<1>() & 31) == 0);
+  return true;
+}
+
+/* Updates two fields of every particle */
+bool palSoABenchmark() {
+  const int num_particles = 1024*1024;
+  const float dt = 1.0f / 60.0f;
+  palArray<palSoATestParticle> aos;
+  palSoATestParticles soa;
+  aos.SetAllocator(g_DefaultHeapAllocator);
+  soa.SetAllocator(g_DefaultHeapAllocator);
+  palSoATestParticle particle;
+  palMemoryZeroBytes(&particle, sizeof(particle));
+  for (int i = 0; i < num_particles; i++) {
+    particle.position[0] = (float)i;
+    particle.velocity[0] = 1.0f;
+    particle.life = 100.0f;
+    particle.id = i;
+    aos.push_back(particle);
+    soa.push_back(particle.position[0], particle.velocity[0], particle.life, particle.id);
+  }
+
+  palTimer timer;
+  timer.Start();
+  for (int frame = 0; frame < 10; frame++) {
+    for (int i = 0; i < num_particles; i++) {
+      aos[i].position[0] += aos[i].velocity[0] * dt;
+      aos[i].life -= dt;
+    }
+  }
+  timer.Stop();
+  float aos_time = timer.GetDeltaSeconds();
+
+  timer.Start();
+  palSimd simd_dt = palSimdSplat(dt);
+  for (int frame = 0; frame < 10; frame++) {
+    float* x = soa.GetColumn<0>();
+    const float* vx = soa.GetColumn<1>();
+    float* life = soa.GetColumn<2>();
+    int padded = soa.GetPaddedSize<0>();
+    for (int i = 0; i < padded; i += 4) {
+      palSimdStoreAligned(palSimdAdd(palSimdLoadAligned(x + i), palSimdMul(palSimdLoadAligned(vx + i), simd_dt)), x + i);
+      palSimdStoreAligned(palSimdSub(palSimdLoadAligned(life + i), simd_dt), life + i);
+    }
+  }
+  timer.Stop();
+  float soa_time = timer.GetDeltaSeconds();
+
+  for (int i = 0; i < num_particles; i += 4099) {
+    palAssertBreak(aos[i].position[0] == soa.Get<0>(i));
+    palAssertBreak(aos[i].life == soa.Get<2>(i));
+  }
+  printf("%d particles %12s %12s\n", num_particles, "palArray", "palSoA");
+  printf("%21s %12f %12f\n", "", aos_time, soa_time);
+  return true;
+}
+
 bool palHashMapTest3() {
   palHashMap<const char*, int> intMap;
   intMap.SetAllocator(g_DefaultHeapAllocator);
@@ -504,6 +1067,182 @@ bool palMinHeapTest() {
   return true;
 }
 
+bool palIndexedHeapTest() {
+  const int num_handles = 512;
+  palIndexedHeap<int> heap;
+  heap.SetAllocator(g_DefaultHeapAllocator);
+
+  // shadow copy of what each handle should hold
+  int values[num_handles];
+  bool alive[num_handles];
+  palIndexedHeapHandle handles[num_handles];
+  for (int i = 0; i < num_handles; i++) {
+    alive[i] = false;
+    handles[i] = kPalIndexedHeapInvalidHandle;
+  }
+
+  palSeedRandom(17);
+  for (int step = 0; step < 20000; step++) {
+    int i = palGenerateRandom() % num_handles;
+    int value = (int)(palGenerateRandom() % 10000) - 5000;
+    if (!alive[i]) {
+      handles[i] = heap.Insert(value);
+      values[i] = value;
+      alive[i] = true;
+    } else {
+      switch (palGenerateRandom() % 4) {
+      case 0:
+        heap.Remove(handles[i]);
+        palAssertBreak(!heap.IsValidHandle(handles[i]));
+        alive[i] = false;
+        break;
+      case 1:
+        value = palMin(value, values[i]);
+        heap.DecreaseKey(handles[i], value);
+        values[i] = value;
+        break;
+      case 2:
+        value = palMax(value, values[i]);
+        heap.IncreaseKey(handles[i], value);
+        values[i] = value;
+        break;
+      default:
+        heap.Update(handles[i], value);
+        values[i] = value;
+        break;
+      }
+    }
+
+    if (heap.IsEmpty()) {
+      continue;
+    }
+    int expected_min = 0x7fffffff;
+    for (int j = 0; j < num_handles; j++) {
+      if (alive[j]) {
+        palAssertBreak(heap.Get(handles[j]) == values[j]);
+        expected_min = palMin(expected_min, values[j]);
+      }
+    }
+    palAssertBreak(heap.FindMin() == expected_min);
+    palAssertBreak(heap.Get(heap.FindMinHandle()) == expected_min);
+  }
+
+  int previous = -0x7fffffff;
+  while (!heap.IsEmpty()) {
+    palIndexedHeapHandle handle = heap.FindMinHandle();
+    palAssertBreak(heap.Get(handle) == heap.FindMin());
+    palAssertBreak(previous <= heap.FindMin());
+    previous = heap.FindMin();
+    heap.DeleteMin();
+    palAssertBreak(!heap.IsValidHandle(handle));
+  }
+  return true;
+}
+
+struct palTimerQueueEntry {
+  uint64_t deadline;
+  int timer;
+  int generation;
+};
+
+bool operator<(const palTimerQueueEntry& a, const palTimerQueueEntry& b) {
+  // ties broken by timer so every queue fires timers in the same order
+  if (a.deadline != b.deadline) {
+    return a.deadline < b.deadline;
+  }
+  return a.timer < b.timer;
+}
+
+/* A timer wheel workload: timers fire and rearm, and half of all operations
+ * reschedule a pending timer. palMinHeap has no way to move an element, so it
+ * inserts a new entry and skips stale ones when they reach the top.
+ */
+template <typename IndexedHeap>
+float palTimerQueueIndexedRun(int num_timers, int num_operations, uint64_t* checksum) {
+  IndexedHeap heap;
+  heap.SetAllocator(g_DefaultHeapAllocator);
+  palIndexedHeapHandle* handles = (palIndexedHeapHandle*)g_DefaultHeapAllocator->Allocate(sizeof(palIndexedHeapHandle)*num_timers);
+  palSeedRandom(21);
+  for (int i = 0; i < num_timers; i++) {
+    palTimerQueueEntry entry = { palGenerateRandom() % 100000, i, 0 };
+    handles[i] = heap.Insert(entry);
+  }
+
+  palTimer timer;
+  timer.Start();
+  uint64_t now = 0;
+  for (int op = 0; op < num_operations; op++) {
+    if (op & 1) {
+      int t = palGenerateRandom() % num_timers;
+      palTimerQueueEntry entry = { now + palGenerateRandom() % 100000, t, 0 };
+      heap.Update(handles[t], entry);
+    } else {
+      palTimerQueueEntry entry = heap.FindMin();
+      now = entry.deadline;
+      *checksum += now;
+      entry.deadline = now + 1 + palGenerateRandom() % 100000;
+      heap.IncreaseKey(heap.FindMinHandle(), entry);
+    }
+  }
+  timer.Stop();
+  g_DefaultHeapAllocator->Deallocate(handles);
+  return timer.GetDeltaSeconds();
+}
+
+float palTimerQueueMinHeapRun(int num_timers, int num_operations, uint64_t* checksum) {
+  palMinHeap<palTimerQueueEntry> heap;
+  heap.SetAllocator(g_DefaultHeapAllocator);
+  int* generations = (int*)g_DefaultHeapAllocator->Allocate(sizeof(int)*num_timers);
+  palSeedRandom(21);
+  for (int i = 0; i < num_timers; i++) {
+    palTimerQueueEntry entry = { palGenerateRandom() % 100000, i, 0 };
+    generations[i] = 0;
+    heap.Insert(entry);
+  }
+
+  palTimer timer;
+  timer.Start();
+  uint64_t now = 0;
+  for (int op = 0; op < num_operations; op++) {
+    if (op & 1) {
+      int t = palGenerateRandom() % num_timers;
+      palTimerQueueEntry entry = { now + palGenerateRandom() % 100000, t, ++generations[t] };
+      heap.Insert(entry);
+    } else {
+      // discard entries that were superseded by a reschedule
+      while (heap.FindMin().generation != generations[heap.FindMin().timer]) {
+        heap.DeleteMin();
+      }
+      palTimerQueueEntry entry = heap.FindMin();
+      heap.DeleteMin();
+      now = entry.deadline;
+      *checksum += now;
+      entry.deadline = now + 1 + palGenerateRandom() % 100000;
+      entry.generation = ++generations[entry.timer];
+      heap.Insert(entry);
+    }
+  }
+  timer.Stop();
+  g_DefaultHeapAllocator->Deallocate(generations);
+  return timer.GetDeltaSeconds();
+}
+
+bool palIndexedHeapBenchmark() {
+  const int num_operations = 2*1024*1024;
+  printf("%8s %12s %12s %12s %12s\n", "timers", "palMinHeap", "indexed d=2", "indexed d=4", "indexed d=8");
+  for (int num_timers = 1024; num_timers <= 1024*1024; num_timers *= 8) {
+    uint64_t c0 = 0, c2 = 0, c4 = 0, c8 = 0;
+    float min_heap = palTimerQueueMinHeapRun(num_timers, num_operations, &c0);
+    float d2 = palTimerQueueIndexedRun<palIndexedHeap<palTimerQueueEntry, palCompareFuncLessThan<palTimerQueueEntry>, 2> >(num_timers, num_operations, &c2);
+    float d4 = palTimerQueueIndexedRun<palIndexedHeap<palTimerQueueEntry, palCompareFuncLessThan<palTimerQueueEntry>, 4> >(num_timers, num_operations, &c4);
+    float d8 = palTimerQueueIndexedRun<palIndexedHeap<palTimerQueueEntry, palCompareFuncLessThan<palTimerQueueEntry>, 8> >(num_timers, num_operations, &c8);
+    // every variant fires the same timers at the same times
+    palAssertBreak(c0 == c2 && c2 == c4 && c4 == c8);
+    printf("%8d %12f %12f %12f %12f\n", num_timers, min_heap, d2, d4, d8);
+  }
+  return true;
+}
+
 void dumpListForward (const palList<int>& l)
 {
   palListNode<int>* current;
@@ -695,6 +1434,151 @@ bool palIListSortTest() {
   return true;
 }
 
+/* intrusive hash map */
+struct palIHashMapTestObject {
+  uint32_t key;
+  int payload;
+  palIHashMapNodeDeclare(palIHashMapTestObject, by_key);
+};
+
+struct palIHashMapTestObjectKey {
+  const uint32_t& operator()(const palIHashMapTestObject* object) const {
+    return object->key;
+  }
+};
+
+typedef palIHashMapDeclare(uint32_t, palIHashMapTestObject, by_key, palIHashMapTestObjectKey) palIHashMapTestMap;
+
+static void palIHashMapTestCheck(const palIHashMapTestMap& map, const palHashMap<uint32_t, int>& reference, palIHashMapTestObject* objects) {
+  palAssertBreak(map.GetSize() == reference.GetSize());
+  for (int i = 0; i < reference.GetSize(); i++) {
+    uint32_t key = *reference.GetKeyAtIndex(i);
+    palIHashMapTestObject* object = map.Find(key);
+    palAssertBreak(object == &objects[*reference.GetValueAtIndex(i)]);
+    palAssertBreak(palIHashMapTestMap::IsInserted(object));
+  }
+  int iterated = 0;
+  for (palIHashMapTestObject* object = map.GetFirst(); object != NULL; object = map.GetNext(object)) {
+    palAssertBreak(reference.Find(object->key) != NULL);
+    iterated++;
+  }
+  palAssertBreak(iterated == map.GetSize());
+}
+
+bool palIHashMapTest() {
+  const int num_objects = 4096;
+  palIHashMapTestObject* objects = new palIHashMapTestObject[num_objects];
+  palIHashMapTestMap map;
+  palHashMap<uint32_t, int> reference;
+  map.SetAllocator(g_DefaultHeapAllocator);
+  reference.SetAllocator(g_DefaultHeapAllocator);
+  for (int i = 0; i < num_objects; i++) {
+    objects[i].key = palGenerateRandom() % (num_objects * 2);
+    objects[i].payload = i;
+  }
+
+  palAssertBreak(map.Find(1) == NULL);
+  palAssertBreak(map.GetFirst() == NULL);
+
+  bool seen_growing = false;
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 20000; i++) {
+      int index = palGenerateRandom() % num_objects;
+      palIHashMapTestObject* object = &objects[index];
+      if (palIHashMapTestMap::IsInserted(object)) {
+        if (palGenerateRandom() & 1) {
+          map.Remove(object);
+        } else {
+          palIHashMapTestObject* removed = map.Remove(object->key);
+          palAssertBreak(removed == object);
+        }
+        reference.Remove(object->key);
+        palAssertBreak(map.Find(object->key) == NULL);
+      } else {
+        bool duplicate = reference.Find(object->key) != NULL;
+        bool inserted = map.Insert(object);
+        palAssertBreak(inserted == !duplicate);
+        palAssertBreak(palIHashMapTestMap::IsInserted(object) == !duplicate);
+        if (!duplicate) {
+          reference.Insert(object->key, index);
+        }
+      }
+      seen_growing = seen_growing || map.IsGrowing();
+      if ((i & 1023) == 0) {
+        palIHashMapTestCheck(map, reference, objects);
+      }
+    }
+    palIHashMapTestCheck(map, reference, objects);
+    palAssertBreak(map.LoadFactor() <= 1.0f);
+    if (round == 1) {
+      map.Reserve(map.GetSize() * 4);
+      palAssertBreak(map.IsGrowing() == false);
+      palIHashMapTestCheck(map, reference, objects);
+    }
+  }
+  palAssertBreak(seen_growing);
+
+  map.Clear();
+  reference.Clear();
+  for (int i = 0; i < num_objects; i++) {
+    palAssertBreak(palIHashMapTestMap::IsInserted(&objects[i]) == false);
+  }
+  palIHashMapTestCheck(map, reference, objects);
+  map.Reset();
+  delete [] objects;
+  return true;
+}
+
+bool palIHashMapBenchmark() {
+  const int num_objects = 1024*1024;
+  palIHashMapTestObject* objects = new palIHashMapTestObject[num_objects];
+  for (int i = 0; i < num_objects; i++) {
+    objects[i].key = (uint32_t)i * 2654435761u;
+    objects[i].payload = i;
+  }
+  palIHashMapTestMap map;
+  palHashMap<uint32_t, palIHashMapTestObject*> hash_map;
+  map.SetAllocator(g_DefaultHeapAllocator);
+  hash_map.SetAllocator(g_DefaultHeapAllocator);
+  int64_t map_sum = 0;
+  int64_t hash_map_sum = 0;
+
+  palTimer timer;
+  timer.Start();
+  for (int i = 0; i < num_objects; i++) {
+    hash_map.Insert(objects[i].key, &objects[i]);
+  }
+  timer.Stop();
+  float hash_map_insert = timer.GetDeltaSeconds();
+  timer.Start();
+  for (int i = 0; i < num_objects; i++) {
+    hash_map_sum += (*hash_map.Find(objects[((uint32_t)i * 7919) & (num_objects - 1)].key))->payload;
+  }
+  timer.Stop();
+  float hash_map_find = timer.GetDeltaSeconds();
+
+  timer.Start();
+  for (int i = 0; i < num_objects; i++) {
+    map.Insert(&objects[i]);
+  }
+  timer.Stop();
+  float map_insert = timer.GetDeltaSeconds();
+  timer.Start();
+  for (int i = 0; i < num_objects; i++) {
+    map_sum += map.Find(objects[((uint32_t)i * 7919) & (num_objects - 1)].key)->payload;
+  }
+  timer.Stop();
+  float map_find = timer.GetDeltaSeconds();
+
+  palAssertBreak(map_sum == hash_map_sum);
+  printf("%d objects %12s %12s\n", num_objects, "insert", "find");
+  printf("%-20s %12f %12f\n", "palHashMap", hash_map_insert, hash_map_find);
+  printf("%-20s %12f %12f\n", "palIHashMap", map_insert, map_find);
+  map.Clear();
+  delete [] objects;
+  return true;
+}
+
 bool palListTest()
 {
   palList<int> il;
@@ -785,13 +1669,25 @@ bool PalContainerTest() {
   
   palArrayTest();
   palArrayTest2();
+  palChunkedArrayTest();
+  palChunkedArrayBenchmark();
+  palDequeTest();
+  palDequeBenchmark();
+  palMpmcQueueTest();
+  palMpmcQueueBenchmark();
+  palSoATest();
+  palSoABenchmark();
   palHashMapTest();
   palListTest();
   palListSortTest();
   palIListTest();
   palListSortBenchmark();
   palIListSortTest();
+  palIHashMapTest();
+  palIHashMapBenchmark();
   palMinHeapTest();
+  palIndexedHeapTest();
+  palIndexedHeapBenchmark();
   palPalHashMapCacheTest();
   
   //palHashMapTest3();
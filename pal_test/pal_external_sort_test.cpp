@@ -0,0 +1,238 @@
+#include <cstdio>
+#include "libpal/libpal.h"
+#include "libpal/pal_memory_stream.h"
+#include "pal_external_sort_test.h"
+
+struct palExternalSortTestRecord {
+  uint32_t key;
+  uint32_t index;
+};
+
+class palExternalSortTestRecordLessThan {
+public:
+  bool operator()(const palExternalSortTestRecord& a, const palExternalSortTestRecord& b) {
+    return a.key < b.key;
+  }
+};
+
+typedef palExternalSort<palExternalSortTestRecord, palExternalSortTestRecordLessThan> palExternalSortTestSorter;
+
+/* A memory stream whose reads or writes fail once the allowance runs out */
+class palExternalSortTestFailingStream : public palMemoryStream {
+public:
+  int reads_left;
+  int writes_left;
+
+  palExternalSortTestFailingStream() : reads_left(-1), writes_left(-1) {
+  }
+
+  virtual int Read(void* buffer, uint64_t buffer_offset, uint64_t count_bytes, uint64_t* bytes_read) {
+    if (reads_left == 0) {
+      *bytes_read = 0;
+      return PAL_STREAM_ERROR_CANT_READ;
+    }
+    reads_left--;
+    return palMemoryStream::Read(buffer, buffer_offset, count_bytes, bytes_read);
+  }
+
+  virtual int Write(const void* buffer, uint64_t buffer_offset, uint64_t count_bytes, uint64_t* bytes_written) {
+    if (writes_left == 0) {
+      *bytes_written = 0;
+      return PAL_STREAM_ERROR_CANT_WRITE;
+    }
+    writes_left--;
+    return palMemoryStream::Write(buffer, buffer_offset, count_bytes, bytes_written);
+  }
+};
+
+/* Writes two runs of 64 records itself and merges them, with the second
+   run claiming claimed_records. More than 64 looks like a run file that
+   was cut short on disk. */
+class palExternalSortTestTruncatedRunSorter : public palExternalSortTestSorter {
+public:
+  int MergeRuns(palStreamInterface* output, bool overlap_io, uint64_t claimed_records, uint64_t buffer_records) {
+    desc_.temp_file_prefix = "pal_external_sort_truncated";
+    result_ = 0;
+    next_run_name_ = 0;
+    int r = io_.Create(allocator_, overlap_io);
+    if (r != 0) {
+      return r;
+    }
+    palExternalSortTestRecord records[64];
+    for (int i = 0; i < 64; i++) {
+      records[i].key = i;
+      records[i].index = i;
+    }
+    for (int i = 0; i < 2; i++) {
+      Run* run = CreateRun();
+      run->file.OffsetWrite(0, records, sizeof(records));
+      run->records = 64;
+      runs_.push_back(run);
+    }
+    runs_[1]->records = claimed_records;
+
+    palExternalSortTestRecord* memory = static_cast<palExternalSortTestRecord*>(allocator_->Allocate((size_t)(6 * buffer_records * sizeof(palExternalSortTestRecord))));
+    palExternalSortTestSorter::MergeRuns(0, 2, NULL, output, memory, buffer_records);
+    io_.Destroy();
+    for (int i = 0; i < runs_.GetSize(); i++) {
+      DestroyRun(runs_[i]);
+    }
+    runs_.Reset();
+    DeleteRunFiles();
+    allocator_->Deallocate(memory);
+    return result_;
+  }
+};
+
+/* Sorts num_records random records and checks the output is an ordered
+   permutation of the input */
+static float palExternalSortTestRun(int num_records, uint64_t memory_budget, uint32_t io_buffer_size, bool overlap_io, int* run_count) {
+  const uint64_t bytes = (uint64_t)num_records * sizeof(palExternalSortTestRecord);
+  palExternalSortTestRecord* input = static_cast<palExternalSortTestRecord*>(g_DefaultHeapAllocator->Allocate(bytes));
+  palExternalSortTestRecord* output = static_cast<palExternalSortTestRecord*>(g_DefaultHeapAllocator->Allocate(bytes));
+  unsigned char* seen = static_cast<unsigned char*>(g_DefaultHeapAllocator->Allocate(num_records));
+  for (int i = 0; i < num_records; i++) {
+    input[i].key = palGenerateRandom() % (num_records * 4 + 1);
+    input[i].index = i;
+    seen[i] = 0;
+  }
+
+  palMemoryStream input_stream;
+  palMemoryStream output_stream;
+  input_stream.Create(palMemBlob(input, bytes), false);
+  output_stream.Create(palMemBlob(output, bytes), true);
+
+  palExternalSortDescription desc;
+  desc.memory_budget = memory_budget;
+  desc.io_buffer_size = io_buffer_size;
+  desc.temp_file_prefix = "pal_external_sort_test";
+  desc.overlap_io = overlap_io;
+  palExternalSortTestSorter sorter;
+  sorter.SetAllocator(g_DefaultHeapAllocator);
+
+  palTimer timer;
+  timer.Start();
+  int r = sorter.Sort(desc, &input_stream, &output_stream);
+  timer.Stop();
+  palAssertBreak(r == 0);
+  palAssertBreak(output_stream.GetPosition() == bytes);
+  *run_count = sorter.GetRunCount();
+
+  for (int i = 0; i < num_records; i++) {
+    palAssertBreak(i == 0 || output[i-1].key <= output[i].key);
+    palAssertBreak(input[output[i].index].key == output[i].key);
+    palAssertBreak(seen[output[i].index] == 0);
+    seen[output[i].index] = 1;
+  }
+
+  g_DefaultHeapAllocator->Deallocate(seen);
+  g_DefaultHeapAllocator->Deallocate(output);
+  g_DefaultHeapAllocator->Deallocate(input);
+  return timer.GetDeltaSeconds();
+}
+
+bool palExternalSortTest() {
+  int runs;
+  palSeedRandom(35);
+  for (int overlap = 0; overlap < 2; overlap++) {
+    // fits in memory, no run files
+    palExternalSortTestRun(1000, 64*1024, 1024, overlap != 0, &runs);
+    palAssertBreak(runs == 0);
+    // empty input
+    palExternalSortTestRun(0, 64*1024, 1024, overlap != 0, &runs);
+    palAssertBreak(runs == 0);
+    // one merge
+    palExternalSortTestRun(20000, 64*1024, 4096, overlap != 0, &runs);
+    palAssertBreak(runs == 5);
+    // more runs than the merge fan in, so runs are merged into longer runs first
+    palExternalSortTestRun(200000, 64*1024, 4096, overlap != 0, &runs);
+    palAssertBreak(runs > 49);
+  }
+  // a record must not be split over the end of the input
+  {
+    unsigned char bytes[20];
+    unsigned char output[20];
+    palMemoryStream input_stream;
+    palMemoryStream output_stream;
+    input_stream.Create(palMemBlob(bytes, sizeof(bytes)), false);
+    output_stream.Create(palMemBlob(output, sizeof(output)), true);
+    palExternalSortDescription desc;
+    desc.memory_budget = 64*1024;
+    desc.io_buffer_size = 1024;
+    palExternalSortTestSorter sorter;
+    sorter.SetAllocator(g_DefaultHeapAllocator);
+    int r = sorter.Sort(desc, &input_stream, &output_stream);
+    palAssertBreak(r == PAL_EXTERNAL_SORT_ERROR_PARTIAL_RECORD);
+  }
+  // failing input and output streams are reported, not taken for the end
+  for (int overlap = 0; overlap < 2; overlap++) {
+    const int num_records = 20000;
+    const uint64_t bytes = num_records * sizeof(palExternalSortTestRecord);
+    palExternalSortTestRecord* input = static_cast<palExternalSortTestRecord*>(g_DefaultHeapAllocator->Allocate(bytes));
+    palExternalSortTestRecord* output = static_cast<palExternalSortTestRecord*>(g_DefaultHeapAllocator->Allocate(bytes));
+    for (int i = 0; i < num_records; i++) {
+      input[i].key = palGenerateRandom();
+      input[i].index = i;
+    }
+    palExternalSortDescription desc;
+    desc.memory_budget = 64*1024;
+    desc.io_buffer_size = 4096;
+    desc.temp_file_prefix = "pal_external_sort_test";
+    desc.overlap_io = overlap != 0;
+    for (int fail_write = 0; fail_write < 2; fail_write++) {
+      palExternalSortTestFailingStream input_stream;
+      palExternalSortTestFailingStream output_stream;
+      input_stream.Create(palMemBlob(input, bytes), false);
+      output_stream.Create(palMemBlob(output, bytes), true);
+      if (fail_write) {
+        output_stream.writes_left = 3;
+      } else {
+        input_stream.reads_left = 2;
+      }
+      palExternalSortTestSorter sorter;
+      sorter.SetAllocator(g_DefaultHeapAllocator);
+      int r = sorter.Sort(desc, &input_stream, &output_stream);
+      palAssertBreak(r == (fail_write ? PAL_EXTERNAL_SORT_ERROR_WRITE : PAL_EXTERNAL_SORT_ERROR_READ));
+    }
+    g_DefaultHeapAllocator->Deallocate(output);
+    g_DefaultHeapAllocator->Deallocate(input);
+  }
+  // a run file shorter than its record count fails the sort instead of
+  // dropping the rest of the run, whether the read returns nothing or a
+  // whole number of records short of what was asked
+  for (int overlap = 0; overlap < 2; overlap++) {
+    palExternalSortTestRecord output[256];
+    const uint64_t claimed[3] = { 64, 65, 72 };
+    const uint64_t buffer_records[3] = { 16, 16, 24 };
+    for (int i = 0; i < 3; i++) {
+      palMemoryStream output_stream;
+      output_stream.Create(palMemBlob(output, sizeof(output)), true);
+      palExternalSortTestTruncatedRunSorter sorter;
+      sorter.SetAllocator(g_DefaultHeapAllocator);
+      int r = sorter.MergeRuns(&output_stream, overlap != 0, claimed[i], buffer_records[i]);
+      if (i == 0) {
+        palAssertBreak(r == 0 && output_stream.GetPosition() == 128 * sizeof(palExternalSortTestRecord));
+      } else {
+        palAssertBreak(r == PAL_EXTERNAL_SORT_ERROR_READ);
+      }
+    }
+  }
+  return true;
+}
+
+bool palExternalSortBenchmark() {
+  const int num_records = 4*1024*1024;
+  int runs = 0;
+  printf("Sorting %d records (%d MB) with a 4 MB budget\n", num_records, (int)(num_records * sizeof(palExternalSortTestRecord) >> 20));
+  for (int overlap = 0; overlap < 2; overlap++) {
+    float t = palExternalSortTestRun(num_records, 4*1024*1024, 128*1024, overlap != 0, &runs);
+    printf("%-12s %d runs %f seconds\n", overlap ? "overlapped" : "synchronous", runs, t);
+  }
+  return true;
+}
+
+bool PalExternalSortTest() {
+  palExternalSortTest();
+  palExternalSortBenchmark();
+  return true;
+}
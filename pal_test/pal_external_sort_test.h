@@ -0,0 +1,6 @@
+#ifndef PAL_TEST_PAL_EXTERNAL_SORT_TEST_H_
+#define PAL_TEST_PAL_EXTERNAL_SORT_TEST_H_
+
+bool PalExternalSortTest();
+
+#endif  // PAL_TEST_PAL_EXTERNAL_SORT_TEST_H_
@@ -0,0 +1,219 @@
+#include <cstdio>
+#include "libpal/libpal.h"
+#include "pal_filter_test.h"
+
+// keys are i for inserted and i + kPalFilterTestMissOffset for never inserted
+#define kPalFilterTestMissOffset ((uint64_t)0x100000000ULL)
+
+static uint64_t palFilterTestHash(uint64_t key) {
+  palHashFunction<uint64_t> hash_function;
+  return hash_function(key);
+}
+
+bool palBloomFilterTest() {
+  const int num_keys = 100000;
+  const int num_misses = 1000000;
+  const double rates[] = { 0.1, 0.01, 0.001 };
+  for (int r = 0; r < 3; r++) {
+    palBloomFilter filter;
+    filter.SetAllocator(g_DefaultHeapAllocator);
+    int result = filter.Create(num_keys, rates[r]);
+    palAssertBreak(result == 0);
+    palAssertBreak(filter.GetFalsePositiveRate(num_keys) <= rates[r]);
+    for (uint64_t i = 0; i < num_keys; i++) {
+      filter.Insert(i);
+    }
+    for (uint64_t i = 0; i < num_keys; i++) {
+      palAssertBreak(filter.Contains(i));
+    }
+    int false_positives = 0;
+    for (uint64_t i = 0; i < num_misses; i++) {
+      false_positives += filter.ContainsHash(palFilterTestHash(i + kPalFilterTestMissOffset)) ? 1 : 0;
+    }
+    double measured = (double)false_positives / num_misses;
+    printf("palBloomFilter target %f measured %f, %d bytes\n", rates[r], measured, (int)filter.GetSizeInBytes());
+    palAssertBreak(measured < rates[r] * 1.25);
+
+    // serialize and load into a second filter
+    palBloomFilter loaded;
+    loaded.SetAllocator(g_DefaultHeapAllocator);
+    void* memory = g_DefaultHeapAllocator->Allocate(filter.GetSerializedSize());
+    palMemBlob blob(memory, filter.GetSerializedSize());
+    palMemBlob small(memory, filter.GetSerializedSize() - 1);
+    result = filter.Serialize(&small);
+    palAssertBreak(result == PAL_MEM_BLOB_NO_ROOM);
+    result = filter.Serialize(&blob);
+    palAssertBreak(result == 0);
+    result = loaded.Deserialize(small);
+    palAssertBreak(result == PAL_BLOOM_FILTER_ERROR_INVALID_BLOB);
+    result = loaded.Deserialize(blob);
+    palAssertBreak(result == 0);
+    palAssertBreak(loaded.GetBlockCount() == filter.GetBlockCount());
+    for (uint64_t i = 0; i < num_keys; i++) {
+      palAssertBreak(loaded.Contains(i));
+      palAssertBreak(loaded.Contains(i + kPalFilterTestMissOffset) == filter.Contains(i + kPalFilterTestMissOffset));
+    }
+    *blob.GetPtr<uint32_t>() = 0;
+    result = loaded.Deserialize(blob);
+    palAssertBreak(result == PAL_BLOOM_FILTER_ERROR_INVALID_BLOB);
+    g_DefaultHeapAllocator->Deallocate(memory);
+
+    filter.Clear();
+    palAssertBreak(filter.Contains((uint64_t)0) == false);
+  }
+  return true;
+}
+
+bool palCuckooFilterTest() {
+  const int num_keys = 100000;
+  const int num_misses = 1000000;
+  const double rates[] = { 0.01, 0.001, 0.0005 };
+  for (int r = 0; r < 3; r++) {
+    palCuckooFilter filter;
+    filter.SetAllocator(g_DefaultHeapAllocator);
+    int result = filter.Create(num_keys, rates[r]);
+    palAssertBreak(result == 0);
+    palAssertBreak(filter.GetFalsePositiveRate() <= rates[r]);
+    for (uint64_t i = 0; i < num_keys; i++) {
+      bool inserted = filter.Insert(i);
+      palAssertBreak(inserted);
+    }
+    palAssertBreak(filter.GetCount() == num_keys);
+    for (uint64_t i = 0; i < num_keys; i++) {
+      palAssertBreak(filter.Contains(i));
+    }
+    int false_positives = 0;
+    for (uint64_t i = 0; i < num_misses; i++) {
+      false_positives += filter.ContainsHash(palFilterTestHash(i + kPalFilterTestMissOffset)) ? 1 : 0;
+    }
+    double measured = (double)false_positives / num_misses;
+    printf("palCuckooFilter target %f measured %f, %d fingerprint bits, load %f, %d bytes\n", rates[r], measured,
+           filter.GetFingerprintBits(), filter.LoadFactor(), (int)filter.GetSizeInBytes());
+    palAssertBreak(measured < rates[r] * 1.25);
+
+    // remove the even keys
+    for (uint64_t i = 0; i < num_keys; i += 2) {
+      bool removed = filter.Remove(i);
+      palAssertBreak(removed);
+    }
+    palAssertBreak(filter.GetCount() == num_keys / 2);
+    int removed_found = 0;
+    for (uint64_t i = 0; i < num_keys; i++) {
+      if (i & 1) {
+        palAssertBreak(filter.Contains(i));
+      } else {
+        removed_found += filter.Contains(i) ? 1 : 0;
+      }
+    }
+    palAssertBreak(removed_found < num_keys * rates[r]);
+
+    // serialize and load into a second filter
+    palCuckooFilter loaded;
+    loaded.SetAllocator(g_DefaultHeapAllocator);
+    void* memory = g_DefaultHeapAllocator->Allocate(filter.GetSerializedSize());
+    palMemBlob blob(memory, filter.GetSerializedSize());
+    palMemBlob small(memory, filter.GetSerializedSize() - 1);
+    result = filter.Serialize(&small);
+    palAssertBreak(result == PAL_MEM_BLOB_NO_ROOM);
+    result = filter.Serialize(&blob);
+    palAssertBreak(result == 0);
+    result = loaded.Deserialize(small);
+    palAssertBreak(result == PAL_CUCKOO_FILTER_ERROR_INVALID_BLOB);
+    result = loaded.Deserialize(blob);
+    palAssertBreak(result == 0);
+    palAssertBreak(loaded.GetCount() == filter.GetCount());
+    for (uint64_t i = 1; i < num_keys; i += 2) {
+      palAssertBreak(loaded.Contains(i));
+      bool removed = loaded.Remove(i);
+      palAssertBreak(removed);
+    }
+    palAssertBreak(loaded.GetCount() == 0);
+
+    // a victim outside the buckets, or wider than a fingerprint, is rejected
+    uint32_t* header_words = blob.GetPtr<uint32_t>();
+    header_words[7] = filter.GetBucketCount();
+    result = loaded.Deserialize(blob);
+    palAssertBreak(result == PAL_CUCKOO_FILTER_ERROR_INVALID_BLOB);
+    header_words[7] = 0;
+    header_words[6] = 1u << filter.GetFingerprintBits();
+    result = loaded.Deserialize(blob);
+    palAssertBreak(result == PAL_CUCKOO_FILTER_ERROR_INVALID_BLOB);
+    g_DefaultHeapAllocator->Deallocate(memory);
+  }
+
+  // fill past capacity, nothing inserted before the filter reports full may be lost
+  {
+    palCuckooFilter filter;
+    filter.SetAllocator(g_DefaultHeapAllocator);
+    filter.Create(1000, 0.001);
+    uint64_t inserted = 0;
+    while (filter.Insert(inserted)) {
+      inserted++;
+    }
+    palAssertBreak(filter.LoadFactor() > 0.9f);
+    for (uint64_t i = 0; i < inserted; i++) {
+      palAssertBreak(filter.Contains(i));
+    }
+    // removing makes room for the evicted fingerprint and more keys
+    bool removed = filter.Remove((uint64_t)0);
+    palAssertBreak(removed);
+    removed = filter.Remove((uint64_t)1);
+    palAssertBreak(removed);
+    for (uint64_t i = 2; i < inserted; i++) {
+      palAssertBreak(filter.Contains(i));
+    }
+    bool room = filter.Insert(inserted);
+    palAssertBreak(room);
+    palAssertBreak(filter.Contains(inserted));
+  }
+  return true;
+}
+
+/* Mostly missing lookups, the filter in front of a palHashMap skips most Find calls */
+bool palFilterBenchmark() {
+  const int num_keys = 1024*1024;
+  const int num_lookups = 4*1024*1024;
+  palHashMap<uint64_t, int> map;
+  palBloomFilter bloom;
+  palCuckooFilter cuckoo;
+  map.SetAllocator(g_DefaultHeapAllocator);
+  bloom.SetAllocator(g_DefaultHeapAllocator);
+  cuckoo.SetAllocator(g_DefaultHeapAllocator);
+  bloom.Create(num_keys, 0.01);
+  cuckoo.Create(num_keys, 0.01);
+  for (uint64_t i = 0; i < num_keys; i++) {
+    map.Insert(i, (int)i);
+    bloom.Insert(i);
+    cuckoo.Insert(i);
+  }
+
+  printf("%d lookups, 1 in 16 present %12s %12s %12s\n", num_lookups, "palHashMap", "bloom", "cuckoo");
+  int found[3] = { 0, 0, 0 };
+  float times[3];
+  palTimer timer;
+  for (int method = 0; method < 3; method++) {
+    timer.Start();
+    for (uint64_t i = 0; i < num_lookups; i++) {
+      uint64_t key = (i & 15) == 0 ? (i * 2654435761u) % num_keys : i + kPalFilterTestMissOffset;
+      if (method == 1 && bloom.Contains(key) == false) {
+        continue;
+      }
+      if (method == 2 && cuckoo.Contains(key) == false) {
+        continue;
+      }
+      found[method] += map.Find(key) != NULL ? 1 : 0;
+    }
+    timer.Stop();
+    times[method] = timer.GetDeltaSeconds();
+  }
+  palAssertBreak(found[0] == found[1] && found[0] == found[2]);
+  printf("%40s %12f %12f %12f\n", "", times[0], times[1], times[2]);
+  return true;
+}
+
+bool PalFilterTest() {
+  palBloomFilterTest();
+  palCuckooFilterTest();
+  palFilterBenchmark();
+  return true;
+}
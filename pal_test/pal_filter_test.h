@@ -0,0 +1,6 @@
+#ifndef PAL_TEST_PAL_FILTER_TEST_H_
+#define PAL_TEST_PAL_FILTER_TEST_H_
+
+bool PalFilterTest();
+
+#endif  // PAL_TEST_PAL_FILTER_TEST_H_
@@ -0,0 +1,356 @@
+#include <cstdio>
+#include "libpal/libpal.h"
+#include "pal_hash_test.h"
+
+bool palHashConsistencyTest() {
+  char buffer[128];
+  for (int i = 0; i < 127; i++) {
+    buffer[i] = (char)('a' + (i * 7) % 26);
+  }
+  buffer[127] = '\0';
+
+  for (int len = 0; len < 127; len++) {
+    char saved = buffer[len];
+    buffer[len] = '\0';
+
+    uint64_t h = palHash64(buffer, len);
+
+    int string_length = -1;
+    uint64_t hs = palHashString64(buffer, &string_length);
+    palAssertBreak(string_length == len);
+    palAssertBreak(hs == h);
+
+    // feed the stream in uneven pieces
+    palHashStream64 stream;
+    int fed = 0;
+    int piece = 1;
+    while (fed < len) {
+      int count = palMin(piece, len - fed);
+      stream.Update(buffer + fed, count);
+      fed += count;
+      piece = (piece * 3) % 11 + 1;
+    }
+    palAssertBreak(stream.Digest() == h);
+
+    palDynamicString ds(buffer);
+    palAssertBreak(palHashFunction<palDynamicString>()(ds) == h);
+    palAssertBreak(palHashFunction<const char*>()(buffer) == h);
+
+    buffer[len] = saved;
+  }
+
+  // strings that end right before a page boundary take the byte at a time path
+  {
+    const int page_size = 4096;
+    char* pages = (char*)g_DefaultHeapAllocator->Allocate(page_size*2, page_size);
+    for (int len = 0; len < 24; len++) {
+      char* str = pages + page_size - len - 1;
+      for (int i = 0; i < len; i++) {
+        str[i] = (char)('A' + i);
+      }
+      str[len] = '\0';
+      int string_length = -1;
+      palAssertBreak(palHashString64(str, &string_length) == palHash64(str, len));
+      palAssertBreak(string_length == len);
+    }
+    g_DefaultHeapAllocator->Deallocate(pages);
+  }
+
+  palAssertBreak(palHashString64(NULL) == palHash64(NULL, 0));
+  palAssertBreak(palHash64("abc", 3) != palHash64("abd", 3));
+  palAssertBreak(palHash64("abc", 3) != palHash64("abc", 3, 1));
+  // trailing zero bytes change the hash
+  palAssertBreak(palHash64("ab\0", 3) != palHash64("ab", 2));
+  return true;
+}
+
+/* Flip every input bit and record how often each output bit changes.
+ * An ideal hash changes every output bit with probability 0.5.
+ * Returns the worst deviation from 0.5 over all input/output bit pairs.
+ */
+template <typename HashFunc>
+float palHashAvalancheBias(HashFunc hash, int input_bits, int trials) {
+  static int flips[64][64];
+  palMemoryZeroBytes(flips, sizeof(flips));
+
+  for (int t = 0; t < trials; t++) {
+    uint64_t key = ((uint64_t)palGenerateRandom() << 32) | palGenerateRandom();
+    if (input_bits < 64) {
+      key &= (1ULL << input_bits) - 1;
+    }
+    uint64_t h = hash(key);
+    for (int i = 0; i < input_bits; i++) {
+      uint64_t diff = h ^ hash(key ^ (1ULL << i));
+      for (int j = 0; j < 64; j++) {
+        flips[i][j] += (int)((diff >> j) & 1);
+      }
+    }
+  }
+
+  float worst = 0.0f;
+  for (int i = 0; i < input_bits; i++) {
+    for (int j = 0; j < 64; j++) {
+      float p = (float)flips[i][j] / (float)trials;
+      float bias = p > 0.5f ? p - 0.5f : 0.5f - p;
+      worst = palMax(worst, bias);
+    }
+  }
+  return worst;
+}
+
+struct palHashMix32Adapter {
+  uint64_t operator()(uint64_t key) const {
+    // spread the 32 bit result over both halves so all 64 output bits are meaningful
+    uint64_t lo = palHashMix32((uint32_t)key);
+    return lo | (lo << 32);
+  }
+};
+
+struct palHashMix64Adapter {
+  uint64_t operator()(uint64_t key) const {
+    return palHashMix64(key);
+  }
+};
+
+struct palHash64Adapter {
+  uint64_t operator()(uint64_t key) const {
+    return palHash64(&key, sizeof(key));
+  }
+};
+
+struct palMurmurHashAdapter {
+  uint64_t operator()(uint64_t key) const {
+    uint64_t lo = palMurmurHash(&key, sizeof(key));
+    return lo | (lo << 32);
+  }
+};
+
+bool palHashQualityTest() {
+  const int trials = 20000;
+  palSeedRandom(11);
+  printf("Avalanche worst bias (0.0 is ideal):\n");
+  printf("  palMurmurHash (8 bytes)  %f\n", palHashAvalancheBias(palMurmurHashAdapter(), 64, trials));
+  printf("  palHashMix32             %f\n", palHashAvalancheBias(palHashMix32Adapter(), 32, trials));
+  printf("  palHashMix64             %f\n", palHashAvalancheBias(palHashMix64Adapter(), 64, trials));
+  printf("  palHash64 (8 bytes)      %f\n", palHashAvalancheBias(palHash64Adapter(), 64, trials));
+
+  palAssertBreak(palHashAvalancheBias(palHashMix64Adapter(), 64, trials) < 0.05f);
+  palAssertBreak(palHashAvalancheBias(palHash64Adapter(), 64, trials) < 0.05f);
+
+  // bucket distribution of sequential keys, the worst case for a weak integer hash
+  {
+    palHashMap<int, int> map;
+    map.SetAllocator(g_DefaultHeapAllocator);
+    for (int i = 0; i < 100000; i++) {
+      map.Insert(i * 64, i);
+    }
+    printf("Sequential int keys: mean chain = %f SD = %f\n", map.MeanLength(), map.StandardDeviationLength());
+  }
+  {
+    palHashMap<uint64_t, int> map;
+    map.SetAllocator(g_DefaultHeapAllocator);
+    for (int i = 0; i < 100000; i++) {
+      map.Insert((uint64_t)i << 32, i);
+    }
+    printf("High bit uint64_t keys: mean chain = %f SD = %f\n", map.MeanLength(), map.StandardDeviationLength());
+  }
+  return true;
+}
+
+bool palHashThroughputBenchmark() {
+  const int buffer_size = 64*1024;
+  char* buffer = (char*)g_DefaultHeapAllocator->Allocate(buffer_size+1);
+  palSeedRandom(5);
+  for (int i = 0; i < buffer_size; i++) {
+    buffer[i] = (char)('!' + palGenerateRandom() % 90);
+  }
+  buffer[buffer_size] = '\0';
+
+  const int key_sizes[] = { 4, 8, 16, 32, 64, 256, 4096, buffer_size };
+  const int num_key_sizes = sizeof(key_sizes)/sizeof(key_sizes[0]);
+  const int bytes_per_run = 64*1024*1024;
+
+  printf("%8s %14s %14s %14s %14s\n", "bytes", "murmur MB/s", "hash64 MB/s", "strlen+murmur", "hash string");
+  for (int k = 0; k < num_key_sizes; k++) {
+    const int key_size = key_sizes[k];
+    const int iterations = bytes_per_run / key_size;
+    const int offset_mask = (buffer_size - key_size);
+    uint64_t sink = 0;
+    palTimer timer;
+
+    timer.Start();
+    for (int i = 0; i < iterations; i++) {
+      sink += palMurmurHash(buffer + (i & offset_mask & ~7), key_size);
+    }
+    timer.Stop();
+    float murmur_seconds = timer.GetDeltaSeconds();
+
+    timer.Start();
+    for (int i = 0; i < iterations; i++) {
+      sink += palHash64(buffer + (i & offset_mask & ~7), key_size);
+    }
+    timer.Stop();
+    float hash64_seconds = timer.GetDeltaSeconds();
+
+    // NUL terminated keys: the old two pass path against the single pass one
+    char saved = buffer[key_size];
+    buffer[key_size] = '\0';
+    timer.Start();
+    for (int i = 0; i < iterations; i++) {
+      sink += palMurmurHash(buffer, palStringLength(buffer));
+    }
+    timer.Stop();
+    float two_pass_seconds = timer.GetDeltaSeconds();
+
+    timer.Start();
+    for (int i = 0; i < iterations; i++) {
+      sink += palHashString64(buffer);
+    }
+    timer.Stop();
+    float one_pass_seconds = timer.GetDeltaSeconds();
+    buffer[key_size] = saved;
+
+    const float mb = (float)bytes_per_run / (1024.0f * 1024.0f);
+    printf("%8d %14.1f %14.1f %14.1f %14.1f (%d)\n", key_size, mb / murmur_seconds, mb / hash64_seconds, mb / two_pass_seconds, mb / one_pass_seconds, (int)(sink & 1));
+  }
+
+  g_DefaultHeapAllocator->Deallocate(buffer);
+  return true;
+}
+
+bool palHashedStringTest() {
+  palHashedString a("January");
+  palHashedString b("January", 7);
+  palHashedString c("June");
+  palAssertBreak(a.GetLength() == 7);
+  palAssertBreak(a.GetHash() == palHashFunction<const char*>()("January"));
+  palAssertBreak(a == b);
+  palAssertBreak(a != c);
+
+  palHashedDynamicString owned(a);
+  palAssertBreak(owned.Equals(a));
+  palAssertBreak(owned.GetHash() == a.GetHash());
+  owned.Set("June");
+  palAssertBreak(owned.Equals(c));
+  palAssertBreak(palHashFunction<palHashedDynamicString>()(owned) == c.GetHash());
+
+  palHashMap<palHashedString, int> map;
+  map.SetAllocator(g_DefaultHeapAllocator);
+  map.Insert(palHashedString("January"), 1);
+  map.Insert(palHashedString("June"), 6);
+  map.Insert(palHashedString("July"), 7);
+  palAssertBreak(*map.Find(a) == 1);
+  palAssertBreak(*map.Find(c) == 6);
+  palAssertBreak(map.Find(palHashedString("March")) == NULL);
+
+  palHashMap<palHashedDynamicString, int> owned_map;
+  owned_map.SetAllocator(g_DefaultHeapAllocator);
+  owned_map.Insert(palHashedDynamicString("July"), 7);
+  palAssertBreak(*owned_map.Find(palHashedDynamicString("July")) == 7);
+  palAssertBreak(owned_map.Find(owned) == NULL);
+  return true;
+}
+
+/* Views look up owned keys without building a palDynamicString */
+bool palStringViewHashTest() {
+  const char* line = "January,June,July";
+  palStringView january(line, 7);
+  palAssertBreak(palHashFunction<palStringView>()(january) == palHashFunction<const char*>()("January"));
+  palAssertBreak(palHashFunction<palStringView>()(january) == palHashFunction<palDynamicString>()(palDynamicString("January")));
+
+  palHashMap<palDynamicString, int> map;
+  map.SetAllocator(g_DefaultHeapAllocator);
+  map.Insert(palDynamicString("January"), 1);
+  map.Insert(palDynamicString("June"), 6);
+  map.Insert(palDynamicString("July"), 7);
+  palStringView fields(line), field;
+  int sum = 0;
+  while (fields.NextToken(',', &field)) {
+    sum += *map.FindAs(field);
+  }
+  palAssertBreak(sum == 14);
+  palAssertBreak(map.FindAs(palStringView(line, 3)) == NULL);
+
+  palHashMap<palStringView, int> view_map;
+  view_map.SetAllocator(g_DefaultHeapAllocator);
+  view_map.Insert(january, 1);
+  palAssertBreak(*view_map.Find("January") == 1);
+  palAssertBreak(view_map.Find("Jan") == NULL);
+  return true;
+}
+
+/* The same keys looked up in several tables, as happens when a message is routed */
+bool palHashedStringBenchmark() {
+  const int num_keys = 4096;
+  const int num_tables = 4;
+  const int rounds = 64;
+
+  char** keys = (char**)g_DefaultHeapAllocator->Allocate(sizeof(char*)*num_keys);
+  palSeedRandom(9);
+  for (int i = 0; i < num_keys; i++) {
+    keys[i] = palStringAllocatingPrintf("message.field.%08x.%d", palGenerateRandom(), i);
+  }
+
+  palHashMap<palDynamicString, int> string_tables[num_tables];
+  palHashMap<palHashedString, int> hashed_tables[num_tables];
+  for (int t = 0; t < num_tables; t++) {
+    string_tables[t].SetAllocator(g_DefaultHeapAllocator);
+    hashed_tables[t].SetAllocator(g_DefaultHeapAllocator);
+    for (int i = t; i < num_keys; i += 2) {
+      string_tables[t].Insert(palDynamicString(keys[i]), i);
+      hashed_tables[t].Insert(palHashedString(keys[i]), i);
+    }
+  }
+
+  palDynamicString* lookup_strings = (palDynamicString*)g_DefaultHeapAllocator->Allocate(sizeof(palDynamicString)*num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    new (&lookup_strings[i]) palDynamicString(keys[i]);
+  }
+
+  int found = 0;
+  palTimer timer;
+  timer.Start();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < num_keys; i++) {
+      for (int t = 0; t < num_tables; t++) {
+        found += string_tables[t].Find(lookup_strings[i]) != NULL;
+      }
+    }
+  }
+  timer.Stop();
+  float string_seconds = timer.GetDeltaSeconds();
+
+  timer.Start();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < num_keys; i++) {
+      // hashed once, looked up in every table
+      palHashedString key(lookup_strings[i]);
+      for (int t = 0; t < num_tables; t++) {
+        found -= hashed_tables[t].Find(key) != NULL;
+      }
+    }
+  }
+  timer.Stop();
+  float hashed_seconds = timer.GetDeltaSeconds();
+  palAssertBreak(found == 0);
+
+  printf("%d lookups across %d tables: palDynamicString %f seconds, palHashedString %f seconds\n", num_keys*rounds*num_tables, num_tables, string_seconds, hashed_seconds);
+
+  for (int i = 0; i < num_keys; i++) {
+    lookup_strings[i].~palDynamicString();
+    palStringAllocatingPrintfDeallocate(keys[i]);
+  }
+  g_DefaultHeapAllocator->Deallocate(lookup_strings);
+  g_DefaultHeapAllocator->Deallocate(keys);
+  return true;
+}
+
+bool PalHashTest() {
+  palHashConsistencyTest();
+  palHashedStringTest();
+  palStringViewHashTest();
+  palHashQualityTest();
+  palHashThroughputBenchmark();
+  palHashedStringBenchmark();
+  return true;
+}
@@ -0,0 +1,6 @@
+#ifndef PAL_TEST_PAL_HASH_TEST_H_
+#define PAL_TEST_PAL_HASH_TEST_H_
+
+bool PalHashTest();
+
+#endif  // PAL_TEST_PAL_HASH_TEST_H_
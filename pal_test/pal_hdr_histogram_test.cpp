@@ -0,0 +1,215 @@
+#include <cstdio>
+#include "libpal/libpal.h"
+#include "pal_hdr_histogram_test.h"
+
+static bool palHdrHistogramTestClose(int64_t value, int64_t expected, double relative_error) {
+  double difference = (double)(value > expected ? value - expected : expected - value);
+  return difference <= expected * relative_error + 1.0;
+}
+
+bool palHdrHistogramBasicTest() {
+  palHdrHistogramDescription desc;
+  desc.highest_trackable_value = 3600LL * 1000 * 1000;
+  desc.significant_figures = 3;
+  palHdrHistogram histogram;
+  histogram.SetAllocator(g_DefaultHeapAllocator);
+  histogram.Create(desc);
+  palAssertBreak(histogram.GetTotalCount() == 0);
+  palAssertBreak(histogram.GetValueAtPercentile(50.0) == 0);
+
+  // 1 to 1000000 once each
+  for (int64_t i = 1; i <= 1000000; i++) {
+    histogram.RecordValue(i);
+  }
+  palAssertBreak(histogram.GetTotalCount() == 1000000);
+  palAssertBreak(histogram.GetMin() == 1);
+  palAssertBreak(palHdrHistogramTestClose(histogram.GetMax(), 1000000, 0.001));
+  palAssertBreak(palHdrHistogramTestClose(histogram.GetValueAtPercentile(50.0), 500000, 0.001));
+  palAssertBreak(palHdrHistogramTestClose(histogram.GetValueAtPercentile(99.0), 990000, 0.001));
+  palAssertBreak(palHdrHistogramTestClose(histogram.GetValueAtPercentile(99.9), 999000, 0.001));
+  palAssertBreak(palHdrHistogramTestClose((int64_t)histogram.GetMean(), 500000, 0.001));
+
+  // small values are exact
+  histogram.Reset();
+  for (int64_t i = 0; i < 2000; i++) {
+    histogram.RecordValue(i);
+  }
+  for (int p = 1; p <= 100; p++) {
+    palAssertBreak(histogram.GetValueAtPercentile(p) == p * 20 - 1);
+  }
+
+  // out of range values are clamped
+  histogram.Reset();
+  histogram.RecordValue(-5);
+  histogram.RecordValue(desc.highest_trackable_value * 4);
+  palAssertBreak(histogram.GetMin() == 0);
+  palAssertBreak(palHdrHistogramTestClose(histogram.GetMax(), desc.highest_trackable_value, 0.001));
+
+  // precision follows significant figures
+  for (int figures = 1; figures <= 5; figures++) {
+    double relative_error = 1.0;
+    for (int i = 0; i < figures; i++) {
+      relative_error *= 0.1;
+    }
+    palHdrHistogram precise;
+    desc.significant_figures = figures;
+    precise.SetAllocator(g_DefaultHeapAllocator);
+    precise.Create(desc);
+    for (int i = 0; i < 1000; i++) {
+      int64_t value = ((int64_t)palGenerateRandom() << 8) % desc.highest_trackable_value;
+      precise.Reset();
+      precise.RecordValue(value);
+      palAssertBreak(palHdrHistogramTestClose(precise.GetValueAtPercentile(100.0), value, relative_error));
+    }
+    printf("palHdrHistogram %d significant figures: %d bytes\n", figures, (int)precise.GetMemorySize());
+  }
+  return true;
+}
+
+bool palHdrHistogramSerializeTest() {
+  palHdrHistogramDescription desc;
+  palHdrHistogram histogram;
+  palHdrHistogram loaded;
+  histogram.SetAllocator(g_DefaultHeapAllocator);
+  loaded.SetAllocator(g_DefaultHeapAllocator);
+  histogram.Create(desc);
+  // a latency like distribution, mostly short with a long tail
+  for (int i = 0; i < 100000; i++) {
+    int64_t value = 1000 + palGenerateRandom() % 1000;
+    if (i % 100 == 0) {
+      value *= 50;
+    }
+    histogram.RecordValue(value);
+  }
+
+  palGrowingMemoryBlob growing_blob(g_DefaultHeapAllocator);
+  histogram.Serialize(&growing_blob);
+  printf("palHdrHistogram serialized %d bytes, counts are %d bytes\n", (int)growing_blob.GetBufferSize(), (int)histogram.GetMemorySize());
+  palAssertBreak(growing_blob.GetBufferSize() < histogram.GetMemorySize() / 8);
+  palMemBlob blob;
+  growing_blob.GetBlob(&blob);
+  int result = loaded.Deserialize(blob);
+  palAssertBreak(result == 0);
+  palAssertBreak(loaded.GetTotalCount() == histogram.GetTotalCount());
+  palAssertBreak(loaded.GetMin() == histogram.GetMin());
+  palAssertBreak(loaded.GetMax() == histogram.GetMax());
+  for (double p = 0.0; p <= 100.0; p += 0.5) {
+    palAssertBreak(loaded.GetValueAtPercentile(p) == histogram.GetValueAtPercentile(p));
+  }
+
+  palMemBlob truncated(blob.GetPtr(), blob.GetBufferSize() - 1);
+  result = loaded.Deserialize(truncated);
+  palAssertBreak(result == PAL_HDR_HISTOGRAM_ERROR_INVALID_BLOB);
+
+  // a single count of 1 is the last byte, replace it with a zero run of INT64_MIN
+  histogram.Reset();
+  histogram.RecordValue(0);
+  palGrowingMemoryBlob single_blob(g_DefaultHeapAllocator);
+  histogram.Serialize(&single_blob);
+  single_blob.GetBlob(&blob);
+  unsigned char malformed[256];
+  int header_size = (int)blob.GetBufferSize() - 1;
+  palAssertBreak(header_size + 10 <= (int)sizeof(malformed) && blob.GetPtr<unsigned char>()[header_size] == 0x02);
+  palMemoryCopyBytes(malformed, blob.GetPtr(), header_size);
+  for (int i = 0; i < 9; i++) {
+    malformed[header_size + i] = 0xff;
+  }
+  malformed[header_size + 9] = 0x01;
+  result = loaded.Deserialize(palMemBlob(malformed, header_size + 10));
+  palAssertBreak(result == PAL_HDR_HISTOGRAM_ERROR_INVALID_BLOB);
+  return true;
+}
+
+/* Each thread records into its own histogram, the main thread merges them while they run */
+struct palHdrHistogramTestThread {
+  palHdrHistogram histogram;
+  palAtomicInt32 done;
+  int count;
+};
+
+static int palHdrHistogramTestThreadMain(uintptr_t param) {
+  palHdrHistogramTestThread* thread = reinterpret_cast<palHdrHistogramTestThread*>(param);
+  for (int i = 0; i < thread->count; i++) {
+    thread->histogram.RecordValue(1 + (i & 1023));
+  }
+  thread->done.Store(1);
+  palThread::Exit(0);
+  return 0;
+}
+
+bool palHdrHistogramThreadTest() {
+  const int num_threads = 4;
+  palHdrHistogramDescription desc;
+  palHdrHistogramTestThread threads[num_threads];
+  palThread thread_handles[num_threads];
+  for (int i = 0; i < num_threads; i++) {
+    threads[i].histogram.SetAllocator(g_DefaultHeapAllocator);
+    threads[i].histogram.Create(desc);
+    threads[i].done.Store(0);
+    threads[i].count = 1000000;
+    palThreadDescription thread_desc;
+    thread_desc.name = "palHdrHistogramTest";
+    thread_desc.start_method = palThreadStart(palHdrHistogramTestThreadMain);
+    thread_handles[i].Start(thread_desc, (uintptr_t)&threads[i]);
+  }
+
+  palHdrHistogram merged;
+  merged.SetAllocator(g_DefaultHeapAllocator);
+  merged.Create(desc);
+  bool running = true;
+  int snapshots = 0;
+  while (running) {
+    running = false;
+    merged.Reset();
+    for (int i = 0; i < num_threads; i++) {
+      running = running || threads[i].done.Load() == 0;
+      merged.Add(threads[i].histogram);
+    }
+    palAssertBreak(merged.GetTotalCount() <= (int64_t)num_threads * 1000000);
+    snapshots++;
+  }
+  for (int i = 0; i < num_threads; i++) {
+    thread_handles[i].Join(NULL);
+  }
+  merged.Reset();
+  for (int i = 0; i < num_threads; i++) {
+    merged.Add(threads[i].histogram);
+  }
+  printf("palHdrHistogram merged %d snapshots while recording\n", snapshots);
+  palAssertBreak(merged.GetTotalCount() == (int64_t)num_threads * 1000000);
+  palAssertBreak(merged.GetMin() == 1 && merged.GetMax() == 1024);
+  palAssertBreak(merged.GetValueAtPercentile(50.0) == 512);
+  return true;
+}
+
+bool palHdrHistogramBenchmark() {
+  const int num_values = 16*1024*1024;
+  palHdrHistogramDescription desc;
+  palHdrHistogram histogram;
+  histogram.SetAllocator(g_DefaultHeapAllocator);
+  histogram.Create(desc);
+  int64_t* values = static_cast<int64_t*>(g_DefaultHeapAllocator->Allocate(sizeof(int64_t) * 4096));
+  for (int i = 0; i < 4096; i++) {
+    values[i] = 100 + palGenerateRandom() % 100000;
+  }
+  palTimer timer;
+  timer.Start();
+  for (int i = 0; i < num_values; i++) {
+    histogram.RecordValue(values[i & 4095]);
+  }
+  timer.Stop();
+  float seconds = timer.GetDeltaSeconds();
+  printf("palHdrHistogram RecordValue %f ns per value\n", seconds * 1e9f / num_values);
+  printf("p50 %lld p99 %lld p99.9 %lld\n", (long long)histogram.GetValueAtPercentile(50.0),
+         (long long)histogram.GetValueAtPercentile(99.0), (long long)histogram.GetValueAtPercentile(99.9));
+  g_DefaultHeapAllocator->Deallocate(values);
+  return true;
+}
+
+bool PalHdrHistogramTest() {
+  palHdrHistogramBasicTest();
+  palHdrHistogramSerializeTest();
+  palHdrHistogramThreadTest();
+  palHdrHistogramBenchmark();
+  return true;
+}
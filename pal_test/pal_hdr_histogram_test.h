@@ -0,0 +1,6 @@
+#ifndef PAL_TEST_PAL_HDR_HISTOGRAM_TEST_H_
+#define PAL_TEST_PAL_HDR_HISTOGRAM_TEST_H_
+
+bool PalHdrHistogramTest();
+
+#endif  // PAL_TEST_PAL_HDR_HISTOGRAM_TEST_H_
@@ -1,5 +1,6 @@
 
 #include "libpal/libpal.h"
+#include "libpal/pal_memory_stream.h"
 
 #include "pal_json_test.h"
 
@@ -63,6 +64,31 @@ bool PalJsonTest() {
 
   palJSONPrettyPrint(blob.GetPtr<const char>(0));
 
+  // numbers are read in place, exactly, and without the C locale
+  palJSONParser number_parser;
+  number_parser.Init("{\"big\": -9007199254740993, \"tenth\": 0.1, \"exponent\": 25e-1}");
+  number_parser.StartParse();
+  palJSONToken number_tokens[4];
+  int num_number_tokens = number_parser.Parse(&number_tokens[0], 4);
+  palAssertBreak(num_number_tokens == 3);
+  palAssertBreak(number_tokens[0].GetAsInt64() == -9007199254740993LL);
+  palAssertBreak(number_tokens[1].GetAsDouble() == 0.1);
+  palAssertBreak(number_tokens[2].GetAsFloat() == 2.5f);
+
+  // tokenizer integers cover the whole uint64_t range, negatives wrap
+  const char* integers = "18446744073709551615 9223372036854775808 -5 42";
+  palMemoryStream integer_stream;
+  integer_stream.Create(palMemBlob((void*)integers, palStringLength(integers)), false);
+  palTokenizer tokenizer;
+  tokenizer.UseStream(&integer_stream);
+  const uint64_t expected_integers[4] = { 18446744073709551615ULL, 9223372036854775808ULL, (uint64_t)-5, 42 };
+  for (int i = 0; i < 4; i++) {
+    palToken token;
+    bool fetched = tokenizer.FetchNextToken(&token);
+    palAssertBreak(fetched && token.type == kTokenNumber);
+    palAssertBreak(token.GetIntegerValue() == expected_integers[i]);
+  }
+
   palFile::FreeFileContents(&blob);
   return true;
 }
\ No newline at end of file
@@ -1,9 +1,9 @@
-
+#include <cstdio>
 #include "libpal/libpal.h"
 
 #include "pal_object_id_table_test.h"
 
-bool PalObjectIdTableTest() {
+bool palObjectIdTableBasicTest() {
   palObjectIdTable<const char> table;
 
   const char* a_str = "A";
@@ -46,4 +46,451 @@ bool PalObjectIdTableTest() {
   palAssertBreak(count == 2);
 
   return true;
-}
\ No newline at end of file
+}
+
+bool palDenseObjectIdTableBasicTest() {
+  palDenseObjectIdTable<const char, 12, 4> table;
+  table.SetAllocator(g_DefaultHeapAllocator);
+
+  const char* a_str = "A";
+  const char* b_str = "B";
+  uint32_t a_id = table.AddObject(a_str);
+  uint32_t b_id = table.AddObject(b_str);
+
+  palAssertBreak(a_str == table.MapObject(a_id));
+  palAssertBreak(b_str == table.MapObject(b_id));
+  palAssertBreak(a_id == table.FindObjectID(a_str));
+  palAssertBreak(b_id == table.FindObjectID(b_str));
+  palAssertBreak(table.GetSize() == 2);
+
+  table.RemoveObject(a_id);
+  palAssertBreak(NULL == table.MapObject(a_id));
+  palAssertBreak(table.GetCapacity() == table.FindObjectID(a_str));
+  const char* removed = table.RemoveObject(a_id);
+  palAssertBreak(NULL == removed);
+  palAssertBreak(b_str == table.MapObject(b_id));
+
+  // the freed slot is reused with a new generation
+  uint32_t a2_id = table.AddObject(a_str);
+  palAssertBreak(a2_id != a_id);
+  palAssertBreak(NULL == table.MapObject(a_id));
+  palAssertBreak(a_str == table.MapObject(a2_id));
+
+  int count = 0;
+  for (uint32_t id = table.GetFirstObjectID(); id != table.GetCapacity(); id = table.GetNextObjectID(id)) {
+    const char* str = table.MapObject(id);
+    palAssertBreak(str == a_str || str == b_str);
+    count++;
+  }
+  palAssertBreak(count == 2);
+
+  // fill the table, growing one 16 slot page at a time
+  static char objects[1 << 12];
+  table.Reset();
+  for (int i = 0; i < (1 << 12); i++) {
+    uint32_t id = table.AddObject(&objects[i]);
+    palAssertBreak(id != table.GetCapacity());
+    palAssertBreak(table.GetAllocatedSlotCount() >= table.GetSize());
+  }
+  palAssertBreak(table.GetAllocatedSlotCount() == table.GetCapacity());
+  uint32_t full_id = table.AddObject(a_str);
+  palAssertBreak(table.GetCapacity() == full_id);
+
+  // remove while iterating densely
+  uint32_t index = 0;
+  while (index < table.GetSize()) {
+    const char* o = table.GetObjectAtIndex(index);
+    if ((o - objects) & 1) {
+      const char* removed = table.RemoveObject(table.GetObjectIDAtIndex(index));
+      palAssertBreak(o == removed);
+    } else {
+      index++;
+    }
+  }
+  palAssertBreak(table.GetSize() == (1 << 11));
+  for (int i = 0; i < (1 << 12); i++) {
+    uint32_t id = table.FindObjectID(&objects[i]);
+    palAssertBreak((id == table.GetCapacity()) == ((i & 1) == 1));
+  }
+  return true;
+}
+
+bool palDenseObjectIdTableRandomTest() {
+  const int num_objects = 20000;
+  const int num_operations = 200000;
+  palDenseObjectIdTable<int> table;
+  table.SetAllocator(g_DefaultHeapAllocator);
+  int* objects = static_cast<int*>(g_DefaultHeapAllocator->Allocate(sizeof(int) * num_objects));
+  uint32_t* ids = static_cast<uint32_t*>(g_DefaultHeapAllocator->Allocate(sizeof(uint32_t) * num_objects));
+  for (int i = 0; i < num_objects; i++) {
+    ids[i] = table.GetCapacity();
+  }
+
+  palSeedRandom(29);
+  int live = 0;
+  for (int i = 0; i < num_operations; i++) {
+    int o = palGenerateRandom() % num_objects;
+    if (ids[o] == table.GetCapacity()) {
+      ids[o] = table.AddObject(&objects[o]);
+      palAssertBreak(ids[o] != table.GetCapacity());
+      live++;
+    } else {
+      uint32_t stale = ids[o];
+      int* removed = table.RemoveObject(ids[o]);
+      palAssertBreak(&objects[o] == removed);
+      ids[o] = table.GetCapacity();
+      palAssertBreak(NULL == table.MapObject(stale));
+      live--;
+    }
+    if ((i & 4095) == 0) {
+      palAssertBreak((int)table.GetSize() == live);
+      for (int j = 0; j < num_objects; j++) {
+        if (ids[j] == table.GetCapacity()) {
+          palAssertBreak(table.FindObjectID(&objects[j]) == table.GetCapacity());
+        } else {
+          palAssertBreak(table.MapObject(ids[j]) == &objects[j]);
+          palAssertBreak(table.FindObjectID(&objects[j]) == ids[j]);
+        }
+      }
+      int count = 0;
+      for (uint32_t id = table.GetFirstObjectID(); id != table.GetCapacity(); id = table.GetNextObjectID(id)) {
+        int* obj = table.MapObject(id);
+        palAssertBreak(ids[obj - objects] == id);
+        count++;
+      }
+      palAssertBreak(count == live);
+    }
+  }
+  g_DefaultHeapAllocator->Deallocate(ids);
+  g_DefaultHeapAllocator->Deallocate(objects);
+  return true;
+}
+
+/* Compares the fixed table against the dense table with a table that is
+   full and then has every other object removed */
+bool palDenseObjectIdTableBenchmark() {
+  const int kPowTwoObjects = 16;
+  const int num_objects = 1 << kPowTwoObjects;
+  const int num_finds = 4096;
+  typedef palObjectIdTable<int, kPowTwoObjects> FixedTable;
+  FixedTable* fixed = static_cast<FixedTable*>(g_DefaultHeapAllocator->Allocate(sizeof(FixedTable)));
+  new (fixed) FixedTable();
+  palDenseObjectIdTable<int> dense;
+  dense.SetAllocator(g_DefaultHeapAllocator);
+  int* objects = static_cast<int*>(g_DefaultHeapAllocator->Allocate(sizeof(int) * num_objects));
+  for (int i = 0; i < num_objects; i++) {
+    objects[i] = i;
+  }
+
+  palTimer timer;
+  timer.Start();
+  for (int i = 0; i < num_objects; i++) {
+    fixed->AddObject(&objects[i]);
+  }
+  for (int i = 0; i < num_objects; i += 2) {
+    fixed->RemoveObject(fixed->FindObjectID(&objects[i]));
+  }
+  timer.Stop();
+  float fixed_build = timer.GetDeltaSeconds();
+  timer.Start();
+  for (int i = 0; i < num_objects; i++) {
+    dense.AddObject(&objects[i]);
+  }
+  for (int i = 0; i < num_objects; i += 2) {
+    dense.RemoveObject(dense.FindObjectID(&objects[i]));
+  }
+  timer.Stop();
+  float dense_build = timer.GetDeltaSeconds();
+
+  int64_t fixed_sum = 0;
+  int64_t dense_sum = 0;
+  timer.Start();
+  for (int pass = 0; pass < 16; pass++) {
+    for (uint32_t id = fixed->GetFirstObjectID(); id != fixed->GetCapacity(); id = fixed->GetNextObjectID(id)) {
+      fixed_sum += *fixed->MapObject(id);
+    }
+  }
+  timer.Stop();
+  float fixed_iterate = timer.GetDeltaSeconds();
+  timer.Start();
+  for (int pass = 0; pass < 16; pass++) {
+    for (uint32_t i = 0; i < dense.GetSize(); i++) {
+      dense_sum += *dense.GetObjectAtIndex(i);
+    }
+  }
+  timer.Stop();
+  float dense_iterate = timer.GetDeltaSeconds();
+  palAssertBreak(fixed_sum == dense_sum);
+
+  uint32_t fixed_ids = 0;
+  uint32_t dense_ids = 0;
+  timer.Start();
+  for (int i = 0; i < num_finds; i++) {
+    fixed_ids += fixed->FindObjectID(&objects[(i * 2 + 1) % num_objects]);
+  }
+  timer.Stop();
+  float fixed_find = timer.GetDeltaSeconds();
+  timer.Start();
+  for (int i = 0; i < num_finds; i++) {
+    dense_ids += dense.FindObjectID(&objects[(i * 2 + 1) % num_objects]);
+  }
+  timer.Stop();
+  float dense_find = timer.GetDeltaSeconds();
+  palAssertBreak(fixed_ids != 0 && dense_ids != 0);
+
+  printf("%d objects, %d live\n", num_objects, num_objects / 2);
+  printf("%20s %12s %12s\n", "", "fixed", "dense");
+  printf("%20s %12f %12f\n", "add/remove", fixed_build, dense_build);
+  printf("%20s %12f %12f\n", "iterate x16", fixed_iterate, dense_iterate);
+  printf("%20s %12f %12f\n", "find id x4096", fixed_find, dense_find);
+
+  fixed->~FixedTable();
+  g_DefaultHeapAllocator->Deallocate(fixed);
+  g_DefaultHeapAllocator->Deallocate(objects);
+  return true;
+}
+
+bool palConcurrentObjectIdTableBasicTest() {
+  palConcurrentObjectIdTable<const char> table;
+
+  const char* a_str = "A";
+  const char* b_str = "B";
+  uint32_t a_id = table.AddObject(a_str);
+  uint32_t b_id = table.AddObject(b_str);
+
+  palAssertBreak(a_str == table.MapObject(a_id));
+  palAssertBreak(b_str == table.MapObject(b_id));
+  palAssertBreak(a_id == table.FindObjectID(a_str));
+  palAssertBreak(table.GetSize() == 2);
+
+  int count = 0;
+  for (uint32_t id = table.GetFirstObjectID(); id != table.GetCapacity(); id = table.GetNextObjectID(id)) {
+    const char* str = table.MapObject(id);
+    palAssertBreak(str == a_str || str == b_str);
+    count++;
+  }
+  palAssertBreak(count == 2);
+
+  const char* removed = table.RemoveObject(a_id);
+  palAssertBreak(a_str == removed);
+  removed = table.RemoveObject(a_id);
+  palAssertBreak(NULL == removed);
+  palAssertBreak(NULL == table.MapObject(a_id));
+  palAssertBreak(table.GetCapacity() == table.FindObjectID(a_str));
+
+  // unused slots are handed out before removed ones
+  uint32_t c_id = table.AddObject(a_str);
+  palAssertBreak((c_id & (table.GetCapacity() - 1)) == 2);
+
+  // fill the table, then the removed slot comes back with a new generation
+  static char objects[256];
+  for (int i = 3; i < 256; i++) {
+    uint32_t id = table.AddObject(&objects[i]);
+    palAssertBreak(id != table.GetCapacity());
+  }
+  uint32_t a2_id = table.AddObject(a_str);
+  palAssertBreak((a2_id & (table.GetCapacity() - 1)) == (a_id & (table.GetCapacity() - 1)));
+  palAssertBreak(a2_id != a_id);
+  palAssertBreak(NULL == table.MapObject(a_id));
+  palAssertBreak(a_str == table.MapObject(a2_id));
+  uint32_t full_id = table.AddObject(b_str);
+  palAssertBreak(table.GetCapacity() == full_id);
+  palAssertBreak(table.GetSize() == table.GetCapacity());
+  return true;
+}
+
+/* The baseline for the concurrent table: a palObjectIdTable behind a mutex */
+template<typename T, int kPowTwoObjectsInTable>
+class palLockedObjectIdTable {
+  palObjectIdTable<T, kPowTwoObjectsInTable> table_;
+  palMutex mutex_;
+public:
+  palLockedObjectIdTable() {
+    palMutexDescription desc;
+    desc.name = "Object ID Table";
+    mutex_.Create(desc);
+  }
+
+  ~palLockedObjectIdTable() {
+    mutex_.Destroy();
+  }
+
+  uint32_t GetCapacity() {
+    return table_.GetCapacity();
+  }
+
+  uint32_t AddObject(T* o) {
+    palScopedMutex lock(&mutex_);
+    return table_.AddObject(o);
+  }
+
+  T* RemoveObject(uint32_t id) {
+    palScopedMutex lock(&mutex_);
+    return table_.RemoveObject(id);
+  }
+
+  T* MapObject(uint32_t id) {
+    palScopedMutex lock(&mutex_);
+    return table_.MapObject(id);
+  }
+};
+
+/* Every thread resolves IDs of random objects and adds/removes the objects
+   it owns. An object is owned by thread (object index % num_threads) and an
+   ID must only ever map to the object it was handed out for. */
+template<typename Table>
+struct palObjectIdTableWorkload {
+  Table* table;
+  int* objects;
+  palAtomicInt32* ids;
+  int num_objects;
+  int num_threads;
+  int num_operations;
+  int resolve_percent;
+  palAtomicInt32 errors;
+  palAtomicInt32 resolved;
+};
+
+template<typename Table>
+struct palObjectIdTableWorker {
+  palObjectIdTableWorkload<Table>* workload;
+  int thread_index;
+};
+
+template<typename Table>
+void palObjectIdTableWorkerThread(uintptr_t param) {
+  palObjectIdTableWorker<Table>* worker = reinterpret_cast<palObjectIdTableWorker<Table>*>(param);
+  palObjectIdTableWorkload<Table>* w = worker->workload;
+  Table* table = w->table;
+  const uint32_t invalid_id = table->GetCapacity();
+  uint32_t random = 2463534242u + worker->thread_index * 7919;
+  int errors = 0;
+  int resolved = 0;
+  for (int i = 0; i < w->num_operations; i++) {
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    int o = (int)(random >> 8) % w->num_objects;
+    if ((int)(random & 127) * 100 < w->resolve_percent * 128) {
+      uint32_t id = (uint32_t)w->ids[o].Load();
+      int* mapped = table->MapObject(id);
+      if (mapped != NULL) {
+        resolved++;
+        if (mapped != &w->objects[o]) {
+          errors++;
+        }
+      }
+    } else {
+      // move to an object this thread owns
+      o -= o % w->num_threads;
+      o += worker->thread_index;
+      if (o >= w->num_objects) {
+        continue;
+      }
+      uint32_t id = (uint32_t)w->ids[o].Load();
+      if (id == invalid_id) {
+        w->ids[o].Store((int32_t)table->AddObject(&w->objects[o]));
+      } else {
+        w->ids[o].Store((int32_t)invalid_id);
+        if (table->RemoveObject(id) != &w->objects[o]) {
+          errors++;
+        }
+      }
+    }
+  }
+  w->errors.FetchAdd(errors);
+  w->resolved.FetchAdd(resolved);
+  palThread::Exit(0);
+}
+
+template<typename Table>
+float palObjectIdTableWorkloadRun(Table* table, int num_threads, int resolve_percent, int* errors) {
+  const int kMaxThreads = 16;
+  const int num_objects = 16384;
+  palObjectIdTableWorkload<Table> w;
+  w.table = table;
+  w.num_objects = num_objects;
+  w.num_threads = num_threads;
+  w.num_operations = 1000000;
+  w.resolve_percent = resolve_percent;
+  w.errors.Store(0);
+  w.resolved.Store(0);
+  w.objects = static_cast<int*>(g_DefaultHeapAllocator->Allocate(sizeof(int) * num_objects));
+  w.ids = static_cast<palAtomicInt32*>(g_DefaultHeapAllocator->Allocate(sizeof(palAtomicInt32) * num_objects));
+  // start with half of the objects in the table
+  for (int i = 0; i < num_objects; i++) {
+    new (&w.ids[i]) palAtomicInt32((int32_t)table->GetCapacity());
+    if (i & 1) {
+      w.ids[i].Store((int32_t)table->AddObject(&w.objects[i]));
+    }
+  }
+
+  palThread threads[kMaxThreads];
+  palObjectIdTableWorker<Table> workers[kMaxThreads];
+  palTimer timer;
+  timer.Start();
+  for (int i = 0; i < num_threads; i++) {
+    palThreadDescription desc;
+    desc.name = "Object ID Table Worker";
+    desc.start_method = palThreadStart(palObjectIdTableWorkerThread<Table>);
+    workers[i].workload = &w;
+    workers[i].thread_index = i;
+    threads[i].Start(desc, reinterpret_cast<uintptr_t>(&workers[i]));
+  }
+  for (int i = 0; i < num_threads; i++) {
+    threads[i].Join(NULL);
+  }
+  timer.Stop();
+
+  for (int i = 0; i < num_objects; i++) {
+    uint32_t id = (uint32_t)w.ids[i].Load();
+    if (id != table->GetCapacity() && table->RemoveObject(id) != &w.objects[i]) {
+      w.errors.FetchAdd(1);
+    }
+  }
+  *errors = w.errors.Load();
+  g_DefaultHeapAllocator->Deallocate(w.ids);
+  g_DefaultHeapAllocator->Deallocate(w.objects);
+  return timer.GetDeltaSeconds();
+}
+
+bool palConcurrentObjectIdTableBenchmark() {
+  typedef palConcurrentObjectIdTable<int, 16> ConcurrentTable;
+  typedef palLockedObjectIdTable<int, 16> LockedTable;
+  ConcurrentTable* concurrent = static_cast<ConcurrentTable*>(g_DefaultHeapAllocator->Allocate(sizeof(ConcurrentTable)));
+  LockedTable* locked = static_cast<LockedTable*>(g_DefaultHeapAllocator->Allocate(sizeof(LockedTable)));
+  new (concurrent) ConcurrentTable();
+  new (locked) LockedTable();
+
+  const int resolve_percents[2] = { 99, 90 };
+  printf("1000000 operations per thread\n");
+  printf("%8s %8s %12s %12s\n", "resolve", "threads", "mutex", "lock-free");
+  for (int r = 0; r < 2; r++) {
+    for (int num_threads = 1; num_threads <= 16; num_threads *= 2) {
+      int locked_errors = 0;
+      int concurrent_errors = 0;
+      float locked_time = palObjectIdTableWorkloadRun(locked, num_threads, resolve_percents[r], &locked_errors);
+      float concurrent_time = palObjectIdTableWorkloadRun(concurrent, num_threads, resolve_percents[r], &concurrent_errors);
+      palAssertBreak(locked_errors == 0);
+      palAssertBreak(concurrent_errors == 0);
+      printf("%7d%% %8d %12f %12f\n", resolve_percents[r], num_threads, locked_time, concurrent_time);
+    }
+  }
+  palAssertBreak(concurrent->GetSize() == 0);
+
+  locked->~LockedTable();
+  concurrent->~ConcurrentTable();
+  g_DefaultHeapAllocator->Deallocate(locked);
+  g_DefaultHeapAllocator->Deallocate(concurrent);
+  return true;
+}
+
+bool PalObjectIdTableTest() {
+  palObjectIdTableBasicTest();
+  palDenseObjectIdTableBasicTest();
+  palDenseObjectIdTableRandomTest();
+  palDenseObjectIdTableBenchmark();
+  palConcurrentObjectIdTableBasicTest();
+  palConcurrentObjectIdTableBenchmark();
+  return true;
+}
@@ -1,10 +1,1037 @@
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
 #include "libpal/pal_debug.h"
+#include "libpal/pal_allocator.h"
+#include "libpal/pal_timer.h"
+#include "libpal/pal_random.h"
 #include "libpal/pal_string.h"
+#include "libpal/pal_string_view.h"
+#include "libpal/pal_multi_pattern_matcher.h"
+#include "libpal/pal_number_format.h"
+#include "libpal/pal_number_parse.h"
+#include "libpal/pal_string_builder.h"
+#include "libpal/pal_shared_string.h"
+#include "libpal/pal_memory_stream.h"
 
 #include "pal_string_test.h"
 
 
+/* Byte at a time references for the vectorized primitives */
+static int palStringTestLength(const char* str) {
+  int length = 0;
+  while (str[length] != '\0') {
+    length++;
+  }
+  return length;
+}
+
+static int palStringTestCompare(const char* a, const char* b, int n) {
+  for (int i = 0; i < n; i++) {
+    if (a[i] != b[i] || a[i] == '\0') {
+      return (int)(unsigned char)a[i] - (int)(unsigned char)b[i];
+    }
+  }
+  return 0;
+}
+
+static int palStringTestFindCh(const char* str, char ch) {
+  for (int i = 0; str[i] != '\0'; i++) {
+    if (str[i] == ch) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int palStringTestSign(int x) {
+  return x < 0 ? -1 : (x > 0 ? 1 : 0);
+}
+
+/* Strings at every alignment, including ones that end on a page boundary */
+static bool palStringPrimitivesTest() {
+  const int kPage = 4096;
+  char* buffer = (char*)g_DefaultHeapAllocator->Allocate(kPage * 3, kPage);
+  char* other = (char*)g_DefaultHeapAllocator->Allocate(kPage * 3, kPage);
+  palMemorySetBytes(buffer, 'x', kPage * 3);
+  palMemorySetBytes(other, 'x', kPage * 3);
+  for (int length = 0; length < 80; length++) {
+    for (int offset = 0; offset < 32; offset++) {
+      // the terminator is the last byte of the second page, or offset bytes into it
+      char* str = buffer + kPage * 2 - 1 - length - offset;
+      char* copy = other + kPage + offset;
+      for (int i = 0; i < length; i++) {
+        str[i] = (char)('a' + (i * 7 + length) % 23);
+      }
+      str[length] = '\0';
+      palMemoryCopyBytes(copy, str, length + 1);
+
+      palAssertBreak(palStringLength(str) == length);
+      palAssertBreak(palStringLength(str) == palStringTestLength(str));
+      palAssertBreak(palStringCompare(str, copy) == 0);
+      palAssertBreak(palStringCompareN(str, copy, length + 5) == 0);
+      palAssertBreak(palStringFindCh(str, 'z') == -1);
+      palAssertBreak(palStringFindCh(str, '\0') == -1);
+      for (int i = 0; i < length; i++) {
+        palAssertBreak(palStringFindCh(str, str[i]) == palStringTestFindCh(str, str[i]));
+        char saved = copy[i];
+        copy[i] = saved + 1;
+        palAssertBreak(palStringTestSign(palStringCompare(str, copy)) == palStringTestSign(palStringTestCompare(str, copy, length + 1)));
+        palAssertBreak(palStringCompare(str, copy) < 0);
+        palAssertBreak(palStringCompareN(str, copy, i) == 0);
+        palAssertBreak(palStringCompareN(copy, str, i + 1) > 0);
+        copy[i] = '\0';
+        palAssertBreak(palStringCompare(str, copy) > 0);
+        palAssertBreak(palStringEquals(str, copy) == false);
+        copy[i] = saved;
+      }
+      if (length > 0) {
+        str[length - 1] = 'z';
+        palAssertBreak(palStringFindCh(str, 'z') == length - 1);
+        palAssertBreak(palStringFindChFromRight(str, 'z') == length - 1);
+        str[0] = 'z';
+        palAssertBreak(palStringFindCh(str, 'z') == 0);
+        palAssertBreak(palStringFindChFromRight(str, 'z') == length - 1);
+      }
+      palAssertBreak(palStringFindChFromRight(str, 'x') == -1);
+      palMemorySetBytes(str, 'x', length + 1);
+      palMemorySetBytes(copy, 'x', length + 1);
+    }
+  }
+  g_DefaultHeapAllocator->Deallocate(other);
+  g_DefaultHeapAllocator->Deallocate(buffer);
+  return true;
+}
+
+/* Benchmarks store their accumulators here. Without PAL_BUILD_DEBUG the
+   asserts that check them compile away and the compiler could drop calls
+   it knows are pure, like strlen and strcmp. */
+static volatile int palStringTestBenchmarkSink;
+
+/* Before: the C runtime's strlen/strcmp and the bytewise palStringFindCh loop */
+static bool palStringPrimitivesBenchmark() {
+  const int lengths[6] = { 4, 8, 24, 64, 256, 1024 };
+  const int kNumStrings = 64;
+  const int kStride = 1040;
+  const int total_bytes = 64 * 1024 * 1024;
+  // many strings at different alignments, so nothing stays in a register
+  char* a = (char*)g_DefaultHeapAllocator->Allocate(kNumStrings * kStride);
+  char* b = (char*)g_DefaultHeapAllocator->Allocate(kNumStrings * kStride);
+  // pal_string.cpp only has the SSE2 versions on x86 (Windows and Apple builds)
+#if defined(PAL_CPU_X86)
+  const char* path = "SSE2";
+#else
+  const char* path = "scalar";
+#endif
+  printf("string primitives, %s path, %d MB per cell, seconds (before / after)\n", path, total_bytes >> 20);
+  printf("%8s %22s %22s %22s\n", "length", "length", "compare", "find ch");
+  for (int l = 0; l < 6; l++) {
+    int length = lengths[l];
+    const char* strings_a[kNumStrings];
+    const char* strings_b[kNumStrings];
+    for (int s = 0; s < kNumStrings; s++) {
+      char* str_a = a + s * kStride + (s * 5) % 16;
+      char* str_b = b + s * kStride + (s * 3) % 16;
+      for (int i = 0; i < length; i++) {
+        str_a[i] = (char)('a' + (i + s) % 26);
+      }
+      str_a[length] = '\0';
+      palMemoryCopyBytes(str_b, str_a, length + 1);
+      strings_a[s] = str_a;
+      strings_b[s] = str_b;
+    }
+    int rounds = total_bytes / (length + 1);
+    // the accumulator keeps the calls from being optimized away
+    int check = 0;
+    float seconds[6];
+    palTimer timer;
+    for (int f = 0; f < 6; f++) {
+      timer.Start();
+      for (int r = 0; r < rounds; r++) {
+        const char* str_a = strings_a[r & (kNumStrings - 1)];
+        const char* str_b = strings_b[r & (kNumStrings - 1)];
+        switch (f) {
+        case 0: check += (int)strlen(str_a); break;
+        case 1: check += palStringLength(str_a); break;
+        case 2: check += strcmp(str_a, str_b); break;
+        case 3: check += palStringCompare(str_a, str_b); break;
+        case 4: check += palStringTestFindCh(str_a, '!'); break;
+        case 5: check += palStringFindCh(str_a, '!'); break;
+        }
+      }
+      timer.Stop();
+      seconds[f] = timer.GetDeltaSeconds();
+    }
+    palAssertBreak(check == 2 * rounds * length - 2 * rounds);
+    palStringTestBenchmarkSink = check;
+    printf("%8d %10f / %9f %10f / %9f %10f / %9f\n", length, seconds[0], seconds[1], seconds[2], seconds[3], seconds[4], seconds[5]);
+  }
+  g_DefaultHeapAllocator->Deallocate(b);
+  g_DefaultHeapAllocator->Deallocate(a);
+  return true;
+}
+
+static bool palStringViewTest() {
+  palDynamicString owned("  key = value  ");
+  palStringView line(owned);
+  palStringView key, value;
+  palAssertBreak(line.GetLength() == 15);
+  bool split = line.Split('=', &key, &value);
+  palAssertBreak(split);
+  key = key.TrimWhiteSpace();
+  value = value.TrimWhiteSpace();
+  palAssertBreak(key == "key");
+  palAssertBreak(value == "value");
+  palAssertBreak(value.GetPtr() == owned.C() + 8);
+  palAssertBreak(palStringEquals(key, "key"));
+  palAssertBreak(palStringEquals(key, "keys") == false);
+  palAssertBreak(palStringCompare(key, "kez") < 0 && palStringCompare(key, "ke") > 0);
+
+  palStringView path("textures/stone/albedo.png");
+  palAssertBreak(path.StartsWith("textures/"));
+  palAssertBreak(path.EndsWith(".png"));
+  palAssertBreak(path.EndsWith("textures/stone/albedo.png.png") == false);
+  palAssertBreak(path.Find('/') == 8);
+  palAssertBreak(path.FindLast('/') == 14);
+  palAssertBreak(path.Find("stone") == 9);
+  palAssertBreak(path.Find("stones") == palStringView::kNotFound);
+  palAssertBreak(path.Find("") == 0);
+  palAssertBreak(path.Substring(path.FindLast('/') + 1) == "albedo.png");
+  palAssertBreak(path.RemoveSuffix(4).RemovePrefix(9) == "stone/albedo");
+  palAssertBreak(path.Substring(100).IsEmpty());
+
+  palStringView fields("a,bc,,d");
+  palStringView field;
+  const char* expected[4] = { "a", "bc", "", "d" };
+  int num_fields = 0;
+  while (fields.NextToken(',', &field)) {
+    palAssertBreak(num_fields < 4 && field == expected[num_fields]);
+    num_fields++;
+  }
+  palAssertBreak(num_fields == 4);
+  palStringView empty_fields("");
+  bool more = empty_fields.NextToken(',', &field);
+  palAssertBreak(more && field.IsEmpty());
+  more = empty_fields.NextToken(',', &field);
+  palAssertBreak(more == false);
+
+  palDynamicString copy;
+  path.Substring(9, 5).CopyTo(&copy);
+  palAssertBreak(copy.Equals("stone"));
+  return true;
+}
+
+/* Reference for palStringFind */
+static int palStringTestFind(const char* haystack, int haystack_length, const char* needle, int needle_length) {
+  for (int i = 0; i + needle_length <= haystack_length; i++) {
+    if (memcmp(haystack + i, needle, needle_length) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static bool palStringFindTest() {
+  int start = -1, end = -1;
+  bool found = palStringFindString("hello world", "o w", &start, &end);
+  palAssertBreak(found && start == 4 && end == 7);
+  found = palStringFindString("hello", "hello!", &start, &end);
+  palAssertBreak(found == false);
+  palAssertBreak(palStringFind("abc", 3, "c", 1) == 2);
+  palAssertBreak(palStringFind("abc", 2, "c", 1) == -1);
+  palAssertBreak(palStringFind(palStringView("in the middle"), palStringView("middle")) == 7);
+
+  // small alphabets make many near misses; periodic needles exercise the long needle path
+  const int kHaystackLength = 700;
+  char haystack[kHaystackLength];
+  char needle[96];
+  for (int alphabet = 2; alphabet <= 4; alphabet++) {
+    for (int round = 0; round < 200; round++) {
+      for (int i = 0; i < kHaystackLength; i++) {
+        haystack[i] = (char)('a' + palGenerateRandom() % alphabet);
+      }
+      int needle_length = 1 + palGenerateRandom() % 80;
+      if (round & 1) {
+        // taken from the haystack, so it is found
+        int start = palGenerateRandom() % (kHaystackLength - needle_length);
+        palMemoryCopyBytes(needle, haystack + start, needle_length);
+      } else {
+        int period = 1 + palGenerateRandom() % 5;
+        for (int i = 0; i < needle_length; i++) {
+          needle[i] = (char)('a' + (i % period) % alphabet);
+        }
+      }
+      for (int length = kHaystackLength - 40; length <= kHaystackLength; length += 7) {
+        palAssertBreak(palStringFind(haystack, length, needle, needle_length) ==
+                       palStringTestFind(haystack, length, needle, needle_length));
+      }
+    }
+  }
+
+  // every position passes the first/last byte filter, long enough to fall back to Two-Way
+  const int kRunLength = 20000;
+  char* run = (char*)g_DefaultHeapAllocator->Allocate(kRunLength);
+  palMemorySetBytes(run, 'a', kRunLength);
+  palMemorySetBytes(needle, 'a', 41);
+  needle[20] = 'b';
+  palAssertBreak(palStringFind(run, kRunLength, needle, 41) == -1);
+  run[kRunLength - 21] = 'b';
+  palAssertBreak(palStringFind(run, kRunLength, needle, 41) == kRunLength - 41);
+  g_DefaultHeapAllocator->Deallocate(run);
+  return true;
+}
+
+struct palMultiPatternMatcherTestCollector {
+  int patterns[32];
+  int starts[32];
+  int count;
+  palMultiPatternMatcherTestCollector() : count(0) {
+  }
+  bool operator()(int pattern, int start) {
+    if (count < 32) {
+      patterns[count] = pattern;
+      starts[count] = start;
+    }
+    count++;
+    return true;
+  }
+};
+
+static bool palMultiPatternMatcherTest() {
+  palMultiPatternMatcher matcher;
+  matcher.SetAllocator(g_StringProxyAllocator);
+  int he = matcher.AddPattern("he");
+  int she = matcher.AddPattern("she");
+  int his = matcher.AddPattern("his");
+  int hers = matcher.AddPattern("hers");
+  int he_again = matcher.AddPattern("he");
+  palAssertBreak(he == 0 && she == 1 && his == 2 && hers == 3 && he_again == 4);
+  matcher.Build();
+  palAssertBreak(matcher.GetNumPatterns() == 5);
+
+  // ushers: she and he end together, the longer one first, then hers
+  palMultiPatternMatcherTestCollector collector;
+  const char* text = "ushers";
+  int matches = matcher.Scan(text, 6, collector);
+  palAssertBreak(matches == 4);
+  palAssertBreak(collector.patterns[0] == 1 && collector.starts[0] == 1);
+  palAssertBreak(collector.patterns[1] == 0 && collector.starts[1] == 2);
+  palAssertBreak(collector.patterns[2] == 4 && collector.starts[2] == 2);
+  palAssertBreak(collector.patterns[3] == 3 && collector.starts[3] == 2);
+
+  int pattern = -1, start = -1;
+  bool found = matcher.FindFirst(text, 6, &pattern, &start);
+  palAssertBreak(found && pattern == 1 && start == 1);
+  found = matcher.FindFirst("this", 4, &pattern, &start);
+  palAssertBreak(found && pattern == 2 && start == 1);
+  palAssertBreak(matcher.Contains("xyz hs", 6) == false);
+  palAssertBreak(matcher.Contains("", 0) == false);
+
+  // same text split in two: the match across the split starts in the first piece
+  palMultiPatternMatcherTestCollector streamed;
+  int state = 0;
+  matcher.Scan(text, 3, streamed, &state);
+  palAssertBreak(streamed.count == 0);
+  matcher.Scan(text + 3, 3, streamed, &state);
+  palAssertBreak(streamed.count == 4);
+  palAssertBreak(streamed.patterns[0] == 1 && streamed.starts[0] == -2);
+  palAssertBreak(streamed.patterns[3] == 3 && streamed.starts[3] == -1);
+
+  // against palStringFind on random text over a small alphabet
+  matcher.Reset();
+  const char* words[6] = { "abab", "ba", "bbb", "aabba", "b", "cab" };
+  for (int w = 0; w < 6; w++) {
+    matcher.AddPattern(words[w]);
+  }
+  matcher.Build();
+  char random_text[256];
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < 256; i++) {
+      random_text[i] = (char)('a' + palGenerateRandom() % 3);
+    }
+    int expected = 0;
+    for (int w = 0; w < 6; w++) {
+      int length = palStringLength(words[w]);
+      for (int i = 0; i + length <= 256; i++) {
+        if (palStringFind(random_text + i, 256 - i, words[w], length) == 0) {
+          expected++;
+        }
+      }
+    }
+    palMultiPatternMatcherTestCollector counter;
+    matches = matcher.Scan(random_text, 256, counter);
+    palAssertBreak(matches == expected);
+    palAssertBreak(counter.count == expected);
+  }
+
+  // patterns that use all 256 byte values leave no byte for the no-pattern class
+  matcher.Reset();
+  char all_bytes[256];
+  for (int i = 0; i < 256; i++) {
+    all_bytes[i] = (char)i;
+  }
+  const char high_x[2] = { (char)0xff, 'x' };
+  const char low_x[2] = { (char)0x00, 'x' };
+  matcher.AddPattern(all_bytes, 256);
+  matcher.AddPattern(high_x, 2);
+  matcher.Build();
+  palAssertBreak(matcher.Contains(high_x, 2));
+  palAssertBreak(matcher.Contains(low_x, 2) == false);
+  palAssertBreak(matcher.Contains(all_bytes, 256));
+  palAssertBreak(matcher.Contains(all_bytes + 1, 255) == false);
+  return true;
+}
+
+struct palMultiPatternMatcherTestCounter {
+  int count;
+  palMultiPatternMatcherTestCounter() : count(0) {
+  }
+  bool operator()(int, int) {
+    count++;
+    return true;
+  }
+};
+
+/* Before: the bytewise search, and one palStringFind pass per pattern */
+static bool palStringSearchBenchmark() {
+  const int kTextLength = 1024 * 1024;
+  char* text = (char*)g_DefaultHeapAllocator->Allocate(kTextLength);
+  for (int i = 0; i < kTextLength; i++) {
+    // letters and spaces, roughly like prose
+    uint32_t r = palGenerateRandom();
+    text[i] = (r % 6) == 0 ? ' ' : (char)('a' + (r >> 8) % 26);
+  }
+  const char* needles[4] = { "q", "the", "performance", "a needle that is long enough to take the long path" };
+  palTimer timer;
+  printf("substring search, 1 MB x 8, seconds (before / after)\n");
+  for (int n = 0; n < 4; n++) {
+    int needle_length = palStringLength(needles[n]);
+    int check[2] = { 0, 0 };
+    float seconds[2];
+    for (int f = 0; f < 2; f++) {
+      timer.Start();
+      for (int r = 0; r < 8; r++) {
+        int start = 0;
+        for (;;) {
+          int found = f == 0 ? palStringTestFind(text + start, kTextLength - start, needles[n], needle_length)
+                             : palStringFind(text + start, kTextLength - start, needles[n], needle_length);
+          if (found < 0) {
+            break;
+          }
+          check[f]++;
+          start += found + 1;
+        }
+      }
+      timer.Stop();
+      seconds[f] = timer.GetDeltaSeconds();
+    }
+    palAssertBreak(check[0] == check[1]);
+    printf("%3d bytes %10f / %9f (%d found)\n", needle_length, seconds[0], seconds[1], check[1] / 8);
+  }
+
+  // one palStringFind pass per pattern against one matcher pass
+  const int pattern_counts[3] = { 8, 32, 128 };
+  char patterns[128][4];
+  for (int p = 0; p < 128; p++) {
+    for (int i = 0; i < 4; i++) {
+      patterns[p][i] = (char)('a' + palGenerateRandom() % 26);
+    }
+  }
+  printf("multiple 4 byte patterns, 1 MB, seconds (before / after)\n");
+  for (int c = 0; c < 3; c++) {
+    int num_patterns = pattern_counts[c];
+    palMultiPatternMatcher matcher;
+    matcher.SetAllocator(g_DefaultHeapAllocator);
+    for (int p = 0; p < num_patterns; p++) {
+      matcher.AddPattern(patterns[p], 4);
+    }
+    matcher.Build();
+    int found_before = 0;
+    timer.Start();
+    for (int p = 0; p < num_patterns; p++) {
+      int start = 0;
+      int found;
+      while ((found = palStringFind(text + start, kTextLength - start, patterns[p], 4)) >= 0) {
+        found_before++;
+        start += found + 1;
+      }
+    }
+    timer.Stop();
+    float before = timer.GetDeltaSeconds();
+    palMultiPatternMatcherTestCounter counter;
+    timer.Start();
+    int found_after = matcher.Scan(text, kTextLength, counter);
+    timer.Stop();
+    palAssertBreak(found_before == found_after);
+    printf("%3d patterns %10f / %9f (%d found)\n", num_patterns, before, timer.GetDeltaSeconds(), found_after);
+  }
+  g_DefaultHeapAllocator->Deallocate(text);
+  return true;
+}
+
+static bool palNumberFormatTest() {
+  char buffer[kPalFormatFloatBufferSize];
+  char expected[64];
+  const int64_t ints[9] = { 0, 9, 10, -99, 100, 4294967295LL, 4294967296LL, 9223372036854775807LL, -9223372036854775807LL - 1 };
+  for (int i = 0; i < 9; i++) {
+    palStringPrintf(expected, sizeof(expected), "%lld", (long long)ints[i]);
+    int length = palFormatInt(buffer, ints[i]);
+    palAssertBreak(length == palStringLength(expected));
+    palAssertBreak(palStringEquals(buffer, expected));
+  }
+  int length = palFormatUint(buffer, 18446744073709551615ULL);
+  palAssertBreak(length == 20);
+  palAssertBreak(palStringEquals(buffer, "18446744073709551615"));
+  for (int i = 0; i < 10000; i++) {
+    // all digit counts, not just the ten and more that uniform values give
+    uint64_t value = ((uint64_t)palGenerateRandom() << 32 | palGenerateRandom()) >> (palGenerateRandom() % 64);
+    palStringPrintf(expected, sizeof(expected), "%llu", (unsigned long long)value);
+    palFormatUint(buffer, value);
+    palAssertBreak(palStringEquals(buffer, expected));
+  }
+
+  struct {
+    double value;
+    const char* text;
+  } doubles[] = {
+    { 0.0, "0" }, { -0.0, "-0" }, { 1.5, "1.5" }, { 100.0, "100" }, { 0.1, "0.1" }, { -123456.789, "-123456.789" },
+    { 1e20, "100000000000000000000" }, { 1e21, "1e+21" }, { 1e-6, "0.000001" }, { 1.25e-7, "1.25e-7" },
+    { 5e-324, "5e-324" }, { 1.7976931348623157e308, "1.7976931348623157e+308" }, { 2.2250738585072014e-308, "2.2250738585072014e-308" },
+  };
+  for (int i = 0; i < (int)(sizeof(doubles) / sizeof(doubles[0])); i++) {
+    length = palFormatDouble(buffer, doubles[i].value);
+    palAssertBreak(length == palStringLength(doubles[i].text));
+    palAssertBreak(palStringEquals(buffer, doubles[i].text));
+  }
+  double zero = 0.0;
+  palFormatDouble(buffer, 1.0 / zero);
+  palAssertBreak(palStringEquals(buffer, "inf"));
+  palFormatDouble(buffer, -1.0 / zero);
+  palAssertBreak(palStringEquals(buffer, "-inf"));
+  palFormatDouble(buffer, zero / zero);
+  palAssertBreak(palStringEquals(buffer, "nan"));
+  palFormatFloat(buffer, 0.1f);
+  palAssertBreak(palStringEquals(buffer, "0.1"));
+  palFormatFloat(buffer, 3.4028235e38f);
+  palAssertBreak(palStringEquals(buffer, "3.4028235e+38"));
+  palFormatFloat(buffer, 1e-45f);
+  palAssertBreak(palStringEquals(buffer, "1e-45"));
+
+  // random bit patterns read back to the same bits
+  for (int i = 0; i < 100000; i++) {
+    uint64_t bits = (uint64_t)palGenerateRandom() << 32 | palGenerateRandom();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    if (value != value || value - value != 0.0) {
+      continue;
+    }
+    length = palFormatDouble(buffer, value);
+    palAssertBreak(length < kPalFormatFloatBufferSize && buffer[length] == '\0');
+    double parsed = strtod(buffer, NULL);
+    palAssertBreak(memcmp(&parsed, &value, sizeof(value)) == 0);
+
+    uint32_t float_bits = palGenerateRandom();
+    float float_value;
+    memcpy(&float_value, &float_bits, sizeof(float_value));
+    if (float_value != float_value || float_value - float_value != 0.0f) {
+      continue;
+    }
+    palFormatFloat(buffer, float_value);
+    float float_parsed = (float)strtod(buffer, NULL);
+    palAssertBreak(memcmp(&float_parsed, &float_value, sizeof(float_value)) == 0);
+  }
+
+  palDynamicString s;
+  s.Append("x=");
+  s.AppendInt(-42);
+  s.Append(' ');
+  s.AppendFloat(0.25f);
+  palAssertBreak(s.Equals("x=-42 0.25"));
+  // crosses from the inline buffer to the heap
+  palDynamicString printed;
+  for (int i = 0; i < 20; i++) {
+    s.AppendUint(1234567890123ULL * i);
+    s.AppendDouble(i / 3.0);
+  }
+  for (int i = 0; i < 20; i++) {
+    palFormatUint(buffer, 1234567890123ULL * i);
+    printed.Append(buffer);
+    palFormatDouble(buffer, i / 3.0);
+    printed.Append(buffer);
+  }
+  palAssertBreak(s.GetLength() == 10 + printed.GetLength());
+  palAssertBreak(palStringEquals(s.C() + 10, printed.C()));
+  return true;
+}
+
+/* Before: printf formatting */
+static bool palNumberFormatBenchmark() {
+  const int kCount = 1000000;
+  char buffer[64];
+  int check[2] = { 0, 0 };
+  float seconds[6];
+  palTimer timer;
+  for (int f = 0; f < 2; f++) {
+    timer.Start();
+    for (int i = 0; i < kCount; i++) {
+      int64_t value = (int64_t)i * 7919 - 3000000000LL;
+      check[f] += f == 0 ? palStringPrintf(buffer, sizeof(buffer), "%lld", (long long)value) : palFormatInt(buffer, value);
+    }
+    timer.Stop();
+    seconds[f] = timer.GetDeltaSeconds();
+  }
+  palAssertBreak(check[0] == check[1]);
+  for (int f = 0; f < 2; f++) {
+    timer.Start();
+    for (int i = 0; i < kCount; i++) {
+      double value = (i + 1) * 0.0123456789;
+      check[f] += f == 0 ? palStringPrintf(buffer, sizeof(buffer), "%.17g", value) : palFormatDouble(buffer, value);
+    }
+    timer.Stop();
+    seconds[2 + f] = timer.GetDeltaSeconds();
+  }
+  for (int f = 0; f < 2; f++) {
+    palDynamicString line;
+    timer.Start();
+    for (int i = 0; i < kCount; i++) {
+      if ((i & 15) == 0) {
+        line.SetLength(0);
+      }
+      if (f == 0) {
+        line.AppendPrintf("%d", i);
+      } else {
+        line.AppendInt(i);
+      }
+    }
+    timer.Stop();
+    seconds[4 + f] = timer.GetDeltaSeconds();
+  }
+  printf("number formatting, %d values, seconds (before / after)\n", kCount);
+  printf("%-16s %10f / %9f\n", "int", seconds[0], seconds[1]);
+  printf("%-16s %10f / %9f (%%.17g)\n", "double", seconds[2], seconds[3]);
+  printf("%-16s %10f / %9f\n", "append int", seconds[4], seconds[5]);
+  return true;
+}
+
+static bool palNumberParseTest() {
+  uint64_t u = 0;
+  int64_t s = 0;
+  int consumed = 0;
+  int result = palParseUint64("18446744073709551615", 20, &u);
+  palAssertBreak(result == PAL_OK && u == 18446744073709551615ULL);
+  result = palParseUint64("18446744073709551616", 20, &u, &consumed);
+  palAssertBreak(result == PAL_NUMBER_ERROR_RANGE);
+  palAssertBreak(u == 18446744073709551615ULL && consumed == 20);
+  result = palParseUint64("000000000000000000000000123", 27, &u);
+  palAssertBreak(result == PAL_OK && u == 123);
+  result = palParseUint64("12345678901234567890123", 23, &u);
+  palAssertBreak(result == PAL_NUMBER_ERROR_RANGE);
+  result = palParseUint64("-1", 2, &u);
+  palAssertBreak(result == PAL_NUMBER_ERROR_SYNTAX);
+  result = palParseInt64("-9223372036854775808", 20, &s);
+  palAssertBreak(result == PAL_OK && s == -9223372036854775807LL - 1);
+  result = palParseInt64("-9223372036854775809", 20, &s);
+  palAssertBreak(result == PAL_NUMBER_ERROR_RANGE && s == -9223372036854775807LL - 1);
+  result = palParseInt64("9223372036854775808", 19, &s);
+  palAssertBreak(result == PAL_NUMBER_ERROR_RANGE && s == 9223372036854775807LL);
+  result = palParseInt64("+42abc", 6, &s, &consumed);
+  palAssertBreak(result == PAL_OK && s == 42 && consumed == 3);
+  // the length is respected, nothing needs a terminator
+  result = palParseInt64("123456789012", 10, &s);
+  palAssertBreak(result == PAL_OK && s == 1234567890);
+  result = palParseInt64("-", 1, &s, &consumed);
+  palAssertBreak(result == PAL_NUMBER_ERROR_SYNTAX && consumed == 0);
+  result = palParseInt64("", 0, &s);
+  palAssertBreak(result == PAL_NUMBER_ERROR_SYNTAX);
+  char buffer[64];
+  for (int i = 0; i < 10000; i++) {
+    int64_t value = (int64_t)((uint64_t)palGenerateRandom() << 32 | palGenerateRandom()) >> (palGenerateRandom() % 64);
+    int length = palFormatInt(buffer, value);
+    result = palParseInt64(buffer, length, &s, &consumed);
+    palAssertBreak(result == PAL_OK && s == value && consumed == length);
+  }
+
+  struct {
+    const char* text;
+    double value;
+    int consumed;
+  } doubles[] = {
+    { "0.1", 0.1, 3 }, { "-2.5e-3", -0.0025, 7 }, { ".5", 0.5, 2 }, { "5.", 5.0, 2 }, { "0.1e1", 1.0, 5 },
+    { "1e", 1.0, 1 }, { "1e+", 1.0, 1 }, { "7E2x", 700.0, 3 }, { "1e308", 1e308, 5 },
+    { "4.9e-324", 4.9e-324, 8 }, { "2.2250738585072011e-308", 2.2250738585072011e-308, 23 },
+    { "1.7976931348623157e308", 1.7976931348623157e308, 22 }, { "1e-400", 0.0, 6 },
+    // 2^53 + 1 is halfway and rounds to even, anything above it rounds up
+    { "9007199254740993", 9007199254740992.0, 16 },
+    { "9007199254740993.0000000000000000001", 9007199254740994.0, 36 },
+    { "9007199254740992.9999999999999999999", 9007199254740992.0, 36 },
+    // halfway to the smallest subnormal
+    { "2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667994968324049705821028513185451396213837722826145437693412532098591327667236328125e-324", 0.0, 0 },
+  };
+  double d = 0.0;
+  for (int i = 0; i < (int)(sizeof(doubles) / sizeof(doubles[0])); i++) {
+    int length = palStringLength(doubles[i].text);
+    result = palParseDouble(doubles[i].text, length, &d, &consumed);
+    palAssertBreak(result == PAL_OK);
+    palAssertBreak(d == doubles[i].value);
+    palAssertBreak(doubles[i].consumed == 0 || consumed == doubles[i].consumed);
+  }
+  result = palParseDouble("1e309", 5, &d);
+  palAssertBreak(result == PAL_OK && d > 1.7976931348623157e308);
+  result = palParseDouble("-0", 2, &d);
+  palAssertBreak(result == PAL_OK && d == 0.0 && 1.0 / d < 0.0);
+  result = palParseDouble("-.e5", 4, &d, &consumed);
+  palAssertBreak(result == PAL_NUMBER_ERROR_SYNTAX && consumed == 0);
+
+  // shortest forms of random doubles, and random digit strings against the C library
+  for (int i = 0; i < 100000; i++) {
+    uint64_t bits = (uint64_t)palGenerateRandom() << 32 | palGenerateRandom();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    if (value != value || value - value != 0.0) {
+      continue;
+    }
+    int length = palFormatDouble(buffer, value);
+    result = palParseDouble(buffer, length, &d);
+    palAssertBreak(result == PAL_OK && memcmp(&d, &value, sizeof(d)) == 0);
+
+    int num_digits = 1 + palGenerateRandom() % 30;
+    for (int j = 0; j < num_digits; j++) {
+      buffer[j] = (char)('0' + palGenerateRandom() % 10);
+    }
+    length = num_digits + palStringPrintf(buffer + num_digits, 16, "e%d", (int)(palGenerateRandom() % 700) - 350);
+    value = strtod(buffer, NULL);
+    result = palParseDouble(buffer, length, &d);
+    palAssertBreak(result == PAL_OK && memcmp(&d, &value, sizeof(d)) == 0);
+  }
+  return true;
+}
+
+/* Before: the C library, which also needs the text terminated */
+static bool palNumberParseBenchmark() {
+  const int kCount = 1 << 20;
+  const int kStride = 32;
+  char* texts = (char*)g_DefaultHeapAllocator->Allocate(kCount * kStride);
+  int* lengths = (int*)g_DefaultHeapAllocator->Allocate(kCount * sizeof(int));
+  float seconds[4];
+  palTimer timer;
+  for (int kind = 0; kind < 2; kind++) {
+    for (int i = 0; i < kCount; i++) {
+      if (kind == 0) {
+        lengths[i] = palFormatInt(texts + i * kStride, (int64_t)((uint64_t)palGenerateRandom() * palGenerateRandom()) >> (palGenerateRandom() % 48));
+      } else {
+        lengths[i] = palFormatDouble(texts + i * kStride, (palGenerateRandom() % 1000000) / 1000.0 + palGenerateRandom());
+      }
+    }
+    double check[2] = { 0.0, 0.0 };
+    for (int f = 0; f < 2; f++) {
+      timer.Start();
+      for (int i = 0; i < kCount; i++) {
+        const char* text = texts + i * kStride;
+        if (kind == 0) {
+          int64_t value = 0;
+          if (f == 0) {
+            value = strtoll(text, NULL, 10);
+          } else {
+            palParseInt64(text, lengths[i], &value);
+          }
+          check[f] += (double)value;
+        } else {
+          double value = 0.0;
+          if (f == 0) {
+            value = strtod(text, NULL);
+          } else {
+            palParseDouble(text, lengths[i], &value);
+          }
+          check[f] += value;
+        }
+      }
+      timer.Stop();
+      seconds[kind * 2 + f] = timer.GetDeltaSeconds();
+    }
+    palAssertBreak(check[0] == check[1]);
+  }
+  printf("number parsing, %d values, seconds (before / after)\n", kCount);
+  printf("%-16s %10f / %9f (strtoll)\n", "int64", seconds[0], seconds[1]);
+  printf("%-16s %10f / %9f (strtod)\n", "double", seconds[2], seconds[3]);
+  g_DefaultHeapAllocator->Deallocate(lengths);
+  g_DefaultHeapAllocator->Deallocate(texts);
+  return true;
+}
+
+static bool palStringBuilderTest() {
+  palStringBuilder builder;
+  builder.SetAllocator(g_DefaultHeapAllocator);
+  builder.SetChunkSize(16);
+  palDynamicString expected;
+  char buffer[kPalFormatFloatBufferSize];
+  for (int i = 0; i < 200; i++) {
+    builder.Append("item ");
+    builder.AppendInt(i - 100);
+    builder.Append(',');
+    builder.AppendDouble(i / 8.0);
+    builder.AppendPrintf(" [%s %d]\n", (i % 7) == 0 ? "a formatted piece longer than one chunk" : "x", i);
+    expected.Append("item ");
+    expected.AppendInt(i - 100);
+    expected.Append(',');
+    palFormatDouble(buffer, i / 8.0);
+    expected.Append(buffer);
+    expected.AppendPrintf(" [%s %d]\n", (i % 7) == 0 ? "a formatted piece longer than one chunk" : "x", i);
+  }
+  palStringView long_piece("a piece of text that needs a few chunks to itself");
+  builder.Append(long_piece);
+  expected.Append(long_piece.GetPtr(), long_piece.GetLength());
+  palAssertBreak(builder.GetLength() == (uint64_t)expected.GetLength());
+  palAssertBreak(builder.GetNumChunks() > 1);
+
+  palDynamicString copy;
+  builder.CopyTo(&copy);
+  palAssertBreak(copy.Equals(expected));
+
+  char small[10];
+  uint64_t copied = builder.CopyTo(small, sizeof(small));
+  palAssertBreak(copied == 9);
+  palAssertBreak(palStringEquals(small, "item -100"));
+
+  // spans in groups, like a vectored write limited to a few buffers at a time
+  palStringBuilderSpan spans[4];
+  int offset = 0;
+  int num_spans = 0;
+  const void* cursor = builder.GetSpansCursor();
+  while (cursor != NULL) {
+    int count = builder.GetSpans(spans, 4, &cursor);
+    palAssertBreak(count > 0 && count <= 4);
+    palAssertBreak(count == 4 || cursor == NULL);
+    num_spans += count;
+    for (int i = 0; i < count; i++) {
+      palAssertBreak(spans[i].length <= (size_t)(expected.GetLength() - offset));
+      palAssertBreak(memcmp(spans[i].data, expected.C() + offset, spans[i].length) == 0);
+      offset += (int)spans[i].length;
+    }
+  }
+  palAssertBreak(offset == expected.GetLength());
+  palAssertBreak(num_spans == builder.GetNumChunks());
+
+  palMemoryStream stream;
+  stream.Create(g_DefaultHeapAllocator, 64);
+  int result = builder.WriteTo(&stream);
+  palAssertBreak(result == 0);
+  palMemBlob blob;
+  stream.GetBlob(&blob);
+  palAssertBreak(stream.GetLength() == builder.GetLength());
+  palAssertBreak(memcmp(blob.GetPtr(), expected.C(), expected.GetLength()) == 0);
+  stream.Reset();
+
+  builder.Clear();
+  palAssertBreak(builder.IsEmpty() && builder.GetNumChunks() == 1);
+  builder.Append("reused");
+  builder.CopyTo(&copy);
+  palAssertBreak(copy.Equals("reused") && builder.GetNumChunks() == 1);
+  builder.Reset();
+  palAssertBreak(builder.GetNumChunks() == 0);
+  return true;
+}
+
+struct palCountingTestAllocator : public palAllocatorInterface {
+  palAllocatorInterface* parent;
+  int allocations;
+  int live;
+  explicit palCountingTestAllocator(palAllocatorInterface* parent_) : palAllocatorInterface("counting test"), parent(parent_), allocations(0), live(0) {
+  }
+  void* Allocate(uint64_t size, uint32_t alignment) {
+    allocations++;
+    live++;
+    return parent->Allocate(size, alignment);
+  }
+  void Deallocate(void* ptr) {
+    if (ptr != NULL) {
+      live--;
+    }
+    parent->Deallocate(ptr);
+  }
+  uint64_t GetSize(void* ptr) const {
+    return parent->GetSize(ptr);
+  }
+};
+
+/* Before: one palDynamicString that doubles as it grows */
+static bool palStringBuilderBenchmark() {
+  const int kLines = 400000;
+  palTimer timer;
+  timer.Start();
+  palDynamicString text;
+  for (int i = 0; i < kLines; i++) {
+    text.Append("{\"id\": ");
+    text.AppendInt(i);
+    text.Append(", \"name\": \"entry\"},\n");
+  }
+  timer.Stop();
+  float before = timer.GetDeltaSeconds();
+
+  palCountingTestAllocator counting(g_DefaultHeapAllocator);
+  timer.Start();
+  {
+    palStringBuilder builder;
+    builder.SetAllocator(&counting);
+    for (int i = 0; i < kLines; i++) {
+      builder.Append("{\"id\": ");
+      builder.AppendInt(i);
+      builder.Append(", \"name\": \"entry\"},\n");
+    }
+    palAssertBreak(builder.GetLength() == (uint64_t)text.GetLength());
+  }
+  timer.Stop();
+  printf("string builder, %d MB of lines, seconds (before / after): %f / %f, %d chunk allocations\n",
+         text.GetLength() >> 20, before, timer.GetDeltaSeconds(), counting.allocations);
+  return true;
+}
+
+static void palSharedStringTestTable(palAllocatorInterface* allocator) {
+  palSharedStringTable table;
+  table.SetAllocator(allocator);
+  palSharedString empty = table.Intern(palStringView(""));
+  palAssertBreak(empty.IsEmpty());
+
+  char buffer[32];
+  palStringCopy(buffer, "interned");
+  palSharedString a = table.Intern(palStringView(buffer));
+  palStringCopy(buffer, "XXXXXXXX");
+  palSharedString b = table.Intern(palStringView("interned"));
+  palAssertBreak(a.IsSameInstance(b) && palStringEquals(a.C(), "interned"));
+  /* a, b and the table */
+  palAssertBreak(a.GetReferenceCount() == 3);
+  palAssertBreak(table.GetSize() == 1);
+  palAssertBreak(table.Find(palStringView("interned")).IsSameInstance(a));
+  palAssertBreak(table.Find(palStringView("missing")).IsEmpty());
+
+  /* An existing palSharedString becomes the interned copy without copying */
+  palSharedString own(palStringView("adopted"), allocator);
+  palSharedString adopted = table.Intern(own);
+  palAssertBreak(adopted.IsSameInstance(own));
+  palSharedString interned = table.Intern(palStringView("adopted"));
+  palAssertBreak(interned.IsSameInstance(own));
+  palSharedString duplicate(palStringView("interned"), allocator);
+  interned = table.Intern(duplicate);
+  palAssertBreak(interned.IsSameInstance(a));
+  interned.Reset();
+  palAssertBreak(table.GetSize() == 2);
+
+  for (int i = 0; i < 100; i++) {
+    palStringPrintf(buffer, sizeof(buffer), "temporary %d", i);
+    table.Intern(palStringView(buffer));
+  }
+  palAssertBreak(table.GetSize() == 102);
+  int purged = table.Purge();
+  palAssertBreak(purged == 100);
+  palAssertBreak(table.GetSize() == 2);
+  palAssertBreak(table.Find(palStringView("temporary 7")).IsEmpty());
+  own.Reset();
+  adopted.Reset();
+  purged = table.Purge();
+  palAssertBreak(purged == 1);
+  palAssertBreak(table.Find(palStringView("interned")).IsSameInstance(a));
+
+  table.Reset();
+  palAssertBreak(table.GetSize() == 0 && a.GetReferenceCount() == 2);
+  palAssertBreak(palStringEquals(b.C(), "interned"));
+}
+
+static bool palSharedStringTest() {
+  palSharedString empty;
+  palAssertBreak(empty.IsEmpty() && empty.GetLength() == 0 && empty.C()[0] == '\0');
+  palAssertBreak(empty.GetHash() == palHash64(NULL, 0));
+  palAssertBreak(empty.GetReferenceCount() == 0);
+  palAssertBreak(palSharedString(palStringView("")).IsEmpty());
+
+  palCountingTestAllocator counting(g_DefaultHeapAllocator);
+  {
+    palSharedString a(palStringView("shared text"), &counting);
+    palAssertBreak(counting.allocations == 1);
+    palAssertBreak(a.GetLength() == 11 && palStringEquals(a.C(), "shared text"));
+    palAssertBreak(a.GetHash() == palHash64("shared text", 11));
+    palAssertBreak(a.GetHash() == palHashFunction<palStringView>()(palStringView("shared text")));
+    palAssertBreak(a.GetReferenceCount() == 1);
+    {
+      palSharedString b(a);
+      palSharedString c;
+      c = b;
+      palAssertBreak(counting.allocations == 1);
+      palAssertBreak(a.GetReferenceCount() == 3);
+      palAssertBreak(c.IsSameInstance(a) && c.C() == a.C());
+      c = c;
+      palAssertBreak(a.GetReferenceCount() == 3);
+      c.Reset();
+      palAssertBreak(c.IsEmpty() && a.GetReferenceCount() == 2);
+    }
+    palAssertBreak(a.GetReferenceCount() == 1);
+
+    palSharedString d(palStringView("shared text"), &counting);
+    palSharedString e(palStringView("shared texT"), &counting);
+    palAssertBreak(d.IsSameInstance(a) == false);
+    palAssertBreak(d == a && d != e && a != empty);
+    palAssertBreak(palStringView("shared text") == a);
+    d.Swap(e);
+    palAssertBreak(palStringEquals(d.C(), "shared texT") && palStringEquals(e.C(), "shared text"));
+  }
+  palAssertBreak(counting.allocations == 3 && counting.live == 0);
+
+  palSharedStringTestTable(&counting);
+  palAssertBreak(counting.live == 0);
+  return true;
+}
+
+/* Strings fanned out to many holders: palDynamicString copies the characters
+ * each time, palSharedString only bumps the reference count.
+ */
+static bool palSharedStringBenchmark() {
+  const int kStrings = 256;
+  const int kHolders = 512;
+  palDynamicString sources[kStrings];
+  for (int i = 0; i < kStrings; i++) {
+    for (int j = 0; j < 4; j++) {
+      sources[i].AppendPrintf("/assets/textures/level_%d/section_%d/", i, j);
+    }
+  }
+  palTimer timer;
+  timer.Start();
+  {
+    palArray<palDynamicString> holders;
+    holders.SetAllocator(g_DefaultHeapAllocator);
+    holders.Resize(kStrings * kHolders);
+    for (int h = 0; h < kHolders; h++) {
+      for (int i = 0; i < kStrings; i++) {
+        holders[h * kStrings + i] = sources[i];
+      }
+    }
+  }
+  timer.Stop();
+  float before = timer.GetDeltaSeconds();
+
+  palSharedString shared[kStrings];
+  for (int i = 0; i < kStrings; i++) {
+    shared[i] = palSharedString(palStringView(sources[i]));
+  }
+  timer.Start();
+  {
+    palArray<palSharedString> holders;
+    holders.SetAllocator(g_DefaultHeapAllocator);
+    holders.Resize(kStrings * kHolders);
+    for (int h = 0; h < kHolders; h++) {
+      for (int i = 0; i < kStrings; i++) {
+        holders[h * kStrings + i] = shared[i];
+      }
+    }
+  }
+  timer.Stop();
+  printf("string fan out, %d strings to %d holders, seconds (palDynamicString / palSharedString): %f / %f\n",
+         kStrings, kHolders, before, timer.GetDeltaSeconds());
+  return true;
+}
+
+
 bool PalStringTest() {
+  palStringPrimitivesTest();
+  palStringPrimitivesBenchmark();
+
   {
     palDynamicString s28_2;
     s28_2;
@@ -53,7 +1080,7 @@ bool PalStringTest() {
       return false;
     }
   }
-  return true;
+
   palDynamicString empty64;
   empty64.SetCapacity(64);
   if (empty64.GetCapacity() != 64) {
@@ -171,5 +1198,88 @@ bool PalStringTest() {
     return false;
   }
 
+  // short strings stay inside the object, longer ones move to the heap and back
+  palDynamicString grow_str;
+  for (int i = 0; i < palDynamicString::kInlineCapacity - 1; i++) {
+    grow_str.Append((char)('a' + i));
+  }
+  if (grow_str.GetCapacity() != palDynamicString::kInlineCapacity) {
+    palBreakHere();
+    return false;
+  }
+  grow_str.Append("XYZ");
+  if (grow_str.GetCapacity() <= palDynamicString::kInlineCapacity) {
+    palBreakHere();
+    return false;
+  }
+  if (grow_str.Equals("abcdefghijklmnopqrstuvwXYZ") == false) {
+    palBreakHere();
+    return false;
+  }
+  palDynamicString long_copy(grow_str);
+  if (long_copy != grow_str) {
+    palBreakHere();
+    return false;
+  }
+  grow_str.SetCapacity(8);
+  if (grow_str.GetCapacity() != palDynamicString::kInlineCapacity || grow_str.Equals("abcdefghijklmnopqrstuvw") == false) {
+    palBreakHere();
+    return false;
+  }
+  grow_str.Reset();
+  if (grow_str.GetLength() != 0 || grow_str.Equals("") == false) {
+    palBreakHere();
+    return false;
+  }
+
+  palDynamicString printf_long;
+  printf_long.SetPrintf("%d", 12345);
+  printf_long.AppendPrintf(" %s %s", "a string that will not fit", "inline");
+  if (printf_long.Equals("12345 a string that will not fit inline") == false) {
+    palBreakHere();
+    return false;
+  }
+  printf_long.Cut(5, 100);
+  if (printf_long.Equals("12345") == false || printf_long.GetLength() != 5) {
+    palBreakHere();
+    return false;
+  }
+
+  // printf arguments may point into the string being formatted
+  palDynamicString printf_self;
+  printf_self.Set("abc");
+  printf_self.AppendPrintf("-%s-%s", printf_self.C(), printf_self.C());
+  if (printf_self.Equals("abc-abc-abc") == false) {
+    palBreakHere();
+    return false;
+  }
+  printf_self.SetPrintf("[%s]", printf_self.C());
+  if (printf_self.Equals("[abc-abc-abc]") == false) {
+    palBreakHere();
+    return false;
+  }
+  // longer than the stack scratch and than the current capacity
+  palDynamicString printf_self_long;
+  for (int i = 0; i < 40; i++) {
+    printf_self_long.Append("0123456789");
+  }
+  printf_self_long.AppendPrintf("%s", printf_self_long.C());
+  if (printf_self_long.GetLength() != 800 || palStringEqualsN(printf_self_long.C(), printf_self_long.C() + 400, 400) == false) {
+    palBreakHere();
+    return false;
+  }
+
+  palStringViewTest();
+  palStringFindTest();
+  palMultiPatternMatcherTest();
+  palStringSearchBenchmark();
+  palNumberFormatTest();
+  palNumberFormatBenchmark();
+  palNumberParseTest();
+  palNumberParseBenchmark();
+  palStringBuilderTest();
+  palStringBuilderBenchmark();
+  palSharedStringTest();
+  palSharedStringBenchmark();
   return true;
 }
\ No newline at end of file
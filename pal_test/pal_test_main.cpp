@@ -15,6 +15,10 @@
 #include "pal_heap_allocator_test.h"
 #include "pal_process_test.h"
 #include "pal_blob_test.h"
+#include "pal_hash_test.h"
+#include "pal_filter_test.h"
+#include "pal_hdr_histogram_test.h"
+#include "pal_external_sort_test.h"
 
 int main(int argc, char** argv) {
   palStartup(windows_debugger_print_function);
@@ -26,9 +30,13 @@ int main(int argc, char** argv) {
   PalAlgorithmsTest();
   PalProcessTest();
   PalContainerTest();
+  PalHashTest();
+  PalFilterTest();
   PalStringTest();
   PalFileTest();
+  PalExternalSortTest();
   PalThreadTest();
+  PalHdrHistogramTest();
   PalJsonTest();
   PalObjectIdTableTest();
   PalEventTest();
@@ -49,6 +49,126 @@ void thread_countdown(uintptr_t seven) {
   palThread::Exit(0);
 }
 
+struct palTripleBufferTestSnapshot {
+  uint32_t sequence;
+  uint32_t values[31];
+};
+
+static palTripleBuffer<palTripleBufferTestSnapshot> triple_buffer;
+static const uint32_t kTripleBufferTestSnapshots = 200000;
+
+void triple_buffer_writer(uintptr_t ignored) {
+  for (uint32_t sequence = 1; sequence <= kTripleBufferTestSnapshots; sequence++) {
+    palTripleBufferTestSnapshot* snapshot = triple_buffer.GetWriteBuffer();
+    snapshot->sequence = sequence;
+    for (int i = 0; i < 31; i++) {
+      snapshot->values[i] = sequence * (i + 1);
+    }
+    triple_buffer.Publish();
+  }
+  palThread::Exit(0);
+}
+
+static bool palTripleBufferTest() {
+  // the reader starts with a default constructed value
+  triple_buffer.GetWriteBuffer()->sequence = 0;
+  for (int i = 0; i < 31; i++) {
+    triple_buffer.GetWriteBuffer()->values[i] = 0;
+  }
+  triple_buffer.Publish();
+  palAssertBreak(triple_buffer.HasNewValue());
+  bool updated = triple_buffer.Update();
+  palAssertBreak(updated);
+  updated = triple_buffer.Update();
+  palAssertBreak(updated == false);
+  palAssertBreak(triple_buffer.GetReadBuffer()->sequence == 0);
+
+  palThreadDescription writer_desc;
+  writer_desc.name = "Triple Buffer Writer";
+  writer_desc.start_method = palThreadStart(triple_buffer_writer);
+  palThread writer;
+  writer.Start(writer_desc, 0);
+
+  // every value read is complete and never older than the one before
+  uint32_t last_sequence = 0;
+  uint32_t reads = 0;
+  while (last_sequence != kTripleBufferTestSnapshots) {
+    const palTripleBufferTestSnapshot* snapshot = triple_buffer.Read();
+    palAssertBreak(snapshot->sequence >= last_sequence);
+    for (int i = 0; i < 31; i++) {
+      palAssertBreak(snapshot->values[i] == snapshot->sequence * (i + 1));
+    }
+    last_sequence = snapshot->sequence;
+    reads++;
+    if ((reads & 255) == 0) {
+      palThread::SpinYield();
+    }
+  }
+  writer.Join(NULL);
+  palAssertBreak(triple_buffer.HasNewValue() == false);
+  return true;
+}
+
+static const int kSharedStringTestThreads = 4;
+static const int kSharedStringTestNames = 64;
+
+struct palSharedStringTestThread {
+  palSharedStringTable* table;
+  palSharedString source;
+  palSharedString interned[kSharedStringTestNames];
+};
+
+void shared_string_worker(uintptr_t param) {
+  palSharedStringTestThread* state = reinterpret_cast<palSharedStringTestThread*>(param);
+  char name[32];
+  for (int round = 0; round < 200; round++) {
+    for (int i = 0; i < kSharedStringTestNames; i++) {
+      palStringPrintf(name, sizeof(name), "name %d", i);
+      palSharedString interned = state->table->Intern(palStringView(name));
+      if (round == 0) {
+        state->interned[i] = interned;
+      }
+      // every thread must get the same instance back
+      palAssertBreak(interned.IsSameInstance(state->interned[i]));
+      palSharedString copy = state->source;
+      palAssertBreak(copy.GetLength() == state->source.GetLength());
+    }
+  }
+  palThread::Exit(0);
+}
+
+static bool palSharedStringThreadTest() {
+  palSharedStringTable table;
+  table.SetAllocator(g_DefaultHeapAllocator);
+  palSharedString source(palStringView("fanned out to every thread"));
+  palSharedStringTestThread state[kSharedStringTestThreads];
+  palThread threads[kSharedStringTestThreads];
+  for (int t = 0; t < kSharedStringTestThreads; t++) {
+    state[t].table = &table;
+    state[t].source = source;
+    palThreadDescription desc;
+    desc.name = "Shared String Worker";
+    desc.start_method = palThreadStart(shared_string_worker);
+    threads[t].Start(desc, reinterpret_cast<uintptr_t>(&state[t]));
+  }
+  for (int t = 0; t < kSharedStringTestThreads; t++) {
+    threads[t].Join(NULL);
+  }
+  palAssertBreak(table.GetSize() == kSharedStringTestNames);
+  for (int i = 0; i < kSharedStringTestNames; i++) {
+    for (int t = 1; t < kSharedStringTestThreads; t++) {
+      palAssertBreak(state[t].interned[i].IsSameInstance(state[0].interned[i]));
+    }
+    // the table and one copy per thread
+    palAssertBreak(state[0].interned[i].GetReferenceCount() == kSharedStringTestThreads + 1);
+  }
+  for (int t = 0; t < kSharedStringTestThreads; t++) {
+    state[t].source.Reset();
+  }
+  palAssertBreak(source.GetReferenceCount() == 1);
+  return true;
+}
+
 bool PalThreadTest () {
   palMutexDescription my_mutex_desc;
   my_mutex_desc.initial_ownership = false;
@@ -109,6 +229,9 @@ bool PalThreadTest () {
     tcd0.Join(NULL);
     tcd1.Join(NULL);
   }
+
+  palTripleBufferTest();
+  palSharedStringThreadTest();
   
   return true;
 }